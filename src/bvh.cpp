@@ -0,0 +1,216 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const uint32_t BVH_LEAF_SIZE = 8;
+
+void atom_bounds(const AtomArrays& atoms, const std::vector<float>& radii, const uint32_t* begin, const uint32_t* end,
+                 float* bounds_min, float* bounds_max) {
+    const float inf = std::numeric_limits<float>::max();
+    bounds_min[0] = bounds_min[1] = bounds_min[2] = inf;
+    bounds_max[0] = bounds_max[1] = bounds_max[2] = -inf;
+    for (const uint32_t* it = begin; it != end; ++it) {
+        uint32_t i = *it;
+        float r = radii[i];
+        bounds_min[0] = std::min(bounds_min[0], atoms.x[i] - r);
+        bounds_min[1] = std::min(bounds_min[1], atoms.y[i] - r);
+        bounds_min[2] = std::min(bounds_min[2], atoms.z[i] - r);
+        bounds_max[0] = std::max(bounds_max[0], atoms.x[i] + r);
+        bounds_max[1] = std::max(bounds_max[1], atoms.y[i] + r);
+        bounds_max[2] = std::max(bounds_max[2], atoms.z[i] + r);
+    }
+}
+
+void merge_bounds(BvhNode& parent, const BvhNode& left, const BvhNode& right) {
+    for (int k = 0; k < 3; ++k) {
+        parent.bounds_min[k] = std::min(left.bounds_min[k], right.bounds_min[k]);
+        parent.bounds_max[k] = std::max(left.bounds_max[k], right.bounds_max[k]);
+    }
+}
+
+// Builds the subtree over atom_order[first, first + count) and returns its node index
+uint32_t build_node(AtomBvh& bvh, const AtomArrays& atoms, const std::vector<float>& radii, uint32_t first, uint32_t count) {
+    uint32_t index = static_cast<uint32_t>(bvh.nodes.size());
+    bvh.nodes.push_back(BvhNode{{0, 0, 0}, {0, 0, 0}, first, count, 0});
+    uint32_t* begin = bvh.atom_order.data() + first;
+    if (count <= BVH_LEAF_SIZE) {
+        atom_bounds(atoms, radii, begin, begin + count, bvh.nodes[index].bounds_min, bvh.nodes[index].bounds_max);
+        return index;
+    }
+
+    // Split at the median center along the longest axis of the centers' extent
+    float center_min[3] = {atoms.x[*begin], atoms.y[*begin], atoms.z[*begin]};
+    float center_max[3] = {center_min[0], center_min[1], center_min[2]};
+    for (uint32_t k = 1; k < count; ++k) {
+        uint32_t i = begin[k];
+        const float c[3] = {atoms.x[i], atoms.y[i], atoms.z[i]};
+        for (int a = 0; a < 3; ++a) {
+            center_min[a] = std::min(center_min[a], c[a]);
+            center_max[a] = std::max(center_max[a], c[a]);
+        }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (center_max[a] - center_min[a] > center_max[axis] - center_min[axis]) axis = a;
+    }
+    const std::vector<float>& coord = axis == 0 ? atoms.x : (axis == 1 ? atoms.y : atoms.z);
+    uint32_t half = count / 2;
+    std::nth_element(begin, begin + half, begin + count, [&](uint32_t a, uint32_t b) { return coord[a] < coord[b]; });
+
+    uint32_t left = build_node(bvh, atoms, radii, first, half);
+    uint32_t right = build_node(bvh, atoms, radii, first + half, count - half);
+    BvhNode& node = bvh.nodes[index]; // push_back above may have reallocated
+    node.right = right;
+    merge_bounds(node, bvh.nodes[left], bvh.nodes[right]);
+    return index;
+}
+
+// Largest and smallest signed distance of any box corner from the plane
+float box_plane_max(const BvhNode& node, const float* p) {
+    return p[0] * (p[0] > 0 ? node.bounds_max[0] : node.bounds_min[0]) +
+           p[1] * (p[1] > 0 ? node.bounds_max[1] : node.bounds_min[1]) +
+           p[2] * (p[2] > 0 ? node.bounds_max[2] : node.bounds_min[2]) + p[3];
+}
+
+float box_plane_min(const BvhNode& node, const float* p) {
+    return p[0] * (p[0] > 0 ? node.bounds_min[0] : node.bounds_max[0]) +
+           p[1] * (p[1] > 0 ? node.bounds_min[1] : node.bounds_max[1]) +
+           p[2] * (p[2] > 0 ? node.bounds_min[2] : node.bounds_max[2]) + p[3];
+}
+
+// Slab test; returns the entry distance or a negative value on a miss
+float ray_box_entry(const BvhNode& node, const Vec3& origin, const float* inv_dir, float t_max) {
+    const float o[3] = {origin.x, origin.y, origin.z};
+    float t0 = 0.0f, t1 = t_max;
+    for (int a = 0; a < 3; ++a) {
+        float near_t = (node.bounds_min[a] - o[a]) * inv_dir[a];
+        float far_t = (node.bounds_max[a] - o[a]) * inv_dir[a];
+        if (near_t > far_t) std::swap(near_t, far_t);
+        t0 = std::max(t0, near_t);
+        t1 = std::min(t1, far_t);
+        if (t0 > t1) return -1.0f;
+    }
+    return t0;
+}
+
+} // namespace
+
+Frustum Frustum::from_matrix(const Mat4& view_projection) {
+    // Column-major: row r of the matrix is (m[r], m[4 + r], m[8 + r], m[12 + r])
+    const float* m = view_projection.m;
+    Frustum f;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+            float sign = side == 0 ? 1.0f : -1.0f;
+            float* p = f.planes[axis * 2 + side];
+            for (int c = 0; c < 4; ++c) p[c] = m[c * 4 + 3] + sign * m[c * 4 + axis];
+            float length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (length > 0.0f) {
+                for (int c = 0; c < 4; ++c) p[c] /= length;
+            }
+        }
+    }
+    return f;
+}
+
+void AtomBvh::build(const AtomArrays& atoms, const std::vector<float>& radii) {
+    clear();
+    if (atoms.empty()) return;
+    atom_order.resize(atoms.size());
+    for (uint32_t i = 0; i < atom_order.size(); ++i) atom_order[i] = i;
+    nodes.reserve(2 * (atoms.size() / BVH_LEAF_SIZE + 1));
+    build_node(*this, atoms, radii, 0, static_cast<uint32_t>(atoms.size()));
+}
+
+void AtomBvh::refit(const AtomArrays& atoms, const std::vector<float>& radii) {
+    // Children always follow their parent in depth-first order, so a reverse sweep is bottom-up
+    for (size_t n = nodes.size(); n-- > 0;) {
+        BvhNode& node = nodes[n];
+        if (node.right == 0) {
+            const uint32_t* begin = atom_order.data() + node.first;
+            atom_bounds(atoms, radii, begin, begin + node.count, node.bounds_min, node.bounds_max);
+        } else {
+            merge_bounds(node, nodes[n + 1], nodes[node.right]);
+        }
+    }
+}
+
+void AtomBvh::cull(const Frustum& frustum, const AtomArrays& atoms, const std::vector<float>& radii,
+                   std::vector<uint32_t>& visible) const {
+    if (nodes.empty()) return;
+    // Each stack entry carries the planes its box still straddles; boxes fully inside a plane
+    // drop it, and a box inside all six planes is emitted as one range without per-atom tests
+    std::pair<uint32_t, uint8_t> stack[64];
+    int top = 0;
+    stack[top++] = {0, 0x3f};
+    while (top > 0) {
+        uint32_t n = stack[--top].first;
+        uint8_t mask = stack[top].second;
+        const BvhNode& node = nodes[n];
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p) {
+            if (!(mask & (1 << p))) continue;
+            if (box_plane_max(node, frustum.planes[p]) < 0.0f) outside = true;
+            else if (box_plane_min(node, frustum.planes[p]) >= 0.0f) mask &= ~(1 << p);
+        }
+        if (outside) continue;
+        if (mask == 0) {
+            visible.insert(visible.end(), atom_order.begin() + node.first, atom_order.begin() + node.first + node.count);
+        } else if (node.right == 0) {
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                uint32_t i = atom_order[k];
+                if (!frustum.sphere_outside(atoms.x[i], atoms.y[i], atoms.z[i], radii[i])) visible.push_back(i);
+            }
+        } else {
+            stack[top++] = {node.right, mask};
+            stack[top++] = {n + 1, mask};
+        }
+    }
+}
+
+long AtomBvh::pick(const Vec3& origin, const Vec3& direction, const AtomArrays& atoms, const std::vector<float>& radii) const {
+    if (nodes.empty()) return -1;
+    const float inv_dir[3] = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z}; // inf is fine for slabs
+    float best_t = std::numeric_limits<float>::max();
+    long best = -1;
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const BvhNode& node = nodes[stack[--top]];
+        if (ray_box_entry(node, origin, inv_dir, best_t) < 0.0f) continue;
+        if (node.right == 0) {
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                uint32_t i = atom_order[k];
+                Vec3 oc = Vec3(atoms.x[i], atoms.y[i], atoms.z[i]) - origin;
+                float b = Vec3::dot(oc, direction);
+                float disc = b * b - (Vec3::dot(oc, oc) - radii[i] * radii[i]);
+                if (disc < 0.0f) continue;
+                float t = b - std::sqrt(disc);
+                if (t > 0.0f && t < best_t) {
+                    best_t = t;
+                    best = static_cast<long>(i);
+                }
+            }
+            continue;
+        }
+        // Visit the nearer child first so the far one is usually pruned by best_t
+        uint32_t left = static_cast<uint32_t>(&node - nodes.data()) + 1;
+        uint32_t right = node.right;
+        float t_left = ray_box_entry(nodes[left], origin, inv_dir, best_t);
+        float t_right = ray_box_entry(nodes[right], origin, inv_dir, best_t);
+        if (t_left >= 0.0f && t_right >= 0.0f) {
+            if (t_left < t_right) std::swap(left, right);
+            stack[top++] = left;  // Far child
+            stack[top++] = right; // Near child, popped first
+        } else if (t_left >= 0.0f) {
+            stack[top++] = left;
+        } else if (t_right >= 0.0f) {
+            stack[top++] = right;
+        }
+    }
+    return best;
+}
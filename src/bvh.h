@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "math.h"
+#include "molecule.h"
+
+// View frustum as six inward-facing planes (a, b, c, d with a*x + b*y + c*z + d >= 0 inside),
+// extracted from a combined projection * view matrix.
+struct Frustum {
+    float planes[6][4];
+
+    static Frustum from_matrix(const Mat4& view_projection);
+    bool sphere_outside(float x, float y, float z, float radius) const {
+        for (const auto& p : planes) {
+            if (p[0] * x + p[1] * y + p[2] * z + p[3] < -radius) return true;
+        }
+        return false;
+    }
+};
+
+// Node of a bounding volume hierarchy stored in depth-first order: the left child of an inner
+// node is the next node, the right child is at `right`. Every node covers the contiguous range
+// [first, first + count) of AtomBvh::atom_order, so a fully visible subtree is one range.
+struct BvhNode {
+    float bounds_min[3];
+    float bounds_max[3];
+    uint32_t first;
+    uint32_t count;
+    uint32_t right; // 0 for leaves
+};
+
+// BVH over atom spheres (center and display radius), built by median splits along the longest
+// axis. Coordinates and radii can change without a rebuild: refit() recomputes the boxes
+// bottom-up in O(N), which keeps queries correct at some cost in tightness.
+struct AtomBvh {
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> atom_order; // Atom indices grouped by leaf
+
+    void clear() { nodes.clear(); atom_order.clear(); }
+    size_t atom_count() const { return atom_order.size(); }
+
+    void build(const AtomArrays& atoms, const std::vector<float>& radii);
+    void refit(const AtomArrays& atoms, const std::vector<float>& radii);
+
+    // Appends the indices of atoms whose spheres are not entirely outside the frustum
+    void cull(const Frustum& frustum, const AtomArrays& atoms, const std::vector<float>& radii,
+              std::vector<uint32_t>& visible) const;
+
+    // Nearest atom hit by the ray origin + t * direction (t > 0), or -1
+    long pick(const Vec3& origin, const Vec3& direction, const AtomArrays& atoms, const std::vector<float>& radii) const;
+};
@@ -0,0 +1,385 @@
+#include "cif_reader.h"
+#include "residue_templates.h"
+#include "text_scan.h"
+#include <iostream>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// A CIF value or tag as a range of the input buffer (quotes and text-field semicolons stripped)
+struct CifToken {
+    const char* b = nullptr;
+    const char* e = nullptr;
+    bool quoted = false;
+
+    size_t size() const { return static_cast<size_t>(e - b); }
+    bool is_null() const { return !quoted && size() == 1 && (*b == '.' || *b == '?'); }
+    bool is_tag() const { return !quoted && b < e && *b == '_'; }
+    bool equals_ci(const char* s) const {
+        size_t n = std::strlen(s);
+        if (size() != n) return false;
+        for (size_t i = 0; i < n; ++i) {
+            char c = b[i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            if (c != s[i]) return false;
+        }
+        return true;
+    }
+    bool starts_with_ci(const char* s) const {
+        size_t n = std::strlen(s);
+        if (size() < n) return false;
+        CifToken prefix = *this;
+        prefix.e = b + n;
+        return prefix.equals_ci(s);
+    }
+    // A reserved word that ends the current loop
+    bool is_control() const {
+        return !quoted && (is_tag() || equals_ci("loop_") || starts_with_ci("data_") || starts_with_ci("save_") ||
+                           equals_ci("global_") || equals_ci("stop_"));
+    }
+};
+
+class CifTokenizer {
+public:
+    CifTokenizer(const char* begin, const char* end) : begin(begin), p(begin), end(end) {}
+
+    bool next(CifToken& t) {
+        if (has_pending) { t = pending; has_pending = false; return true; }
+        while (p < end) {
+            char c = *p;
+            if (c == '\n') { ++line_number; ++p; continue; }
+            if (is_blank(c)) { ++p; continue; }
+            if (c == '#') { // Comment to end of line
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                p = nl ? nl : end;
+                continue;
+            }
+            if (c == ';' && (p == begin || p[-1] == '\n')) { // Multi-line text field, closed by "\n;"
+                const char* s = p + 1;
+                const char* q = s;
+                while (true) {
+                    const char* nl = static_cast<const char*>(std::memchr(q, '\n', end - q));
+                    if (!nl) { t = {s, end, true}; p = end; return true; }
+                    ++line_number;
+                    if (nl + 1 < end && nl[1] == ';') { t = {s, nl, true}; p = nl + 2; return true; }
+                    q = nl + 1;
+                }
+            }
+            if (c == '\'' || c == '"') { // Quote closes only when followed by whitespace
+                const char* s = p + 1;
+                const char* q = s;
+                while (q < end && *q != '\n') {
+                    if (*q == c && (q + 1 == end || is_blank(q[1]) || q[1] == '\n')) break;
+                    ++q;
+                }
+                t = {s, q, true};
+                p = (q < end && *q == c) ? q + 1 : q;
+                return true;
+            }
+            const char* s = p;
+            while (p < end && *p != '\n' && !is_blank(*p)) ++p;
+            t = {s, p, false};
+            return true;
+        }
+        return false;
+    }
+    void push_back(const CifToken& t) { pending = t; has_pending = true; }
+
+    int line_number = 1;
+
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+    CifToken pending;
+    bool has_pending = false;
+};
+
+// Category part of a tag ("_atom_site.Cartn_x" -> "_atom_site")
+CifToken tag_category(const CifToken& tag) {
+    CifToken category = tag;
+    const char* dot = static_cast<const char*>(std::memchr(tag.b, '.', tag.size()));
+    if (dot) category.e = dot;
+    return category;
+}
+
+bool same_category(const CifToken& a, const CifToken& b) {
+    CifToken ca = tag_category(a);
+    CifToken cb = tag_category(b);
+    if (ca.size() != cb.size()) return false;
+    for (size_t i = 0; i < ca.size(); ++i) {
+        char x = ca.b[i], y = cb.b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Value text with surrounding whitespace (including text-field newlines) removed
+std::string trimmed_value(const CifToken& t) {
+    const char* b = t.b;
+    const char* e = t.e;
+    while (b < e && (is_blank(*b) || *b == '\n')) ++b;
+    while (e > b && (is_blank(e[-1]) || e[-1] == '\n')) --e;
+    return std::string(b, e);
+}
+
+int find_column(const std::vector<CifToken>& tags, const char* name) {
+    for (size_t i = 0; i < tags.size(); ++i) {
+        if (tags[i].equals_ci(name)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+template <size_t N>
+void copy_token(const CifToken& t, char (&out)[N]) {
+    std::memset(out, 0, N);
+    if (t.is_null()) return;
+    for (size_t i = 0; i < N - 1 && t.b + i < t.e; ++i) out[i] = t.b[i];
+}
+
+bool token_float(const CifToken& t, float& out) {
+    const char* p = t.b;
+    if (p >= t.e || t.is_null()) return false;
+    return parse_float(p, t.e, out) && p == t.e;
+}
+
+bool token_int(const CifToken& t, int& out) {
+    const char* p = t.b;
+    if (p >= t.e || t.is_null()) return false;
+    return parse_int(p, t.e, out);
+}
+
+// Column indices of the _atom_site items we use (-1 when absent)
+struct AtomSiteColumns {
+    int group, type_symbol, atom_id, alt_id, comp_id, asym_id, seq_id, ins_code, x, y, z, b_iso, model;
+
+    explicit AtomSiteColumns(const std::vector<CifToken>& tags) {
+        group = find_column(tags, "_atom_site.group_pdb");
+        type_symbol = find_column(tags, "_atom_site.type_symbol");
+        atom_id = find_column(tags, "_atom_site.label_atom_id");
+        if (atom_id < 0) atom_id = find_column(tags, "_atom_site.auth_atom_id");
+        alt_id = find_column(tags, "_atom_site.label_alt_id");
+        comp_id = find_column(tags, "_atom_site.label_comp_id");
+        if (comp_id < 0) comp_id = find_column(tags, "_atom_site.auth_comp_id");
+        asym_id = find_column(tags, "_atom_site.auth_asym_id");
+        if (asym_id < 0) asym_id = find_column(tags, "_atom_site.label_asym_id");
+        seq_id = find_column(tags, "_atom_site.auth_seq_id");
+        if (seq_id < 0) seq_id = find_column(tags, "_atom_site.label_seq_id");
+        ins_code = find_column(tags, "_atom_site.pdbx_pdb_ins_code");
+        x = find_column(tags, "_atom_site.cartn_x");
+        y = find_column(tags, "_atom_site.cartn_y");
+        z = find_column(tags, "_atom_site.cartn_z");
+        b_iso = find_column(tags, "_atom_site.b_iso_or_equiv");
+        model = find_column(tags, "_atom_site.pdbx_pdb_model_num");
+    }
+};
+
+// One side of a _struct_conn link, identified the same way atoms are stored
+struct ConnPartner {
+    char chain_id[4];
+    int seq_num;
+    char insertion_code;
+    char atom_name[5];
+};
+
+struct CifReadState {
+    Molecule& out;
+    int model = -1; // First model number seen; other models are skipped
+    std::vector<std::pair<ConnPartner, ConnPartner>> links;
+    std::string entry_id;
+    int line_number = 0;
+    bool failed = false;
+    explicit CifReadState(Molecule& m) : out(m) {}
+};
+
+void add_atom_site_row(CifReadState& state, const AtomSiteColumns& cols, const std::vector<CifToken>& row) {
+    auto col = [&](int index) -> CifToken { return index >= 0 ? row[index] : CifToken(); };
+    if (cols.model >= 0) {
+        int model = 0;
+        if (token_int(row[cols.model], model)) {
+            if (state.model < 0) state.model = model;
+            if (model != state.model) return;
+        }
+    }
+    CifToken alt = col(cols.alt_id);
+    if (alt.b && !alt.is_null() && !(alt.size() == 1 && (*alt.b == 'A' || *alt.b == '1'))) return;
+
+    float x, y, z;
+    if (!token_float(col(cols.x), x) || !token_float(col(cols.y), y) || !token_float(col(cols.z), z)) {
+        std::cerr << "mmCIF Parse Error (Line " << state.line_number << "): Could not parse atom coordinates." << std::endl;
+        state.failed = true;
+        return;
+    }
+    CifToken symbol = col(cols.type_symbol);
+    CifToken atom_id = col(cols.atom_id);
+    int atomic_number = 0;
+    if (symbol.b && !symbol.is_null()) atomic_number = atomic_number_from_symbol(symbol.b, symbol.e);
+    else if (atom_id.b) atomic_number = atomic_number_from_symbol(atom_id.b, atom_id.b + 1);
+
+    StructureInfo& info = state.out.structure;
+    Residue res;
+    copy_token(col(cols.comp_id), res.name);
+    copy_token(col(cols.asym_id), res.chain_id);
+    res.seq_num = 0;
+    token_int(col(cols.seq_id), res.seq_num);
+    CifToken ins = col(cols.ins_code);
+    res.insertion_code = (ins.b && !ins.is_null()) ? *ins.b : ' ';
+    res.hetero = col(cols.group).equals_ci("hetatm");
+
+    uint32_t atom_index = static_cast<uint32_t>(state.out.atoms.size());
+    bool same_residue = !info.residues.empty();
+    if (same_residue) {
+        const Residue& last = info.residues.back();
+        same_residue = last.seq_num == res.seq_num && last.insertion_code == res.insertion_code &&
+                       last.hetero == res.hetero && std::memcmp(last.name, res.name, 4) == 0 &&
+                       std::memcmp(last.chain_id, res.chain_id, 4) == 0;
+    }
+    if (same_residue) {
+        info.residues.back().atom_count++;
+    } else {
+        res.first_atom = atom_index;
+        res.atom_count = 1;
+        info.residues.push_back(res);
+    }
+
+    char name[5];
+    copy_token(atom_id, name);
+    info.atom_names.push_back({{name[0], name[1], name[2], name[3]}});
+    float b_factor = 0.0f;
+    token_float(col(cols.b_iso), b_factor);
+    info.b_factors.push_back(b_factor);
+    state.out.atoms.push_back(x, y, z, atomic_number);
+}
+
+void add_struct_conn_row(CifReadState& state, const std::vector<CifToken>& tags, const std::vector<CifToken>& row) {
+    auto col = [&](const char* name) -> CifToken {
+        int index = find_column(tags, name);
+        return index >= 0 ? row[index] : CifToken();
+    };
+    if (col("_struct_conn.conn_type_id").equals_ci("hydrog")) return; // Hydrogen bonds are not drawn
+
+    ConnPartner partners[2];
+    const char* asym_tags[2] = { "_struct_conn.ptnr1_auth_asym_id", "_struct_conn.ptnr2_auth_asym_id" };
+    const char* seq_tags[2] = { "_struct_conn.ptnr1_auth_seq_id", "_struct_conn.ptnr2_auth_seq_id" };
+    const char* ins_tags[2] = { "_struct_conn.pdbx_ptnr1_pdb_ins_code", "_struct_conn.pdbx_ptnr2_pdb_ins_code" };
+    const char* atom_tags[2] = { "_struct_conn.ptnr1_label_atom_id", "_struct_conn.ptnr2_label_atom_id" };
+    for (int k = 0; k < 2; ++k) {
+        copy_token(col(asym_tags[k]), partners[k].chain_id);
+        partners[k].seq_num = 0;
+        if (!token_int(col(seq_tags[k]), partners[k].seq_num)) return;
+        CifToken ins = col(ins_tags[k]);
+        partners[k].insertion_code = (ins.b && !ins.is_null()) ? *ins.b : ' ';
+        copy_token(col(atom_tags[k]), partners[k].atom_name);
+    }
+    state.links.push_back({partners[0], partners[1]});
+}
+
+// Dispatches one loop (or a group of single-valued items, as a one-row loop) by category
+void process_category(CifReadState& state, CifTokenizer* tokenizer, const std::vector<CifToken>& tags,
+                      std::vector<CifToken>* single_row) {
+    if (tags.empty()) return;
+    CifToken category = tag_category(tags[0]);
+    bool is_atom_site = category.equals_ci("_atom_site");
+    bool is_struct_conn = category.equals_ci("_struct_conn");
+
+    if (single_row) {
+        if (is_atom_site) add_atom_site_row(state, AtomSiteColumns(tags), *single_row);
+        else if (is_struct_conn) add_struct_conn_row(state, tags, *single_row);
+        for (size_t i = 0; i < tags.size(); ++i) {
+            const CifToken& value = (*single_row)[i];
+            if (tags[i].equals_ci("_struct.title") && !value.is_null()) state.out.name = trimmed_value(value);
+            else if (tags[i].equals_ci("_entry.id") && !value.is_null()) state.entry_id = trimmed_value(value);
+        }
+        return;
+    }
+
+    AtomSiteColumns atom_cols(tags);
+    std::vector<CifToken> row(tags.size());
+    size_t column = 0;
+    CifToken t;
+    while (tokenizer->next(t)) {
+        if (t.is_control()) { tokenizer->push_back(t); break; }
+        row[column++] = t;
+        if (column == tags.size()) {
+            state.line_number = tokenizer->line_number;
+            if (is_atom_site) add_atom_site_row(state, atom_cols, row);
+            else if (is_struct_conn) add_struct_conn_row(state, tags, row);
+            if (state.failed) return;
+            column = 0;
+        }
+    }
+}
+
+long find_partner_atom(const Molecule& mol, const ConnPartner& partner) {
+    const StructureInfo& info = mol.structure;
+    for (const auto& res : info.residues) {
+        if (res.seq_num != partner.seq_num || res.insertion_code != partner.insertion_code ||
+            std::strncmp(res.chain_id, partner.chain_id, 4) != 0) continue;
+        for (uint32_t k = 0; k < res.atom_count; ++k) {
+            const auto& name = info.atom_names[res.first_atom + k];
+            if (std::strncmp(name.data(), partner.atom_name, 4) == 0) return res.first_atom + k;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+bool parse_mmcif(const char* data, size_t length, Molecule& out) {
+    CifReadState state(out);
+    CifTokenizer tokenizer(data, data + length);
+    std::vector<CifToken> item_tags;   // Single-valued items of the current category
+    std::vector<CifToken> item_values;
+    bool seen_data_block = false;
+
+    CifToken t;
+    while (!state.failed && tokenizer.next(t)) {
+        if (!t.quoted && t.starts_with_ci("data_")) {
+            if (seen_data_block) break; // Only the first data block is read
+            seen_data_block = true;
+            continue;
+        }
+        if (!t.quoted && t.equals_ci("loop_")) {
+            process_category(state, nullptr, item_tags, &item_values);
+            item_tags.clear();
+            item_values.clear();
+
+            std::vector<CifToken> tags;
+            while (tokenizer.next(t) && t.is_tag()) tags.push_back(t);
+            if (!t.is_tag()) tokenizer.push_back(t);
+            process_category(state, &tokenizer, tags, nullptr);
+            continue;
+        }
+        if (t.is_tag()) {
+            CifToken value;
+            if (!tokenizer.next(value)) break;
+            if (!item_tags.empty() && !same_category(item_tags[0], t)) {
+                process_category(state, nullptr, item_tags, &item_values);
+                item_tags.clear();
+                item_values.clear();
+            }
+            item_tags.push_back(t);
+            item_values.push_back(value);
+        }
+    }
+    if (!state.failed) process_category(state, nullptr, item_tags, &item_values);
+
+    if (state.failed) return false;
+    if (out.atoms.empty()) {
+        std::cerr << "mmCIF Parse Error: No _atom_site records found." << std::endl;
+        return false;
+    }
+    if (out.name.empty()) out.name = state.entry_id.empty() ? "Untitled Structure" : state.entry_id;
+
+    std::vector<Bond> explicit_bonds;
+    for (const auto& link : state.links) {
+        long i = find_partner_atom(out, link.first);
+        long j = find_partner_atom(out, link.second);
+        if (i >= 0 && j >= 0 && i != j) explicit_bonds.push_back({static_cast<size_t>(i), static_cast<size_t>(j), 1});
+    }
+    build_structure_bonds(out, explicit_bonds);
+    return true;
+}
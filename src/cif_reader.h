@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include "molecule.h"
+
+// Parses the _atom_site loop of the first data block (first model only) into out, filling
+// out.structure with residue, chain and B-factor data. Bonds come from _struct_conn
+// (covalent, disulfide and metal links) and residue templates (see build_structure_bonds).
+bool parse_mmcif(const char* data, size_t length, Molecule& out);
@@ -0,0 +1,44 @@
+#include "elements.h"
+
+namespace {
+
+// Direct index for one- and two-letter symbols: first letter (A-Z) times 27 plus the
+// second letter (0 for none, 1-26 for a-z)
+constexpr int SYMBOL_SLOTS = 26 * 27;
+
+constexpr int symbol_slot(char first, char second) {
+    return (first - 'A') * 27 + (second ? second - 'a' + 1 : 0);
+}
+
+constexpr std::array<uint8_t, SYMBOL_SLOTS> build_symbol_index() {
+    std::array<uint8_t, SYMBOL_SLOTS> index{};
+    for (int z = 1; z <= ELEMENT_COUNT; ++z) {
+        const char* s = ELEMENT_TABLE[z].symbol;
+        index[symbol_slot(s[0], s[1])] = static_cast<uint8_t>(z);
+    }
+    return index;
+}
+
+constexpr std::array<uint8_t, SYMBOL_SLOTS> SYMBOL_INDEX = build_symbol_index();
+static_assert(SYMBOL_INDEX[symbol_slot('C', 0)] == 6 && SYMBOL_INDEX[symbol_slot('C', 'l')] == 17 &&
+              SYMBOL_INDEX[symbol_slot('O', 'g')] == 118, "element symbol index is inconsistent");
+
+} // namespace
+
+int atomic_number_from_symbol(const char* begin, const char* end) {
+    if (begin >= end) return 0;
+    char first = *begin;
+    if (first >= 'a' && first <= 'z') first = static_cast<char>(first - 'a' + 'A');
+    if (first < 'A' || first > 'Z') return 0;
+    char second = 0;
+    if (begin + 1 < end) {
+        char c = begin[1];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c >= 'a' && c <= 'z') second = c;
+    }
+    return SYMBOL_INDEX[symbol_slot(first, second)];
+}
+
+int atomic_number_from_symbol(const std::string& symbol) {
+    return atomic_number_from_symbol(symbol.data(), symbol.data() + symbol.size());
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include "math.h"
+
+const int ELEMENT_COUNT = 118;
+
+// Per-element properties, shared by every atom of that element
+struct ElementProperties {
+    char symbol[3];
+    float covalent_radius; // Angstroms (Cordero et al. 2008; 2.0 where unmeasured)
+    float vdw_radius;      // Angstroms (Bondi 1964, else Alvarez 2013; 2.0 where unknown)
+    Vec3 color;            // Jmol CPK palette
+    float mass;            // Standard atomic weight (IUPAC 2016), u
+};
+
+// Indexed by atomic number; entry 0 is the unknown/dummy element "X"
+inline constexpr ElementProperties ELEMENT_TABLE[ELEMENT_COUNT + 1] = {
+    {"X",  0.60f, 1.50f, Vec3(0.800f, 0.100f, 0.800f),   0.000f}, // Unknown/dummy: magenta
+    {"H",  0.31f, 1.20f, Vec3(1.000f, 1.000f, 1.000f),    1.008f},
+    {"He", 0.28f, 1.40f, Vec3(0.851f, 1.000f, 1.000f),    4.003f},
+    {"Li", 1.28f, 1.82f, Vec3(0.800f, 0.502f, 1.000f),    6.940f},
+    {"Be", 0.96f, 1.53f, Vec3(0.761f, 1.000f, 0.000f),    9.012f},
+    {"B",  0.84f, 1.92f, Vec3(1.000f, 0.710f, 0.710f),   10.810f},
+    {"C",  0.76f, 1.70f, Vec3(0.565f, 0.565f, 0.565f),   12.011f},
+    {"N",  0.71f, 1.55f, Vec3(0.188f, 0.314f, 0.973f),   14.007f},
+    {"O",  0.66f, 1.52f, Vec3(1.000f, 0.051f, 0.051f),   15.999f},
+    {"F",  0.57f, 1.47f, Vec3(0.565f, 0.878f, 0.314f),   18.998f},
+    {"Ne", 0.58f, 1.54f, Vec3(0.702f, 0.890f, 0.961f),   20.180f},
+    {"Na", 1.66f, 2.27f, Vec3(0.671f, 0.361f, 0.949f),   22.990f},
+    {"Mg", 1.41f, 1.73f, Vec3(0.541f, 1.000f, 0.000f),   24.305f},
+    {"Al", 1.21f, 1.84f, Vec3(0.749f, 0.651f, 0.651f),   26.982f},
+    {"Si", 1.11f, 2.10f, Vec3(0.941f, 0.784f, 0.627f),   28.085f},
+    {"P",  1.07f, 1.80f, Vec3(1.000f, 0.502f, 0.000f),   30.974f},
+    {"S",  1.05f, 1.80f, Vec3(1.000f, 1.000f, 0.188f),   32.060f},
+    {"Cl", 1.02f, 1.75f, Vec3(0.122f, 0.941f, 0.122f),   35.450f},
+    {"Ar", 1.06f, 1.88f, Vec3(0.502f, 0.820f, 0.890f),   39.948f},
+    {"K",  2.03f, 2.75f, Vec3(0.561f, 0.251f, 0.831f),   39.098f},
+    {"Ca", 1.76f, 2.31f, Vec3(0.239f, 1.000f, 0.000f),   40.078f},
+    {"Sc", 1.70f, 2.58f, Vec3(0.902f, 0.902f, 0.902f),   44.956f},
+    {"Ti", 1.60f, 2.46f, Vec3(0.749f, 0.761f, 0.780f),   47.867f},
+    {"V",  1.53f, 2.42f, Vec3(0.651f, 0.651f, 0.671f),   50.941f},
+    {"Cr", 1.39f, 2.45f, Vec3(0.541f, 0.600f, 0.780f),   51.996f},
+    {"Mn", 1.39f, 2.45f, Vec3(0.612f, 0.478f, 0.780f),   54.938f},
+    {"Fe", 1.32f, 2.44f, Vec3(0.878f, 0.400f, 0.200f),   55.845f},
+    {"Co", 1.26f, 2.40f, Vec3(0.941f, 0.565f, 0.627f),   58.933f},
+    {"Ni", 1.24f, 1.63f, Vec3(0.314f, 0.816f, 0.314f),   58.693f},
+    {"Cu", 1.32f, 1.40f, Vec3(0.784f, 0.502f, 0.200f),   63.546f},
+    {"Zn", 1.22f, 1.39f, Vec3(0.490f, 0.502f, 0.690f),   65.380f},
+    {"Ga", 1.22f, 1.87f, Vec3(0.761f, 0.561f, 0.561f),   69.723f},
+    {"Ge", 1.20f, 2.11f, Vec3(0.400f, 0.561f, 0.561f),   72.630f},
+    {"As", 1.19f, 1.85f, Vec3(0.741f, 0.502f, 0.890f),   74.922f},
+    {"Se", 1.20f, 1.90f, Vec3(1.000f, 0.631f, 0.000f),   78.971f},
+    {"Br", 1.20f, 1.85f, Vec3(0.651f, 0.161f, 0.161f),   79.904f},
+    {"Kr", 1.16f, 2.02f, Vec3(0.361f, 0.722f, 0.820f),   83.798f},
+    {"Rb", 2.20f, 3.03f, Vec3(0.439f, 0.180f, 0.690f),   85.468f},
+    {"Sr", 1.95f, 2.49f, Vec3(0.000f, 1.000f, 0.000f),   87.620f},
+    {"Y",  1.90f, 2.75f, Vec3(0.580f, 1.000f, 1.000f),   88.906f},
+    {"Zr", 1.75f, 2.52f, Vec3(0.580f, 0.878f, 0.878f),   91.224f},
+    {"Nb", 1.64f, 2.56f, Vec3(0.451f, 0.761f, 0.788f),   92.906f},
+    {"Mo", 1.54f, 2.45f, Vec3(0.329f, 0.710f, 0.710f),   95.950f},
+    {"Tc", 1.47f, 2.44f, Vec3(0.231f, 0.620f, 0.620f),   97.907f},
+    {"Ru", 1.46f, 2.46f, Vec3(0.141f, 0.561f, 0.561f),  101.070f},
+    {"Rh", 1.42f, 2.44f, Vec3(0.039f, 0.490f, 0.549f),  102.906f},
+    {"Pd", 1.39f, 1.63f, Vec3(0.000f, 0.412f, 0.522f),  106.420f},
+    {"Ag", 1.45f, 1.72f, Vec3(0.753f, 0.753f, 0.753f),  107.868f},
+    {"Cd", 1.44f, 1.58f, Vec3(1.000f, 0.851f, 0.561f),  112.414f},
+    {"In", 1.42f, 1.93f, Vec3(0.651f, 0.459f, 0.451f),  114.818f},
+    {"Sn", 1.39f, 2.17f, Vec3(0.400f, 0.502f, 0.502f),  118.710f},
+    {"Sb", 1.39f, 2.06f, Vec3(0.620f, 0.388f, 0.710f),  121.760f},
+    {"Te", 1.38f, 2.06f, Vec3(0.831f, 0.478f, 0.000f),  127.600f},
+    {"I",  1.39f, 1.98f, Vec3(0.580f, 0.000f, 0.580f),  126.904f},
+    {"Xe", 1.40f, 2.16f, Vec3(0.259f, 0.620f, 0.690f),  131.293f},
+    {"Cs", 2.44f, 3.43f, Vec3(0.341f, 0.090f, 0.561f),  132.905f},
+    {"Ba", 2.15f, 2.49f, Vec3(0.000f, 0.788f, 0.000f),  137.327f},
+    {"La", 2.07f, 2.98f, Vec3(0.439f, 0.831f, 1.000f),  138.905f},
+    {"Ce", 2.04f, 2.88f, Vec3(1.000f, 1.000f, 0.780f),  140.116f},
+    {"Pr", 2.03f, 2.92f, Vec3(0.851f, 1.000f, 0.780f),  140.908f},
+    {"Nd", 2.01f, 2.95f, Vec3(0.780f, 1.000f, 0.780f),  144.242f},
+    {"Pm", 1.99f, 2.00f, Vec3(0.639f, 1.000f, 0.780f),  144.913f},
+    {"Sm", 1.98f, 2.90f, Vec3(0.561f, 1.000f, 0.780f),  150.360f},
+    {"Eu", 1.98f, 2.87f, Vec3(0.380f, 1.000f, 0.780f),  151.964f},
+    {"Gd", 1.96f, 2.83f, Vec3(0.271f, 1.000f, 0.780f),  157.250f},
+    {"Tb", 1.94f, 2.79f, Vec3(0.188f, 1.000f, 0.780f),  158.925f},
+    {"Dy", 1.92f, 2.87f, Vec3(0.122f, 1.000f, 0.780f),  162.500f},
+    {"Ho", 1.92f, 2.81f, Vec3(0.000f, 1.000f, 0.612f),  164.930f},
+    {"Er", 1.89f, 2.83f, Vec3(0.000f, 0.902f, 0.459f),  167.259f},
+    {"Tm", 1.90f, 2.79f, Vec3(0.000f, 0.831f, 0.322f),  168.934f},
+    {"Yb", 1.87f, 2.80f, Vec3(0.000f, 0.749f, 0.220f),  173.054f},
+    {"Lu", 1.87f, 2.74f, Vec3(0.000f, 0.671f, 0.141f),  174.967f},
+    {"Hf", 1.75f, 2.63f, Vec3(0.302f, 0.761f, 1.000f),  178.490f},
+    {"Ta", 1.70f, 2.53f, Vec3(0.302f, 0.651f, 1.000f),  180.948f},
+    {"W",  1.62f, 2.57f, Vec3(0.129f, 0.580f, 0.839f),  183.840f},
+    {"Re", 1.51f, 2.49f, Vec3(0.149f, 0.490f, 0.671f),  186.207f},
+    {"Os", 1.44f, 2.48f, Vec3(0.149f, 0.400f, 0.588f),  190.230f},
+    {"Ir", 1.41f, 2.41f, Vec3(0.090f, 0.329f, 0.529f),  192.217f},
+    {"Pt", 1.36f, 1.75f, Vec3(0.816f, 0.816f, 0.878f),  195.084f},
+    {"Au", 1.36f, 1.66f, Vec3(1.000f, 0.820f, 0.137f),  196.967f},
+    {"Hg", 1.32f, 1.55f, Vec3(0.722f, 0.722f, 0.816f),  200.592f},
+    {"Tl", 1.45f, 1.96f, Vec3(0.651f, 0.329f, 0.302f),  204.380f},
+    {"Pb", 1.46f, 2.02f, Vec3(0.341f, 0.349f, 0.380f),  207.200f},
+    {"Bi", 1.48f, 2.07f, Vec3(0.620f, 0.310f, 0.710f),  208.980f},
+    {"Po", 1.40f, 1.97f, Vec3(0.671f, 0.361f, 0.000f),  208.982f},
+    {"At", 1.50f, 2.02f, Vec3(0.459f, 0.310f, 0.271f),  209.987f},
+    {"Rn", 1.50f, 2.20f, Vec3(0.259f, 0.510f, 0.588f),  222.018f},
+    {"Fr", 2.60f, 3.48f, Vec3(0.259f, 0.000f, 0.400f),  223.020f},
+    {"Ra", 2.21f, 2.83f, Vec3(0.000f, 0.490f, 0.000f),  226.025f},
+    {"Ac", 2.15f, 2.80f, Vec3(0.439f, 0.671f, 0.980f),  227.028f},
+    {"Th", 2.06f, 2.93f, Vec3(0.000f, 0.729f, 1.000f),  232.038f},
+    {"Pa", 2.00f, 2.88f, Vec3(0.000f, 0.631f, 1.000f),  231.036f},
+    {"U",  1.96f, 1.86f, Vec3(0.000f, 0.561f, 1.000f),  238.029f},
+    {"Np", 1.90f, 2.82f, Vec3(0.000f, 0.502f, 1.000f),  237.048f},
+    {"Pu", 1.87f, 2.81f, Vec3(0.000f, 0.420f, 1.000f),  244.064f},
+    {"Am", 1.80f, 2.83f, Vec3(0.329f, 0.361f, 0.949f),  243.061f},
+    {"Cm", 1.69f, 3.05f, Vec3(0.471f, 0.361f, 0.890f),  247.070f},
+    {"Bk", 2.00f, 3.40f, Vec3(0.541f, 0.310f, 0.890f),  247.070f},
+    {"Cf", 2.00f, 3.05f, Vec3(0.631f, 0.212f, 0.831f),  251.080f},
+    {"Es", 2.00f, 2.70f, Vec3(0.702f, 0.122f, 0.831f),  252.083f},
+    {"Fm", 2.00f, 2.00f, Vec3(0.702f, 0.122f, 0.729f),  257.095f},
+    {"Md", 2.00f, 2.00f, Vec3(0.702f, 0.051f, 0.651f),  258.098f},
+    {"No", 2.00f, 2.00f, Vec3(0.741f, 0.051f, 0.529f),  259.101f},
+    {"Lr", 2.00f, 2.00f, Vec3(0.780f, 0.000f, 0.400f),  262.110f},
+    {"Rf", 2.00f, 2.00f, Vec3(0.800f, 0.000f, 0.349f),  267.122f},
+    {"Db", 2.00f, 2.00f, Vec3(0.820f, 0.000f, 0.310f),  268.126f},
+    {"Sg", 2.00f, 2.00f, Vec3(0.851f, 0.000f, 0.271f),  271.134f},
+    {"Bh", 2.00f, 2.00f, Vec3(0.878f, 0.000f, 0.220f),  270.133f},
+    {"Hs", 2.00f, 2.00f, Vec3(0.902f, 0.000f, 0.180f),  269.134f},
+    {"Mt", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  278.156f},
+    {"Ds", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  281.165f},
+    {"Rg", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  281.166f},
+    {"Cn", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  285.177f},
+    {"Nh", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  286.182f},
+    {"Fl", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  289.190f},
+    {"Mc", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  289.194f},
+    {"Lv", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  293.204f},
+    {"Ts", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  293.208f},
+    {"Og", 2.00f, 2.00f, Vec3(0.922f, 0.000f, 0.149f),  294.214f}
+};
+
+// Radii, color and mass for an atomic number; out-of-range values get the unknown entry
+inline const ElementProperties& element_properties(int atomic_number) {
+    return ELEMENT_TABLE[(atomic_number >= 1 && atomic_number <= ELEMENT_COUNT) ? atomic_number : 0];
+}
+
+// Symbol for atomic numbers 1..118; "X" (unknown/dummy atom) for 0 and anything out of range
+inline const char* element_symbol(int atomic_number) {
+    return element_properties(atomic_number).symbol;
+}
+
+// Atomic number for a symbol token, taking its leading letters case-insensitively
+// ("C", "CL", "cl", "Fe2+"); 0 if unknown. O(1) via a direct-indexed table, no allocation.
+int atomic_number_from_symbol(const char* begin, const char* end);
+int atomic_number_from_symbol(const std::string& symbol);
+
+namespace element_detail {
+constexpr bool symbol_less(const char* a, const char* b) {
+    while (*a && *a == *b) { ++a; ++b; }
+    return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+constexpr std::array<uint8_t, ELEMENT_COUNT + 1> sort_by_symbol() {
+    std::array<uint8_t, ELEMENT_COUNT + 1> order{};
+    for (int z = 0; z <= ELEMENT_COUNT; ++z) order[z] = static_cast<uint8_t>(z);
+    for (int i = 1; i <= ELEMENT_COUNT; ++i) { // Insertion sort, evaluated at compile time
+        uint8_t key = order[i];
+        int j = i - 1;
+        while (j >= 0 && symbol_less(ELEMENT_TABLE[key].symbol, ELEMENT_TABLE[order[j]].symbol)) {
+            order[j + 1] = order[j];
+            --j;
+        }
+        order[j + 1] = key;
+    }
+    return order;
+}
+} // namespace element_detail
+
+// Atomic numbers (including 0) ordered alphabetically by symbol, for Hill-order formulas
+inline constexpr std::array<uint8_t, ELEMENT_COUNT + 1> ELEMENTS_BY_SYMBOL = element_detail::sort_by_symbol();
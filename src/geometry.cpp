@@ -1,17 +1,59 @@
 #include "geometry.h"
 #include "math.h"
+#include "mesh_optimizer.h"
+#include <emscripten/emscripten.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <map>
+#include <utility>
 
 // Sphere Mesh Data
-std::vector<float> sphere_vertices; // Will store position (x,y,z) and normal (nx,ny,nz)
-std::vector<unsigned int> sphere_indices;
+std::vector<MeshVertex> sphere_vertices;
+std::vector<uint16_t> sphere_indices;
 GLsizei sphere_index_count = 0;
 
 // Cylinder Mesh Data
-std::vector<float> cylinder_vertices; // Position (x,y,z) and normal (nx,ny,nz)
-std::vector<unsigned int> cylinder_indices;
+std::vector<MeshVertex> cylinder_vertices;
+std::vector<uint16_t> cylinder_indices;
 GLsizei cylinder_index_count = 0;
 
+MeshLod sphere_lods[LOD_LEVELS];
+MeshLod cylinder_lods[LOD_LEVELS];
+static SphereMeshType sphere_lods_type = SphereMeshType::Icosphere;
+
+static const int SPHERE_LOD_LATITUDES[LOD_LEVELS] = {32, 16, 10, 6};
+static const int SPHERE_LOD_LONGITUDES[LOD_LEVELS] = {32, 16, 12, 8};
+static const int ICOSPHERE_LOD_SUBDIVISIONS[LOD_LEVELS] = {3, 2, 1, 0}; // 1280, 320, 80, 20 triangles
+static const int CYLINDER_LOD_SEGMENTS[LOD_LEVELS] = {16, 10, 6, 4};
+
+static MeshVertex make_vertex(float px, float py, float pz, float nx, float ny, float nz) {
+    return MeshVertex{{px, py, pz}, pack_normal(nx, ny, nz)};
+}
+
+// Reorders the current mesh for the post-transform cache, then its vertices for fetch locality
+static void optimize_mesh(std::vector<MeshVertex>& vertices, std::vector<uint16_t>& indices) {
+    optimize_vertex_cache(indices, vertices.size());
+    std::vector<uint16_t> new_index_of = remap_vertices_by_first_use(indices, vertices.size());
+    std::vector<MeshVertex> reordered(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) reordered[new_index_of[i]] = vertices[i];
+    vertices.swap(reordered);
+}
+
+// Appends the current mesh to the packed arrays and records its index range
+static void pack_lod(std::vector<MeshVertex>& packed_vertices, std::vector<uint16_t>& packed_indices,
+                     const std::vector<MeshVertex>& vertices, const std::vector<uint16_t>& indices, MeshLod& lod) {
+    size_t base_vertex = packed_vertices.size();
+    if (base_vertex + vertices.size() > 0xffff) {
+        std::cerr << "C++: LOD meshes exceed the 16-bit index range." << std::endl;
+        return;
+    }
+    lod.first_index = static_cast<GLsizei>(packed_indices.size());
+    lod.index_count = static_cast<GLsizei>(indices.size());
+    packed_vertices.insert(packed_vertices.end(), vertices.begin(), vertices.end());
+    for (uint16_t index : indices) packed_indices.push_back(static_cast<uint16_t>(index + base_vertex)); // No base-vertex draws in GLES3
+}
+
 void create_uv_sphere(float radius, int latitudes, int longitudes) {
     sphere_vertices.clear();
     sphere_indices.clear();
@@ -30,14 +72,8 @@ void create_uv_sphere(float radius, int latitudes, int longitudes) {
             float y = cosTheta;
             float z = sinPhi * sinTheta;
 
-            // Position
-            sphere_vertices.push_back(radius * x);
-            sphere_vertices.push_back(radius * y);
-            sphere_vertices.push_back(radius * z);
-            // Normal (for a sphere centered at origin, normal is just the normalized position vector)
-            sphere_vertices.push_back(x);
-            sphere_vertices.push_back(y);
-            sphere_vertices.push_back(z);
+            // For a sphere centered at origin, the normal is just the normalized position vector
+            sphere_vertices.push_back(make_vertex(radius * x, radius * y, radius * z, x, y, z));
         }
     }
 
@@ -46,17 +82,68 @@ void create_uv_sphere(float radius, int latitudes, int longitudes) {
             int first = (i * (longitudes + 1)) + j;
             int second = first + longitudes + 1;
 
-            sphere_indices.push_back(first);
-            sphere_indices.push_back(second);
-            sphere_indices.push_back(first + 1);
+            // Counter-clockwise seen from outside, so GL_BACK culling removes the far hemisphere.
+            // The first and last rings collapse to the poles, where one triangle of each quad has zero area.
+            if (i != 0) {
+                sphere_indices.push_back(first);
+                sphere_indices.push_back(first + 1);
+                sphere_indices.push_back(second);
+            }
+            if (i != latitudes - 1) {
+                sphere_indices.push_back(second);
+                sphere_indices.push_back(first + 1);
+                sphere_indices.push_back(second + 1);
+            }
+        }
+    }
+    sphere_index_count = static_cast<GLsizei>(sphere_indices.size());
+    std::cout << "UV Sphere created: " << sphere_vertices.size() << " vertices, " << sphere_index_count/3 << " triangles." << std::endl;
+}
+
+// Subdivided icosahedron: near-uniform triangles, so no slivers at the poles and fewer
+// triangles than a UV sphere of similar silhouette error.
+void create_icosphere(float radius, int subdivisions) {
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    std::vector<Vec3> points = {
+        Vec3(-1, t, 0), Vec3(1, t, 0), Vec3(-1, -t, 0), Vec3(1, -t, 0),
+        Vec3(0, -1, t), Vec3(0, 1, t), Vec3(0, -1, -t), Vec3(0, 1, -t),
+        Vec3(t, 0, -1), Vec3(t, 0, 1), Vec3(-t, 0, -1), Vec3(-t, 0, 1),
+    };
+    for (Vec3& p : points) p = p.normalize();
+    std::vector<uint16_t> faces = {
+        0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+        1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+        3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+        4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1,
+    };
 
-            sphere_indices.push_back(second);
-            sphere_indices.push_back(second + 1);
-            sphere_indices.push_back(first + 1);
+    for (int level = 0; level < subdivisions; ++level) {
+        // Each edge is split once; the midpoint is shared by the two triangles on either side
+        std::map<std::pair<uint16_t, uint16_t>, uint16_t> midpoints;
+        auto midpoint = [&](uint16_t a, uint16_t b) {
+            std::pair<uint16_t, uint16_t> key(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) return it->second;
+            uint16_t index = static_cast<uint16_t>(points.size());
+            points.push_back(((points[a] + points[b]) * 0.5f).normalize());
+            midpoints[key] = index;
+            return index;
+        };
+        std::vector<uint16_t> next;
+        next.reserve(faces.size() * 4);
+        for (size_t f = 0; f < faces.size(); f += 3) {
+            uint16_t a = faces[f], b = faces[f + 1], c = faces[f + 2];
+            uint16_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            next.insert(next.end(), {a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca});
         }
+        faces.swap(next);
     }
+
+    sphere_vertices.clear();
+    for (const Vec3& p : points) sphere_vertices.push_back(make_vertex(radius * p.x, radius * p.y, radius * p.z, p.x, p.y, p.z));
+    sphere_indices = faces;
     sphere_index_count = static_cast<GLsizei>(sphere_indices.size());
-    std::cout << "UV Sphere created: " << sphere_vertices.size()/6 << " vertices, " << sphere_index_count/3 << " triangles." << std::endl;
+    std::cout << "Icosphere created: " << sphere_vertices.size() << " vertices, " << sphere_index_count/3 << " triangles." << std::endl;
 }
 
 // Creates a cylinder along the Y axis, from y=-0.5 to y=0.5, with radius 1.
@@ -72,13 +159,9 @@ void create_cylinder_mesh(float radius, float height, int segments) {
         float x = radius * std::cos(angle);
         float z = radius * std::sin(angle);
 
-        // Vertex at bottom of side
-        cylinder_vertices.push_back(x); cylinder_vertices.push_back(-half_height); cylinder_vertices.push_back(z);
-        cylinder_vertices.push_back(x/radius); cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(z/radius); // Normal (outward)
-
-        // Vertex at top of side
-        cylinder_vertices.push_back(x); cylinder_vertices.push_back(half_height); cylinder_vertices.push_back(z);
-        cylinder_vertices.push_back(x/radius); cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(z/radius); // Normal (outward)
+        // Vertices at the bottom and top of the side, normals pointing outward
+        cylinder_vertices.push_back(make_vertex(x, -half_height, z, x / radius, 0.0f, z / radius));
+        cylinder_vertices.push_back(make_vertex(x, half_height, z, x / radius, 0.0f, z / radius));
     }
 
     for (int i = 0; i < segments; ++i) {
@@ -87,36 +170,121 @@ void create_cylinder_mesh(float radius, float height, int segments) {
         int next_bottom = (i + 1) * 2;
         int next_top = (i + 1) * 2 + 1;
 
+        // Counter-clockwise seen from outside
         cylinder_indices.push_back(current_bottom);
-        cylinder_indices.push_back(next_bottom);
         cylinder_indices.push_back(current_top);
+        cylinder_indices.push_back(next_bottom);
 
         cylinder_indices.push_back(current_top);
-        cylinder_indices.push_back(next_bottom);
         cylinder_indices.push_back(next_top);
+        cylinder_indices.push_back(next_bottom);
     }
 
     // Caps (simple triangle fan, could be improved for better normals at edges)
     // Top cap
-    int top_center_idx = cylinder_vertices.size() / 6;
-    cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(half_height); cylinder_vertices.push_back(0.0f); // Center vertex
-    cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(1.0f); cylinder_vertices.push_back(0.0f);    // Normal (up)
+    int top_center_idx = static_cast<int>(cylinder_vertices.size());
+    cylinder_vertices.push_back(make_vertex(0.0f, half_height, 0.0f, 0.0f, 1.0f, 0.0f)); // Center vertex, normal up
     for (int i = 0; i < segments; ++i) {
         cylinder_indices.push_back(top_center_idx);
-        cylinder_indices.push_back(i * 2 + 1);             // Current top edge vertex
         cylinder_indices.push_back((i + 1) * 2 + 1);         // Next top edge vertex
+        cylinder_indices.push_back(i * 2 + 1);             // Current top edge vertex
     }
 
     // Bottom cap
-    int bottom_center_idx = cylinder_vertices.size() / 6;
-    cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(-half_height); cylinder_vertices.push_back(0.0f);
-    cylinder_vertices.push_back(0.0f); cylinder_vertices.push_back(-1.0f); cylinder_vertices.push_back(0.0f);
+    int bottom_center_idx = static_cast<int>(cylinder_vertices.size());
+    cylinder_vertices.push_back(make_vertex(0.0f, -half_height, 0.0f, 0.0f, -1.0f, 0.0f));
     for (int i = 0; i < segments; ++i) {
         cylinder_indices.push_back(bottom_center_idx);
-        cylinder_indices.push_back((i + 1) * 2);        // Next bottom edge vertex (reversed for winding)
-        cylinder_indices.push_back(i * 2);            // Current bottom edge vertex
+        cylinder_indices.push_back(i * 2);            // Current bottom edge vertex (reversed from the top cap)
+        cylinder_indices.push_back((i + 1) * 2);        // Next bottom edge vertex
     }
 
     cylinder_index_count = static_cast<GLsizei>(cylinder_indices.size());
-    std::cout << "Cylinder mesh created: " << cylinder_vertices.size()/6 << " vertices, " << cylinder_index_count/3 << " triangles." << std::endl;
-} 
\ No newline at end of file
+    std::cout << "Cylinder mesh created: " << cylinder_vertices.size() << " vertices, " << cylinder_index_count/3 << " triangles." << std::endl;
+}
+
+static void create_sphere_level(SphereMeshType type, int level) {
+    if (type == SphereMeshType::Icosphere) {
+        create_icosphere(1.0f, ICOSPHERE_LOD_SUBDIVISIONS[level]);
+    } else {
+        create_uv_sphere(1.0f, SPHERE_LOD_LATITUDES[level], SPHERE_LOD_LONGITUDES[level]);
+    }
+}
+
+void create_sphere_lods(SphereMeshType type) {
+    std::vector<MeshVertex> packed_vertices;
+    std::vector<uint16_t> packed_indices;
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        create_sphere_level(type, level);
+        optimize_mesh(sphere_vertices, sphere_indices);
+        pack_lod(packed_vertices, packed_indices, sphere_vertices, sphere_indices, sphere_lods[level]);
+    }
+    sphere_vertices.swap(packed_vertices);
+    sphere_indices.swap(packed_indices);
+    sphere_index_count = static_cast<GLsizei>(sphere_indices.size());
+    sphere_lods_type = type;
+}
+
+void create_cylinder_lods() {
+    std::vector<MeshVertex> packed_vertices;
+    std::vector<uint16_t> packed_indices;
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        create_cylinder_mesh(1.0f, 1.0f, CYLINDER_LOD_SEGMENTS[level]);
+        optimize_mesh(cylinder_vertices, cylinder_indices);
+        pack_lod(packed_vertices, packed_indices, cylinder_vertices, cylinder_indices, cylinder_lods[level]);
+    }
+    cylinder_vertices.swap(packed_vertices);
+    cylinder_indices.swap(packed_indices);
+    cylinder_index_count = static_cast<GLsizei>(cylinder_indices.size());
+}
+
+// ACMR of the mesh in the given arrays at FIFO sizes 16 and 32, before and after optimize_mesh
+static void report_mesh(const char* name, int level, std::vector<MeshVertex>& vertices, std::vector<uint16_t>& indices,
+                        double* optimized_acmr16) {
+    const size_t n = vertices.size();
+    float before16 = average_cache_miss_ratio(indices.data(), indices.size(), n, 16);
+    float before32 = average_cache_miss_ratio(indices.data(), indices.size(), n, 32);
+    optimize_mesh(vertices, indices);
+    float after16 = average_cache_miss_ratio(indices.data(), indices.size(), n, 16);
+    float after32 = average_cache_miss_ratio(indices.data(), indices.size(), n, 32);
+    if (optimized_acmr16) *optimized_acmr16 = after16;
+    std::cout << "C++:   " << name << " LOD " << level << ": " << n << " vertices, " << indices.size() / 3
+              << " triangles, " << n * sizeof(MeshVertex) + indices.size() * sizeof(uint16_t) << " bytes; ACMR (FIFO 16/32) "
+              << before16 << "/" << before32 << " -> " << after16 << "/" << after32 << std::endl;
+}
+
+extern "C" {
+EMSCRIPTEN_KEEPALIVE
+double report_mesh_statistics() {
+    // Rebuilds each mesh in the scratch arrays; the packed LOD buffers are restored afterwards
+    std::vector<MeshVertex> saved_sphere_vertices, saved_cylinder_vertices;
+    std::vector<uint16_t> saved_sphere_indices, saved_cylinder_indices;
+    saved_sphere_vertices.swap(sphere_vertices);
+    saved_sphere_indices.swap(sphere_indices);
+    saved_cylinder_vertices.swap(cylinder_vertices);
+    saved_cylinder_indices.swap(cylinder_indices);
+
+    std::cout << "C++: Mesh statistics (" << sizeof(MeshVertex) << "-byte vertices, 16-bit indices):" << std::endl;
+    double finest_acmr = 0.0;
+    const SphereMeshType types[2] = {SphereMeshType::UV, SphereMeshType::Icosphere};
+    for (SphereMeshType type : types) {
+        for (int level = 0; level < LOD_LEVELS; ++level) {
+            create_sphere_level(type, level);
+            report_mesh(type == SphereMeshType::UV ? "UV sphere" : "Icosphere", level, sphere_vertices, sphere_indices,
+                        type == sphere_lods_type && level == 0 ? &finest_acmr : nullptr);
+        }
+    }
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        create_cylinder_mesh(1.0f, 1.0f, CYLINDER_LOD_SEGMENTS[level]);
+        report_mesh("Cylinder", level, cylinder_vertices, cylinder_indices, nullptr);
+    }
+
+    sphere_vertices.swap(saved_sphere_vertices);
+    sphere_indices.swap(saved_sphere_indices);
+    cylinder_vertices.swap(saved_cylinder_vertices);
+    cylinder_indices.swap(saved_cylinder_indices);
+    sphere_index_count = static_cast<GLsizei>(sphere_indices.size());
+    cylinder_index_count = static_cast<GLsizei>(cylinder_indices.size());
+    return finest_acmr;
+}
+}
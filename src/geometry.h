@@ -1,17 +1,48 @@
 #pragma once
 #include <vector>
+#include <cstdint>
 #include <GLES3/gl3.h>
 
+// Vertex of the primitive meshes: float position and the unit normal packed as
+// GL_INT_2_10_10_10_REV (x, y, z in signed normalized 10-bit fields), 16 bytes in total
+struct MeshVertex {
+    float position[3];
+    uint32_t normal;
+};
+
 // Sphere Mesh Data
-extern std::vector<float> sphere_vertices; // Will store position (x,y,z) and normal (nx,ny,nz)
-extern std::vector<unsigned int> sphere_indices;
+extern std::vector<MeshVertex> sphere_vertices;
+extern std::vector<uint16_t> sphere_indices; // Drawn as GL_UNSIGNED_SHORT
 extern GLsizei sphere_index_count;
 
 // Cylinder Mesh Data
-extern std::vector<float> cylinder_vertices; // Position (x,y,z) and normal (nx,ny,nz)
-extern std::vector<unsigned int> cylinder_indices;
+extern std::vector<MeshVertex> cylinder_vertices;
+extern std::vector<uint16_t> cylinder_indices;
 extern GLsizei cylinder_index_count;
 
+// Level-of-detail meshes: every LOD is packed into the mesh vectors above, finest first, and
+// addressed by its index range (indices are already offset to the packed vertex array)
+const int LOD_LEVELS = 4;
+struct MeshLod {
+    GLsizei first_index;
+    GLsizei index_count;
+};
+extern MeshLod sphere_lods[LOD_LEVELS];
+extern MeshLod cylinder_lods[LOD_LEVELS];
+
+enum class SphereMeshType { UV, Icosphere };
+
 // Functions
 void create_uv_sphere(float radius, int latitudes, int longitudes);
-void create_cylinder_mesh(float radius, float height, int segments); 
\ No newline at end of file
+void create_icosphere(float radius, int subdivisions);
+void create_cylinder_mesh(float radius, float height, int segments);
+// Every LOD is vertex-cache optimized and its vertices renumbered in first-use order
+void create_sphere_lods(SphereMeshType type); // Icospheres 1280 down to 20 triangles, or UV 32x32 down to 6x8
+void create_cylinder_lods();                  // Unit cylinders, 16 down to 4 segments
+
+extern "C" {
+    // Logs vertex/index sizes and the average cache miss ratio of every sphere and cylinder LOD
+    // before and after optimization, for both sphere types. Returns the ACMR of the finest
+    // sphere currently in use (FIFO cache of 16).
+    double report_mesh_statistics();
+}
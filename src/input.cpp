@@ -1,5 +1,6 @@
 #include "input.h"
 #include "math.h"
+#include "renderer.h"
 #include <algorithm>
 
 // Camera and Mouse Interaction State
@@ -49,6 +50,10 @@ EM_BOOL mousemove_callback(int eventType, const EmscriptenMouseEvent *mouseEvent
 
         last_mouse_x = mouseEvent->clientX;
         last_mouse_y = mouseEvent->clientY;
+        request_redraw();
+    } else {
+        // BVH ray query, O(log N) per move; targetX/Y are relative to the canvas
+        update_hovered_atom(static_cast<float>(mouseEvent->targetX), static_cast<float>(mouseEvent->targetY));
     }
     return EM_TRUE; // Consume the event
 }
@@ -66,6 +71,7 @@ EM_BOOL wheel_callback(int eventType, const EmscriptenWheelEvent *wheelEvent, vo
 
     camera_distance += scroll_amount * MOUSE_SENSITIVITY_ZOOM_PIXEL_MODE;
     camera_distance = std::max(MIN_CAMERA_DISTANCE, std::min(MAX_CAMERA_DISTANCE, camera_distance));
+    request_redraw();
     
     return EM_TRUE; // Consume the event to prevent default page scrolling
 } 
\ No newline at end of file
@@ -1,8 +1,13 @@
 // UI Controls management
 function initializeControls() {
     initializeRepresentationControl();
+    initializeRenderModeControl();
     initializeAppearanceControls();
     initializeAutoRotateControl();
+    initializeTrajectoryControls();
+    initializeSdfRecordControls();
+    initializeUnitCellControls();
+    initializeHoverDisplay();
 }
 
 function initializeRepresentationControl() {
@@ -29,6 +34,23 @@ function initializeRepresentationControl() {
     }
 }
 
+function initializeRenderModeControl() {
+    const renderModeSelect = document.getElementById('renderModeSelect');
+    if (renderModeSelect) {
+        renderModeSelect.addEventListener('change', function(event) {
+            const modeValue = parseInt(event.target.value);
+            if (Module.ccall) {
+                try {
+                    Module.ccall('set_render_mode', null, ['number'], [modeValue]);
+                    Module.print(`Rendering set to: ${event.target.options[event.target.selectedIndex].text}`);
+                } catch (e) { Module.printErr("Error calling set_render_mode: " + e); }
+            }
+        });
+    } else {
+        Module.printErr("Could not find renderModeSelect element.");
+    }
+}
+
 function initializeAppearanceControls() {
     const atomScaleSlider = document.getElementById('atomScaleSlider');
     const atomScaleValueSpan = document.getElementById('atomScaleValue');
@@ -111,4 +133,179 @@ function initializeAutoRotateControl() {
     } else {
         Module.printErr("Could not find auto-rotate toggle button.");
     }
-} 
\ No newline at end of file
+} 
+
+function initializeTrajectoryControls() {
+    const trajectoryGroup = document.getElementById('trajectoryGroup');
+    const frameSlider = document.getElementById('trajectoryFrameSlider');
+    const frameValueSpan = document.getElementById('trajectoryFrameValue');
+    const fpsSlider = document.getElementById('trajectoryFpsSlider');
+    const fpsValueSpan = document.getElementById('trajectoryFpsValue');
+    const playToggle = document.getElementById('trajectoryPlayToggle');
+    let isPlaying = false;
+    let frameCount = 0;
+    let pollTimer = null;
+
+    if (!trajectoryGroup || !frameSlider || !frameValueSpan || !fpsSlider || !fpsValueSpan || !playToggle) {
+        Module.printErr("Could not find trajectory control elements.");
+        return;
+    }
+
+    function showFrame(frame) {
+        frameSlider.value = frame;
+        frameValueSpan.textContent = `${frame + 1} / ${frameCount}`;
+    }
+
+    function setPlaying(playing) {
+        isPlaying = playing;
+        playToggle.textContent = playing ? '⏸️ Pause Trajectory' : '▶️ Play Trajectory';
+        playToggle.style.backgroundColor = playing ? 'var(--danger-color)' : 'var(--primary-accent-color)';
+        if (pollTimer) { clearInterval(pollTimer); pollTimer = null; }
+        if (playing) {
+            // Playback runs in C++ from render_frame; poll only to keep the slider in sync
+            pollTimer = setInterval(function() {
+                showFrame(Module.ccall('get_trajectory_current_frame', 'number', [], []));
+            }, 100);
+        }
+    }
+
+    frameSlider.addEventListener('input', function(event) {
+        const frame = parseInt(event.target.value);
+        try {
+            Module.ccall('set_trajectory_frame', null, ['number'], [frame]);
+            showFrame(frame);
+        } catch (e) { Module.printErr("Error calling set_trajectory_frame: " + e); }
+    });
+
+    fpsSlider.addEventListener('input', function(event) {
+        const fps = parseInt(event.target.value);
+        fpsValueSpan.textContent = fps;
+        if (isPlaying) {
+            try {
+                Module.ccall('play_trajectory', null, ['number'], [fps]);
+            } catch (e) { Module.printErr("Error calling play_trajectory: " + e); }
+        }
+    });
+
+    playToggle.addEventListener('click', function() {
+        try {
+            if (isPlaying) {
+                Module.ccall('pause_trajectory', null, [], []);
+            } else {
+                Module.ccall('play_trajectory', null, ['number'], [parseInt(fpsSlider.value)]);
+            }
+            setPlaying(!isPlaying);
+        } catch (e) { Module.printErr("Error toggling trajectory playback: " + e); }
+    });
+
+    // Called after every load to show or hide the controls for the new structure
+    window.updateTrajectoryControls = function() {
+        try {
+            frameCount = Module.ccall('get_trajectory_frame_count', 'number', [], []);
+        } catch (e) {
+            frameCount = 0;
+        }
+        setPlaying(false);
+        trajectoryGroup.style.display = frameCount > 1 ? '' : 'none';
+        frameSlider.max = Math.max(frameCount - 1, 0);
+        showFrame(0);
+    };
+}
+
+function initializeSdfRecordControls() {
+    const sdfRecordGroup = document.getElementById('sdfRecordGroup');
+    const recordInput = document.getElementById('sdfRecordInput');
+    const recordValueSpan = document.getElementById('sdfRecordValue');
+    const prevButton = document.getElementById('sdfPrevRecord');
+    const nextButton = document.getElementById('sdfNextRecord');
+    let recordCount = 0;
+
+    if (!sdfRecordGroup || !recordInput || !recordValueSpan || !prevButton || !nextButton) {
+        Module.printErr("Could not find SDF record control elements.");
+        return;
+    }
+
+    function showRecord(record) {
+        recordInput.value = record + 1;
+        recordValueSpan.textContent = `${record + 1} / ${recordCount}`;
+    }
+
+    function selectRecord(record) {
+        if (recordCount === 0) return;
+        record = Math.min(Math.max(record, 0), recordCount - 1);
+        try {
+            Module.ccall('set_sdf_record', null, ['number'], [record]);
+            showRecord(Module.ccall('get_sdf_current_record', 'number', [], []));
+            if (window.updateMoleculeInfoDisplay) {
+                window.updateMoleculeInfoDisplay();
+            }
+        } catch (e) { Module.printErr("Error calling set_sdf_record: " + e); }
+    }
+
+    recordInput.addEventListener('change', function(event) {
+        selectRecord(parseInt(event.target.value) - 1);
+    });
+    prevButton.addEventListener('click', function() {
+        selectRecord(parseInt(recordInput.value) - 2);
+    });
+    nextButton.addEventListener('click', function() {
+        selectRecord(parseInt(recordInput.value));
+    });
+
+    // Called after every load to show or hide the record selector for the new structure
+    window.updateSdfRecordControls = function() {
+        try {
+            recordCount = Module.ccall('get_sdf_record_count', 'number', [], []);
+        } catch (e) {
+            recordCount = 0;
+        }
+        sdfRecordGroup.style.display = recordCount > 1 ? '' : 'none';
+        recordInput.max = Math.max(recordCount, 1);
+        showRecord(0);
+    };
+}
+
+function initializeUnitCellControls() {
+    const unitCellGroup = document.getElementById('unitCellGroup');
+    const replicationSelect = document.getElementById('cellReplicationSelect');
+    if (!unitCellGroup || !replicationSelect) {
+        Module.printErr("Could not find unit cell control elements.");
+        return;
+    }
+
+    // The same count along every periodic lattice vector; the choice carries over to the next load
+    replicationSelect.addEventListener('change', function(event) {
+        const count = parseInt(event.target.value);
+        try {
+            Module.ccall('set_cell_replication', null, ['number', 'number', 'number'], [count, count, count]);
+        } catch (e) { Module.printErr("Error calling set_cell_replication: " + e); }
+    });
+
+    // Called after every load to show the supercell selector only for periodic structures
+    window.updateUnitCellControls = function() {
+        let periodicAxes = 0;
+        try {
+            periodicAxes = Module.ccall('get_cell_periodic_axes', 'number', [], []);
+        } catch (e) {
+            periodicAxes = 0;
+        }
+        unitCellGroup.style.display = periodicAxes !== 0 ? '' : 'none';
+    };
+}
+
+// The C++ mousemove callback picks the atom under the cursor through the BVH; this only
+// displays the result
+function initializeHoverDisplay() {
+    const canvas = document.getElementById('canvas');
+    const hoveredAtomSpan = document.getElementById('hoveredAtomDisplay');
+    if (!canvas || !hoveredAtomSpan) {
+        Module.printErr("Could not find hovered atom display elements.");
+        return;
+    }
+    canvas.addEventListener('mousemove', function() {
+        if (!Module.ccall) return;
+        try {
+            hoveredAtomSpan.textContent = Module.ccall('get_hovered_atom_label', 'string', [], []);
+        } catch (e) { Module.printErr("Error calling get_hovered_atom_label: " + e); }
+    });
+}
@@ -4,9 +4,35 @@ function initializeEventListeners() {
     initializeFileLoadingEvents();
 }
 
-function call_cpp_load_molecule(xyzText) {
+// Refreshes the info panel and the per-format controls for the newly loaded structure
+function updateControlsAfterLoad() {
+    if (window.updateMoleculeInfoDisplay) {
+        window.updateMoleculeInfoDisplay();
+    }
+    if (window.updateTrajectoryControls) {
+        window.updateTrajectoryControls();
+    }
+    if (window.updateSdfRecordControls) {
+        window.updateSdfRecordControls();
+    }
+    if (window.updateUnitCellControls) {
+        window.updateUnitCellControls();
+    }
+}
+
+// C++ loader for a file name's extension; anything unrecognised is treated as XYZ
+function loaderForFileName(fileName) {
+    const name = fileName.toLowerCase();
+    if (name.endsWith('.pdb') || name.endsWith('.ent')) return 'load_molecule_from_pdb_string';
+    if (name.endsWith('.cif') || name.endsWith('.mmcif')) return 'load_molecule_from_mmcif_string';
+    if (name.endsWith('.sdf') || name.endsWith('.sd') || name.endsWith('.mol')) return 'load_sdf_from_string';
+    // Multi-frame XYZ files are indexed as trajectories; single structures load as before
+    return 'load_trajectory_from_xyz_string';
+}
+
+function call_cpp_load_molecule(xyzText, loader = 'load_trajectory_from_xyz_string') {
     if (xyzText.trim() === "") {
-        Module.printErr("No XYZ data to load.");
+        Module.printErr("No molecule data to load.");
         // Clear info if no data
         const moleculeNameSpan = document.getElementById('moleculeNameDisplay');
         const moleculeFormulaSpan = document.getElementById('moleculeFormulaDisplay');
@@ -16,15 +42,13 @@ function call_cpp_load_molecule(xyzText) {
     }
     try {
         Module.ccall(
-            'load_molecule_from_xyz_string',
+            loader,
             null, 
             ['string'],
             [xyzText]
         );
         Module.print("JS: Called C++ to load molecule.");
-        if (window.updateMoleculeInfoDisplay) {
-            window.updateMoleculeInfoDisplay(); // Update info after loading
-        }
+        updateControlsAfterLoad();
     } catch (e) {
         console.error("JS: Error calling C++ function:", e);
         Module.printErr("Error calling C++ load function. See console.");
@@ -35,13 +59,52 @@ function call_cpp_load_molecule(xyzText) {
     }
 }
 
+// Decoded MOLB buffers (see molecule-library-binary.js), kept so reselecting skips the base64 decode
+const libraryBinaryCache = {};
+
+function call_cpp_load_binary(bytes) {
+    const ptr = Module._malloc(bytes.length);
+    try {
+        Module.HEAPU8.set(bytes, ptr);
+        return Module.ccall('load_molecule_from_binary', 'number', ['number', 'number'], [ptr, bytes.length]) === 1;
+    } finally {
+        Module._free(ptr);
+    }
+}
+
+// Library molecules load from their pre-converted binary (coordinates plus precomputed bonds),
+// falling back to parsing the XYZ text when no binary is available
+function load_library_molecule(key) {
+    const moleculeData = MOLECULE_LIBRARY[key];
+    document.getElementById('xyzData').value = moleculeData.xyz;
+    const encoded = typeof MOLECULE_LIBRARY_BINARY !== 'undefined' ? MOLECULE_LIBRARY_BINARY[key] : undefined;
+    if (encoded) {
+        let bytes = libraryBinaryCache[key];
+        if (!bytes) {
+            const raw = atob(encoded);
+            bytes = new Uint8Array(raw.length);
+            for (let i = 0; i < raw.length; i++) bytes[i] = raw.charCodeAt(i);
+            libraryBinaryCache[key] = bytes;
+        }
+        try {
+            if (call_cpp_load_binary(bytes)) {
+                updateControlsAfterLoad();
+                return;
+            }
+        } catch (e) {
+            console.error("JS: Error loading binary molecule:", e);
+        }
+        Module.printErr(`Binary data for ${moleculeData.name} failed to load; parsing XYZ instead.`);
+    }
+    call_cpp_load_molecule(moleculeData.xyz);
+}
+
 function initializeLibraryLoadingEvents() {
     document.getElementById('loadFromLibrary').addEventListener('click', function() {
         const selectedMolecule = document.getElementById('moleculeLibrary').value;
         if (selectedMolecule && MOLECULE_LIBRARY[selectedMolecule]) {
             const moleculeData = MOLECULE_LIBRARY[selectedMolecule];
-            document.getElementById('xyzData').value = moleculeData.xyz;
-            call_cpp_load_molecule(moleculeData.xyz);
+            load_library_molecule(selectedMolecule);
             Module.print(`Loaded ${moleculeData.name} (${moleculeData.formula}) from library.`);
         } else {
             Module.printErr("No molecule selected or molecule not found in library.");
@@ -58,8 +121,7 @@ function initializeLibraryLoadingEvents() {
             document.getElementById('moleculeLibrary').value = randomKey;
             
             // Load the molecule
-            document.getElementById('xyzData').value = moleculeData.xyz;
-            call_cpp_load_molecule(moleculeData.xyz);
+            load_library_molecule(randomKey);
             Module.print(`Randomly loaded ${moleculeData.name} (${moleculeData.formula}) from library.`);
         } else {
             Module.printErr("No molecules available in library.");
@@ -67,15 +129,114 @@ function initializeLibraryLoadingEvents() {
     });
 }
 
+// start_background_load formats (see loader.h), by the synchronous loader they replace
+const BACKGROUND_LOAD_FORMATS = {
+    'load_trajectory_from_xyz_string': 0,
+    'load_molecule_from_pdb_string': 1,
+    'load_molecule_from_mmcif_string': 2
+};
+const BackgroundLoadState = { Idle: 0, Loading: 1, Done: 2, Failed: 3, Cancelled: 4 };
+let backgroundLoadGeneration = 0; // Lets a superseded poll loop stop
+
+// Parses, bonds and prepares the file on a C++ thread while the current molecule keeps rendering.
+// The new molecule is swapped in between two frames; until then the name shows the progress.
+// Escape cancels the load.
+function load_in_background(bytes, format, fileName) {
+    const ptr = Module._malloc(bytes.length);
+    let started = false;
+    try {
+        Module.HEAPU8.set(bytes, ptr);
+        started = Module.ccall('start_background_load', 'number', ['number', 'number', 'number'], [ptr, bytes.length, format]) === 1;
+    } finally {
+        Module._free(ptr); // C++ keeps its own copy
+    }
+    if (!started) {
+        Module.printErr(`Failed to start loading ${fileName}.`);
+        return;
+    }
+    const generation = ++backgroundLoadGeneration;
+    const moleculeNameSpan = document.getElementById('moleculeNameDisplay');
+    const poll = function() {
+        if (generation !== backgroundLoadGeneration) return;
+        const state = Module.ccall('get_background_load_state', 'number', [], []);
+        if (state === BackgroundLoadState.Loading) {
+            const percent = Math.round(100 * Module.ccall('get_background_load_progress', 'number', [], []));
+            if (moleculeNameSpan) moleculeNameSpan.textContent = `Loading ${fileName}\u2026 ${percent}%`;
+            requestAnimationFrame(poll);
+            return;
+        }
+        if (state === BackgroundLoadState.Done) Module.print(`JS: Loaded ${fileName} in the background.`);
+        else if (state === BackgroundLoadState.Failed) Module.printErr(`Failed to parse ${fileName}.`);
+        else Module.print(`JS: Loading ${fileName} was cancelled.`);
+        updateControlsAfterLoad(); // Shows whichever molecule is displayed now
+    };
+    requestAnimationFrame(poll);
+}
+
+// Files above this size are streamed into the C++ parser chunk by chunk instead of being
+// read into one JS string (which is then UTF-8 encoded and copied into the WASM heap).
+// Frames after the first are indexed while streaming and play back as a trajectory.
+// Streamed files are not echoed into the textarea.
+const STREAMING_LOAD_THRESHOLD = 16 * 1024 * 1024;
+
+async function stream_file_to_cpp(file) {
+    const reader = file.stream().getReader();
+    let chunkPtr = 0;
+    let chunkCapacity = 0;
+    Module.ccall('xyz_stream_begin', null, ['number'], [file.size]);
+    try {
+        while (true) {
+            const { done, value } = await reader.read();
+            if (done) break;
+            if (value.length > chunkCapacity) { // One heap buffer, reused for every chunk
+                if (chunkPtr) Module._free(chunkPtr);
+                chunkPtr = Module._malloc(value.length);
+                chunkCapacity = value.length;
+            }
+            Module.HEAPU8.set(value, chunkPtr);
+            const wantsMore = Module.ccall('xyz_stream_feed', 'number', ['number', 'number'], [chunkPtr, value.length]);
+            if (!wantsMore) {
+                await reader.cancel(); // Parse error, or the rest is not further frames; skip it
+                break;
+            }
+        }
+    } finally {
+        if (chunkPtr) Module._free(chunkPtr);
+    }
+    const ok = Module.ccall('xyz_stream_finish', 'number', [], []);
+    Module.print(ok ? `JS: Streamed ${file.name} (${(file.size / 1e6).toFixed(1)} MB) into C++.` : `JS: Failed to parse ${file.name}.`);
+    updateControlsAfterLoad();
+}
+
 function initializeFileLoadingEvents() {
     document.getElementById('xyzFilePicker').addEventListener('change', function(event) {
         const file = event.target.files[0];
-        if (file) {
+        const loader = file ? loaderForFileName(file.name) : null;
+        const isXyz = loader === 'load_trajectory_from_xyz_string';
+        if (file && isXyz && file.size > STREAMING_LOAD_THRESHOLD && file.stream) {
+            document.getElementById('xyzData').value = `(${file.name} streamed directly; too large to display)`;
+            stream_file_to_cpp(file).catch(function(e) {
+                console.error("File streaming error:", e);
+                Module.printErr("Error streaming file. See console.");
+            });
+        } else if (file && loader in BACKGROUND_LOAD_FORMATS) {
+            const reader = new FileReader();
+            reader.onload = function(e) {
+                const bytes = new Uint8Array(e.target.result);
+                document.getElementById('xyzData').value = new TextDecoder().decode(bytes);
+                load_in_background(bytes, BACKGROUND_LOAD_FORMATS[loader], file.name);
+            };
+            reader.onerror = function(e) {
+                console.error("File reading error:", e);
+                Module.printErr("Error reading file.");
+            };
+            reader.readAsArrayBuffer(file);
+        } else if (file) {
             const reader = new FileReader();
             reader.onload = function(e) {
                 const fileContent = e.target.result;
                 document.getElementById('xyzData').value = fileContent; 
-                call_cpp_load_molecule(fileContent);
+                call_cpp_load_molecule(fileContent, loader);
             };
             reader.onerror = function(e) {
                 console.error("File reading error:", e);
@@ -86,4 +247,9 @@ function initializeFileLoadingEvents() {
             Module.print("No file selected for upload.");
         }
     });
-} 
\ No newline at end of file
+    document.addEventListener('keydown', function(event) {
+        if (event.key === 'Escape' && Module.ccall) {
+            Module.ccall('cancel_background_load', null, [], []);
+        }
+    });
+}
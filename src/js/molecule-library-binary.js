@@ -0,0 +1,29 @@
+// Generated by tools/build_library.py from molecule-library.js; do not edit.
+// MOLB binaries (see src/molecule_binary.h) with precomputed bonds, base64 encoded.
+const MOLECULE_LIBRARY_BINARY = {
+    water: "TU9MQgEAIAADAAAAAgAAAA4AAAAAAAAAAAAAAAAAAABXYXRlciBtb2xlY3VsZQAAAAAAAAAAAAAAAAAAAAAAABzwQT8c8EG/oz/0PYE/9L6BP/S+CAEBAAAAAAABAAAAAAAAAAIAAAABAQAA",
+    methane: "TU9MQgEAIAAFAAAABAAAABAAAAAAAAAAAAAAAAAAAABNZXRoYW5lIG1vbGVjdWxlAAAAAOENIT/hDSG/4Q0hv+ENIT8AAAAA4Q0hP+ENIb/hDSE/4Q0hvwAAAADhDSE/4Q0hP+ENIb/hDSG/BgEBAQEAAAAAAAAAAQAAAAAAAAACAAAAAAAAAAMAAAAAAAAABAAAAAEBAQE=",
+    ammonia: "TU9MQgEAIAAEAAAAAwAAABAAAAAAAAAAAAAAAAAAAABBbW1vbmlhIG1vbGVjdWxlAAAAAAAAAACZuk8/mbpPvwAAAADJ5W8/yeXvvsnl776uZOc9pPqGvqT6hr6k+oa+BwEBAQAAAAABAAAAAAAAAAIAAAAAAAAAAwAAAAEBAQA=",
+    carbon_dioxide: "TU9MQgEAIAADAAAAAgAAABcAAAAAAAAAAAAAAAAAAABDYXJib24gZGlveGlkZSBtb2xlY3VsZQAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAMeUPwDHlL8GCAgAAAAAAAEAAAAAAAAAAgAAAAEBAAA=",
+    ethanol: "TU9MQgEAIAAJAAAACAAAABAAAAAAAAAAAAAAAAAAAABFdGhhbm9sIG1vbGVjdWxl1ZU/v6iMNz9QNpU/fT+VvwjJjr8IyY6/CMmOPwjJjj+EZAdAmUd+vNdR1TwPuZ0/xSAQv4Y45r6GOII/MuZOv9dR1TwPuZ0/mKPHPBQFer2lFOQ+jnVRv2Zmdj+Yo8c8xSAQvwjJjr+lFOQ+BgYIAQEBAQEBAAAAAAAAAAEAAAAAAAAAAwAAAAAAAAAEAAAAAAAAAAUAAAABAAAAAgAAAAEAAAAGAAAAAQAAAAcAAAACAAAACAAAAAEBAQEBAQEB",
+    acetone: "TU9MQgEAIAAKAAAACQAAABAAAAAAAAAAAAAAAAAAAABBY2V0b25lIG1vbGVjdWxlAAAAAGDlwD9g5UC/YOVAvzm08D85tPA/ObTwP76f2r6+n9q+5dDqvwAAAAAAAAAAPQqnvz0Kpz+PwgW/j8IFv4/ChT+F6+m/hevpvz0Kp78AAAAAAAAAAAAAAAAAAAAAUI1nv1CNZz8AAAAAUI1nv1CNZz8AAAAABgYGCAEBAQEBAQAAAAAAAAEAAAAAAAAAAgAAAAAAAAADAAAAAQAAAAQAAAABAAAABQAAAAEAAAAGAAAAAgAAAAcAAAACAAAACAAAAAIAAAAJAAAAAQEBAQEBAQEBAAAA",
+    benzene: "TU9MQgEAIAAMAAAADAAAABAAAAAAAAAAAAAAAAAAAABCZW56ZW5lIG1vbGVjdWxlIbCyPyGwMj8hsDK/IbCyvyGwMr8hsDI/PQofQD0Knz89Cp+/PQofwD0Kn789Cp8/AAAAAIPAmj+DwJo/AAAAAIPAmr+DwJq/AAAAAF66CUBeuglAAAAAAF66CcBeugnAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABgYGBgYGAQEBAQEBAAAAAAEAAAAAAAAABQAAAAAAAAAGAAAAAQAAAAIAAAABAAAABwAAAAIAAAADAAAAAgAAAAgAAAADAAAABAAAAAMAAAAJAAAABAAAAAUAAAAEAAAACgAAAAUAAAALAAAAAQEBAQEBAQEBAQEB",
+    toluene: "TU9MQgEAIAAPAAAADwAAABAAAAAAAAAAAAAAAAAAAABUb2x1ZW5lIG1vbGVjdWxlAAAAACGwsj8ZBAZAIbCyPwAAAAAhsDK/IbAyvzm0+D9GtktAObT4PzEIDL9qvOS/Di0yvmq85L8OLTK+AAAAAAAAAACDwJo/g8AaQIPAGkCDwJo/IbCyv3Nocb+DwJo/oBpXQKAaV0CDwJo/LbIVwCGwsr8hsLK/AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABzaHE/BgYGBgYGBgEBAQEBAQEBAAAAAAABAAAAAAAAAAUAAAAAAAAABgAAAAEAAAACAAAAAQAAAAcAAAACAAAAAwAAAAIAAAAIAAAAAwAAAAQAAAADAAAACQAAAAQAAAAFAAAABAAAAAoAAAAFAAAACwAAAAYAAAAMAAAABgAAAA0AAAAGAAAADgAAAAEBAQEBAQEBAQEBAQEBAQA=",
+    acetonitrile: "TU9MQgEAIAAGAAAABQAAABUAAAAAAAAAAAAAAAAAAABBY2V0b25pdHJpbGUgbW9sZWN1bGUAAAAAAAAAAAAAAAAAAACBlYM/gZUDv4GVA78AAAAAAAAAAAAAAAAAAAAACtdjvwrXYz8AAAAAvp+6PxSuJ0BvEsO+bxLDvm8Sw74GBgcBAQEAAAAAAAABAAAAAAAAAAMAAAAAAAAABAAAAAAAAAAFAAAAAQAAAAIAAAABAQEBAQAAAA==",
+    caffeine: "TU9MQgEAIAAWAAAAFwAAABEAAAAAAAAAAAAAAAAAAABDYWZmZWluZSBtb2xlY3VsZQAAAG8So78K12O/YOXQPoPASj+6SYy+rBwKQCGwMkAhsDJArBwKQArXYz+sHCrAZDuHQLByKL9vEsO/IbAyQGDl0D5zaEHAc2hBwKwcKsBI4ZJASOGSQEjhkkCLbGe+dZOIP3WTiD+LbGe+dZOIv4tsZ75vEqO/CtdjP6wcCkCsHApAsHIovwrXYz83iRHAAiv3P3NoQUBzaEFAukmMvrpJjL4AAOC/YOXQPmDl0D4CK/c/AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAArXYz8K12O/AAAAAArXYz8K12O/AAAAAAcGBwYGBggHBgcGBggBAQEBAQEBAQEAAAAAAAABAAAAAAAAAAQAAAAAAAAACgAAAAEAAAACAAAAAQAAAA0AAAACAAAAAwAAAAIAAAAJAAAAAwAAAAQAAAADAAAABQAAAAQAAAAMAAAABQAAAAYAAAAFAAAABwAAAAcAAAAIAAAABwAAAAsAAAAIAAAACQAAAAgAAAAOAAAACQAAAA8AAAAKAAAAEAAAAAoAAAARAAAACgAAABIAAAALAAAAEwAAAAsAAAAUAAAACwAAABUAAAABAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQA=",
+    aspirin: "TU9MQgEAIAAUAAAAFAAAABAAAAAAAAAAAAAAAAAAAABBc3BpcmluIG1vbGVjdWxlAAAAACGwsj8ZBAZAIbCyPwAAAAAhsDK/IbAyvxkEBsAhsDLAdZOAwClcX0ApXF9AeemWQDm0+D85tPg/MQgMv2q85L8OLTK+6SYRwCPbjUAAAAAAAAAAAIPAmj+DwBpAg8AaQIPAmj8hsLK/IbCyv1K4JsBSuCbAg8CaP1K4JkD4UwM/c2hxv6AaV0CgGldAg8CaPy2yFcBvEmPAUrgmQAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABgYGBgYGBggGCAYICAEBAQEBAQEAAAAAAQAAAAAAAAAFAAAAAAAAAAYAAAABAAAAAgAAAAEAAAANAAAAAgAAAAMAAAACAAAACgAAAAMAAAAEAAAAAwAAAA4AAAAEAAAABQAAAAQAAAAPAAAABQAAABAAAAAGAAAABwAAAAYAAAARAAAABwAAAAgAAAAIAAAACQAAAAgAAAASAAAACgAAAAsAAAAKAAAADAAAAAsAAAATAAAAAQEBAQEBAQEBAQEBAQEBAQEBAQE=",
+    glucose: "TU9MQgEAIAAVAAAAFQAAABAAAAAAAAAAAAAAAAAAAABHbHVjb3NlIG1vbGVjdWxlAAAAACGwsj8ZBAZAIbCyPwAAAAAhsDK/IbAyvxkEBkApXF9AGQQGQCGwMr8AAAAAIbCyPxkEBkAhsLI/AAAAAFg51L+8dENAZmaOQLx0Q0BYOdS/AAAAAAAAAACDwJo/g8AaQIPAGkCDwJo/g8Cav4PAmr+DwJo/xSBoQMUgaEAAAAAAAAAAAIPAmj+DwBpAg8AaQIPAmr+DwJq/g8CaP8UgaEDFIGhAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABaZIs/WmSLP1pkiz9aZIs/WmSLPwAAAAAAAAAAAAAAAAAAAAAAAAAABgYGBgYICAgICAgBAQEBAQEBAQEBAAAAAAAAAAEAAAAAAAAABQAAAAAAAAAGAAAAAAAAAAsAAAABAAAAAgAAAAEAAAAHAAAAAQAAAAwAAAACAAAAAwAAAAIAAAAIAAAAAgAAAA0AAAADAAAABAAAAAMAAAAJAAAAAwAAAA4AAAAEAAAABQAAAAQAAAAKAAAABAAAAA8AAAAGAAAAEAAAAAcAAAARAAAACAAAABIAAAAJAAAAEwAAAAoAAAAUAAAAAQEBAQEBAQEBAQEBAQEBAQEBAQEBAAAA",
+    chloroform: "TU9MQgEAIAAFAAAAAwAAABMAAAAAAAAAAAAAAAAAAABDaGxvcm9mb3JtIG1vbGVjdWxlAAAAAAAAAAAAK4fWPyuH1r8AAAAAAAAAAAAAAADZzne/2c53v9nO9z8AAAAA+FPjP1CNF79QjRe/UI0XvwYREREBAAAAAAAAAAEAAAAAAAAAAgAAAAAAAAADAAAAAQEBAA==",
+    dmso: "TU9MQgEAIAAKAAAACQAAAA0AAAAAAAAAAAAAAAAAAABETVNPIG1vbGVjdWxlAAAAAAAAAAAAAABiEOg/YhDov2IQ6D9iEOg/9P0sQGIQ6L9iEOi/9P0swAAAAAAAAAAAAAAAAAAAAAAK12M/CtdjvwAAAAAK12O/CtdjPwAAAAAAAAAAEoPAPxKDQL8Sg0C/xSCwv8UgsL9vEgO+xSCwv8UgsL9vEgO+EAgGBgEBAQEBAQAAAAAAAAEAAAAAAAAAAgAAAAAAAAADAAAAAgAAAAQAAAACAAAABQAAAAIAAAAGAAAAAwAAAAcAAAADAAAACAAAAAMAAAAJAAAAAQEBAQEBAQEBAAAA",
+    thf: "TU9MQgEAIAANAAAADAAAAAwAAAAAAAAAAAAAAAAAAABUSEYgbW9sZWN1bGUAAAAAIbCyPxkEBkAhsLI/AAAAACGwsj8hsLI/RrZLQBkEBkAhsLI/IbCyP1pki78AAAAAAAAAAAAAAAAhsLI/GQQGQCGwsj8AAAAAWmSLvyGwsj8hsLI/RrZLQBkEBkAhsLI/IbCyPwAAAAAAAAAAAAAAACGwsj8hsLI/WmSLvwAAAAAAAAAAWmSLvyGwsj89Ch9AIbCyPz0KH0AIBgYGBgEBAQEBAQEBAAAAAAAAAAEAAAABAAAAAgAAAAEAAAAFAAAAAQAAAAYAAAACAAAAAwAAAAIAAAAHAAAAAgAAAAgAAAADAAAABAAAAAMAAAAJAAAAAwAAAAoAAAAEAAAACwAAAAQAAAAMAAAAAQEBAQEBAQEBAQEB",
+    ethyl_acetate: "TU9MQgEAIAAOAAAADQAAABYAAAAAAAAAAAAAAAAAAABFdGh5bCBhY2V0YXRlIG1vbGVjdWxlAAAAAAAAYOXAP7geDUC4Hg1AaJFtQLgejUDb+b6+2/m+vtv5vr5SuIJAUriCQBsvgUAbL4FAz/evQAAAAAAAAAAAaryUP2q8lL9qvJS/arwUwMuhBb/LoQW/j8KFPwrXI78K1yO/3SQ2wN0kNsBqvBTAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAUI1nv1CNZz8AAAAAUI1nv1CNZz9QjWe/UI1nPwAAAAAGBggIBgYBAQEBAQEBAQAAAAAAAAEAAAAAAAAABgAAAAAAAAAHAAAAAAAAAAgAAAABAAAAAgAAAAEAAAADAAAAAwAAAAQAAAAEAAAABQAAAAQAAAAJAAAABAAAAAoAAAAFAAAACwAAAAUAAAAMAAAABQAAAA0AAAABAQEBAQEBAQEBAQEBAAAA",
+    dichloromethane: "TU9MQgEAIAAFAAAABAAAABgAAAAAAAAAAAAAAAAAAABEaWNobG9yb21ldGhhbmUgbW9sZWN1bGUAAAAAAAAAAAAAAABaZIs/WmSLvwAAAAAAAAAA+FPjPyPbub4j27m+AAAAAPhT4z8AAAAAI9u5viPbub4GEREBAQAAAAAAAAABAAAAAAAAAAIAAAAAAAAAAwAAAAAAAAAEAAAAAQEBAQ==",
+    hexane: "TU9MQgEAIAAUAAAAEwAAAA8AAAAAAAAAAAAAAAAAAABIZXhhbmUgbW9sZWN1bGUAAAAAAGDlwD+4Hg1AaJFtQLgejUAQWL1A2/m+vtv5vr7b+b6+16PwP9ej8D/6fuo/+n7qP1K4gkBSuIJAGy+BQBsvgUCuR8lArkfJQK5HyUAAAAAAAAAAACGwsj8hsLI/IbAyQCGwMkDLoQW/y6EFv4/ChT/LoQW/y6EFvwaB9T8GgfU/d75fP3e+Xz+TGFRAkxhUQK5HEUCuRxFAaJF1QAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAFCNZ79QjWc/AAAAAFCNZ79QjWc/UI1nv1CNZz9QjWe/UI1nP1CNZ79QjWc/UI1nv1CNZz8AAAAABgYGBgYGAQEBAQEBAQEBAQEBAQEAAAAAAQAAAAAAAAAGAAAAAAAAAAcAAAAAAAAACAAAAAEAAAACAAAAAQAAAAkAAAABAAAACgAAAAIAAAADAAAAAgAAAAsAAAACAAAADAAAAAMAAAAEAAAAAwAAAA0AAAADAAAADgAAAAQAAAAFAAAABAAAAA8AAAAEAAAAEAAAAAUAAAARAAAABQAAABIAAAAFAAAAEwAAAAEBAQEBAQEBAQEBAQEBAQEBAQEA",
+    glycine: "TU9MQgEAIAAKAAAACQAAABAAAAAAAAAAAAAAAAAAAABHbHljaW5lIG1vbGVjdWxlAAAAAGDlwD+4Hg1AuB4NQCGwMr/b+b6+2/m+vmZmpr5mZqa+XI9KQAAAAAAAAAAAaryUP2q8lL8hsLI/y6EFv8uhBb8GgfU/BoH1P2q8lL8AAAAAAAAAAAAAAAAAAAAAAAAAAFCNZ79QjWc/RrZTv0a2Uz8AAAAABgYICAcBAQEBAQAAAAAAAAEAAAAAAAAABAAAAAAAAAAFAAAAAAAAAAYAAAABAAAAAgAAAAEAAAADAAAAAwAAAAkAAAAEAAAABwAAAAQAAAAIAAAAAQEBAQEBAQEBAAAA",
+    alanine: "TU9MQgEAIAANAAAADAAAABAAAAAAAAAAAAAAAAAAAABBbGFuaW5lIG1vbGVjdWxlAAAAAGDlwD8hsDK/uB4NQLgeDUAhsDK/2/m+vmZmpr5mZqa+arzkv2Zmpr5mZqa+XI9KQAAAAAAAAAAAIbCyP2q8lD9qvJS/IbCyv8uhBb8GgfU/BoH1PyGwsj8GgfW/BoH1v2q8lL8AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABQjWe/UI1nv1CNZz8AAAAARrZTv0a2Uz8AAAAABgYGCAgHAQEBAQEBAQAAAAAAAAABAAAAAAAAAAIAAAAAAAAABQAAAAAAAAAGAAAAAQAAAAMAAAABAAAABAAAAAIAAAAHAAAAAgAAAAgAAAACAAAACQAAAAQAAAAMAAAABQAAAAoAAAAFAAAACwAAAAEBAQEBAQEBAQEBAQ==",
+    hydrogen_peroxide: "TU9MQgEAIAAEAAAAAwAAABoAAAAAAAAAAAAAAAAAAABIeWRyb2dlbiBwZXJveGlkZSBtb2xlY3VsZQAAAAAAACPbuT8j27m+7FHoPwAAAAAAAAAACtdjPwrXY78AAAAAAAAAAAAAAAAAAAAACAgBAQAAAAABAAAAAAAAAAIAAAABAAAAAwAAAAEBAQA=",
+    sulfur_dioxide: "TU9MQgEAIAADAAAAAgAAABcAAAAAAAAAAAAAAAAAAABTdWxmdXIgZGlveGlkZSBtb2xlY3VsZQAAAAAAAAAAAAAAAAAAAAAAAAAAAGiRvT8AAAAAaJG9Py2yPb8QCAgAAAAAAAEAAAAAAAAAAgAAAAEBAAA=",
+    nitric_oxide: "TU9MQgEAIAACAAAAAQAAABUAAAAAAAAAAAAAAAAAAABOaXRyaWMgb3hpZGUgbW9sZWN1bGUAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAPhTkz8HCAAAAAAAAAEAAAABAAAA",
+    ibuprofen: "TU9MQgEAIAAhAAAAIgAAABIAAAAAAAAAAAAAAAAAAABJYnVwcm9mZW4gbW9sZWN1bGUAAAAAAAAhsLI/GQQGQCGwsj8AAAAAIbAyvyGwMr8ZBAbAIbAywHWTgMDpJhHAKVxfQBkEhkA5tPg/ObT4PzEIDL9qvOS/Di0yvlCNJ8DD9ci/8tJ9QPLSfUAtsm1AGy+VQBsvlUAQWJHAIbAyPyGwsj8OLTI+Di0yPo/C9T+PwvU/ZDtfPwAAAAAAAAAAg8CaP4PAGkCDwBpAg8CaPyGwsr8hsLK/UrgmwFK4JsBvEmPAg8CaP4PAGkBzaHG/oBpXQKAaV0CDwJo/LbIVwIts576LbOe+FK6HPsHKCUACK1dAg8AaQIPAGkBvEmPAUrgmwJMYdMBSuCbAUrgmwJMYdMCTGHTAWDmYwAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAACtdjPwrXY78AAAAAAAAAAAAAAAAK12M/CtdjvwrXYz8K12O/AAAAAAYGBgYGBgYGBggIBgYBAQEBAQEBAQEBAQEBBgYBAQEBAQAAAAAAAAABAAAAAAAAAAUAAAAAAAAABgAAAAEAAAACAAAAAQAAAA0AAAACAAAAAwAAAAIAAAALAAAAAwAAAAQAAAADAAAADgAAAAQAAAAFAAAABAAAAA8AAAAFAAAAEAAAAAYAAAAHAAAABgAAABEAAAAHAAAACAAAAAcAAAASAAAABwAAABMAAAAIAAAACQAAAAgAAAAKAAAACQAAABkAAAALAAAADAAAAAsAAAAUAAAACwAAABUAAAAMAAAAFQAAAAwAAAAWAAAADAAAABcAAAAMAAAAGAAAABEAAAAaAAAAGgAAABsAAAAaAAAAHAAAABoAAAAdAAAAGwAAAB4AAAAbAAAAHwAAABsAAAAgAAAAAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQEBAQAA",
+    paracetamol: "TU9MQgEAIAAUAAAAFQAAABQAAAAAAAAAAAAAAAAAAABQYXJhY2V0YW1vbCBtb2xlY3VsZQAAAAAhsLI/GQQGQCGwsj8AAAAAIbAyvyGwMr8pXF9AGQSGQH0/rUApXF9AObT4Pzm0+D8xCAy/arzkv1g51L+wcoBA8tJ9QPLSfUAtsm1AAAAAAAAAAACDwJo/g8AaQIPAGkCDwJo/g8Cav4PAmj+DwBpAg8AaQO58P75zaHG/oBpXQKAaV0CDwJo/g8CavzeJQT/dJAa+3SQGvgIrV0AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAArXYz8K12O/AAAAAAYGBgYGBggHBggGAQEBAQEBAQEBAAAAAAEAAAAAAAAABQAAAAAAAAAGAAAAAQAAAAIAAAABAAAACwAAAAIAAAADAAAAAgAAAAcAAAADAAAABAAAAAMAAAAMAAAABAAAAAUAAAAEAAAADQAAAAUAAAAOAAAABgAAAA8AAAAHAAAACAAAAAcAAAAKAAAABwAAABAAAAAIAAAACQAAAAgAAAATAAAACgAAABAAAAAKAAAAEQAAAAoAAAASAAAAAQEBAQEBAQEBAQEBAQEBAQEBAQEBAAAA",
+};
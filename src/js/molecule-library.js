@@ -124,7 +124,7 @@ H   -0.514000    0.890000   -0.381000`
     caffeine: {
         name: "Caffeine",
         formula: "C₈H₁₀N₄O₂",
-        xyz: `24
+        xyz: `22
 Caffeine molecule
 N   -1.274000   -0.226000    0.000000
 C   -0.890000    1.067000    0.000000
@@ -152,7 +152,7 @@ H    4.590000    1.931000    0.000000`
     aspirin: {
         name: "Aspirin",
         formula: "C₉H₈O₄",
-        xyz: `21
+        xyz: `20
 Aspirin molecule
 C    0.000000    0.000000    0.000000
 C    1.396000    0.000000    0.000000
@@ -178,7 +178,7 @@ H    4.433000    2.605000    0.000000`
     glucose: {
         name: "Glucose",
         formula: "C₆H₁₂O₆",
-        xyz: `24
+        xyz: `21
 Glucose molecule
 C    0.000000    0.000000    0.000000
 C    1.396000    0.000000    0.000000
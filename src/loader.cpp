@@ -0,0 +1,164 @@
+#include "loader.h"
+#include "renderer.h"
+#include "neighbor.h"
+#include "xyz_reader.h"
+#include "pdb_reader.h"
+#include "cif_reader.h"
+#include "molecule_binary.h"
+#include "trajectory.h"
+#include "sdf_library.h"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define LOADER_HAS_THREADS 1
+#include <thread>
+#endif
+
+// One load, shared by the main thread (state queries, cancel) and its loader thread
+struct LoadJob {
+    unsigned id = 0;
+    LoadFormat format = LoadFormat::Xyz;
+    std::string data; // Owned copy of the file; moved into the trajectory for multi-frame XYZ
+    std::atomic<int> state{static_cast<int>(LoadState::Loading)};
+    std::atomic<float> progress{0.0f};
+    std::atomic<bool> cancelled{false};
+};
+
+// Everything the main thread takes over at the swap
+struct LoadedScene {
+    unsigned job_id = 0;
+    Molecule molecule;
+    Trajectory trajectory;
+    PreparedInstances instances;
+    double load_ms = 0.0;
+};
+
+static std::shared_ptr<LoadJob> active_job; // Main thread only
+static unsigned next_job_id = 1;
+
+// Handoff from the loader thread to render_frame. Whoever replaces or takes a scene owns it, so
+// a scene from a superseded load is deleted either by the next publish or by the adoption.
+static std::atomic<LoadedScene*> published_scene(nullptr);
+
+// Moves a job out of Loading; a cancel from the main thread wins over a late failure
+static void finish_job(LoadJob& job, LoadState state) {
+    int expected = static_cast<int>(LoadState::Loading);
+    job.state.compare_exchange_strong(expected, static_cast<int>(state), std::memory_order_acq_rel);
+}
+
+// Records a finished stage; false once the job was cancelled, so the caller stops there
+static bool stage_done(LoadJob& job, float progress) {
+    if (job.cancelled.load(std::memory_order_acquire)) return false;
+    job.progress.store(progress, std::memory_order_relaxed);
+    return true;
+}
+
+// Reads no renderer globals: the display settings arrive as a copy in `instances`
+static void run_load(std::shared_ptr<LoadJob> job, PreparedInstances instances) {
+    double start = emscripten_get_now();
+    std::unique_ptr<LoadedScene> scene(new LoadedScene());
+    scene->job_id = job->id;
+    scene->instances = std::move(instances);
+    Molecule& mol = scene->molecule;
+    mol.name = "N/A";
+    mol.formula = "N/A";
+
+    const char* data = job->data.data();
+    size_t length = job->data.size();
+    bool ok = false;
+    switch (job->format) {
+        case LoadFormat::Xyz: ok = parse_xyz(data, length, mol); break;
+        case LoadFormat::Pdb: ok = parse_pdb(data, length, mol); break;
+        case LoadFormat::Mmcif: ok = parse_mmcif(data, length, mol); break;
+        case LoadFormat::Binary: ok = decode_molecule_binary(reinterpret_cast<const uint8_t*>(data), length, mol); break;
+    }
+    if (!ok) {
+        std::cerr << "C++: Background load failed; keeping the current molecule." << std::endl;
+        finish_job(*job, LoadState::Failed);
+        return;
+    }
+    if (!stage_done(*job, 0.5f)) return;
+
+    mol.formula = generate_molecular_formula(mol);
+    if (job->format == LoadFormat::Xyz) {
+        generate_bonds(mol); // XYZ carries no connectivity
+        Trajectory& traj = scene->trajectory;
+        index_xyz_frames(data, length, mol.atoms.size(), traj);
+        if (traj.frame_count() > 1) traj.text.swap(job->data); // The job is done reading it
+        else traj.clear();
+    }
+    if (!stage_done(*job, 0.75f)) return;
+
+    prepare_instances(mol, scene->instances);
+    if (!stage_done(*job, 0.95f)) return;
+
+    scene->load_ms = emscripten_get_now() - start;
+    delete published_scene.exchange(scene.release(), std::memory_order_acq_rel);
+}
+
+void adopt_background_load() {
+    std::unique_ptr<LoadedScene> scene(published_scene.exchange(nullptr, std::memory_order_acq_rel));
+    if (!scene) return;
+    if (!active_job || active_job->id != scene->job_id || active_job->cancelled.load(std::memory_order_acquire)) {
+        return; // Superseded or cancelled after it finished
+    }
+    std::swap(current_molecule, scene->molecule); // The previous molecule is freed with the scene
+    std::swap(current_trajectory, scene->trajectory);
+    current_sdf_library.clear();
+    adopt_prepared_instances(scene->instances);
+    active_job->progress.store(1.0f, std::memory_order_relaxed);
+    finish_job(*active_job, LoadState::Done);
+
+    std::cout << "C++: Loaded " << current_molecule.atoms.size() << " atoms and " << current_molecule.bonds.size()
+              << " bonds in the background in " << scene->load_ms << " ms." << std::endl;
+    std::cout << "C++: Molecule Name: " << current_molecule.name << ", Formula: " << current_molecule.formula << std::endl;
+    if (current_trajectory.frame_count() > 1) {
+        std::cout << "C++: Indexed trajectory with " << current_trajectory.frame_count() << " frames of "
+                  << current_trajectory.atom_count << " atoms." << std::endl;
+    }
+}
+
+extern "C" {
+EMSCRIPTEN_KEEPALIVE
+int start_background_load(const char* data, int length, int format) {
+    if (!data || length <= 0 || format < static_cast<int>(LoadFormat::Xyz) || format > static_cast<int>(LoadFormat::Binary)) {
+        std::cerr << "C++: Invalid background load (" << length << " bytes, format " << format << ")." << std::endl;
+        return 0;
+    }
+    cancel_background_load();
+    std::shared_ptr<LoadJob> job = std::make_shared<LoadJob>();
+    job->id = next_job_id++;
+    job->format = static_cast<LoadFormat>(format);
+    job->data.assign(data, static_cast<size_t>(length));
+    active_job = job;
+    std::cout << "C++: Loading " << length / 1.0e6 << " MB in the background..." << std::endl;
+#ifdef LOADER_HAS_THREADS
+    std::thread(run_load, job, current_instance_settings()).detach();
+#else
+    run_load(job, current_instance_settings());
+#endif
+    return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_background_load_state() {
+    return active_job ? active_job->state.load(std::memory_order_acquire) : static_cast<int>(LoadState::Idle);
+}
+
+EMSCRIPTEN_KEEPALIVE
+float get_background_load_progress() {
+    return active_job ? active_job->progress.load(std::memory_order_relaxed) : 0.0f;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void cancel_background_load() {
+    if (!active_job || active_job->state.load(std::memory_order_acquire) != static_cast<int>(LoadState::Loading)) return;
+    active_job->cancelled.store(true, std::memory_order_release);
+    finish_job(*active_job, LoadState::Cancelled);
+    std::cout << "C++: Background load cancelled." << std::endl;
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <emscripten/emscripten.h>
+
+// Background loading. The file is parsed, bonded and turned into render-ready instance data
+// in a separate Molecule on a loader thread while the current molecule keeps rendering; the
+// finished scene is published through an atomic pointer and swapped in by render_frame between
+// two frames. A failed or cancelled load leaves the displayed molecule untouched.
+//
+// Without WebAssembly threads (THREADS=0) the same steps run inside start_background_load,
+// and the result is still swapped in at the next frame.
+enum class LoadFormat { Xyz = 0, Pdb = 1, Mmcif = 2, Binary = 3 };
+enum class LoadState { Idle = 0, Loading = 1, Done = 2, Failed = 3, Cancelled = 4 };
+
+// Swaps a finished load into current_molecule, the trajectory and the renderer (main thread)
+void adopt_background_load();
+
+extern "C" {
+    // Copies length bytes of data and starts loading them in the given LoadFormat, cancelling any
+    // load in progress. XYZ data with several frames becomes the current trajectory.
+    // Returns 1 if the load started.
+    EMSCRIPTEN_KEEPALIVE
+    int start_background_load(const char* data, int length, int format);
+
+    // LoadState of the most recent load
+    EMSCRIPTEN_KEEPALIVE
+    int get_background_load_state();
+
+    // 0..1 by completed stage (parse, bonds, instances); 1 once the new molecule is displayed
+    EMSCRIPTEN_KEEPALIVE
+    float get_background_load_progress();
+
+    // Stops the current load at its next stage boundary; the displayed molecule stays
+    EMSCRIPTEN_KEEPALIVE
+    void cancel_background_load();
+}
@@ -30,28 +30,28 @@ int main() {
     if (!gl_context) { std::cerr << "Failed to create WebGL context." << std::endl; return 1; }
     emscripten_webgl_make_context_current(gl_context);
     
-    shader_program = create_shader_program(vertex_shader_source, fragment_shader_source);
-    if (!shader_program) { std::cerr << "Failed to create shader program." << std::endl; return 1; }
-    glUseProgram(shader_program);
-
-    position_attribute_location = glGetAttribLocation(shader_program, "aPosition");
-    normal_attribute_location = glGetAttribLocation(shader_program, "aNormal");
-    u_model_matrix_loc = glGetUniformLocation(shader_program, "uModelMatrix");
-    u_view_matrix_loc = glGetUniformLocation(shader_program, "uViewMatrix");
-    u_projection_matrix_loc = glGetUniformLocation(shader_program, "uProjectionMatrix");
-    u_color_loc = glGetUniformLocation(shader_program, "uColor");
-    u_normal_matrix_loc = glGetUniformLocation(shader_program, "uNormalMatrix");
-
-    if(position_attribute_location == -1 || u_model_matrix_loc == -1 || u_view_matrix_loc == -1 || u_projection_matrix_loc == -1 || u_color_loc == -1 || u_normal_matrix_loc == -1) {
-        std::cerr << "Error getting attribute or uniform locations." << std::endl;
-        // Optionally print which one failed.
+    sphere_instance_program = create_program(sphere_instance_vertex_shader_source, instance_fragment_shader_source);
+    if (!sphere_instance_program) { std::cerr << "Failed to create instanced sphere program." << std::endl; return 1; }
+    cylinder_instance_program = create_program(cylinder_instance_vertex_shader_source, instance_fragment_shader_source);
+    if (!cylinder_instance_program) { std::cerr << "Failed to create instanced cylinder program." << std::endl; return 1; }
+    sphere_impostor_program = create_program(sphere_impostor_vertex_shader_source, sphere_impostor_fragment_shader_source);
+    cylinder_impostor_program = create_program(cylinder_impostor_vertex_shader_source, cylinder_impostor_fragment_shader_source);
+    if (!sphere_impostor_program || !cylinder_impostor_program) {
+        std::cerr << "Failed to create impostor programs; impostor rendering will be unavailable." << std::endl;
+    }
+    surface_program = create_program(surface_vertex_shader_source, instance_fragment_shader_source);
+    if (!surface_program) {
+        std::cerr << "Failed to create surface program; the surface representation will be unavailable." << std::endl;
     }
+    setup_uniform_buffers(); // Camera and lighting blocks shared by all programs
     
     projection_matrix = Mat4::perspective(PI / 3.0f, 600.0f / 400.0f, 0.1f, 100.0f);
     current_molecule = create_sample_molecule(); 
     
     setup_sphere_geometry(); // Create and set up sphere VAO/VBOs
     setup_cylinder_geometry(); // Add this call
+    setup_impostor_geometry(); // Quads reading the sphere/cylinder instance buffers
+    setup_surface_geometry();  // Filled when the surface representation is first shown
     
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE); // Optional: cull back faces for spheres
@@ -1,11 +1,15 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "simd.h"
 
 const float PI = 3.1415926535f;
 
 struct Vec3 {
     float x, y, z;
-    Vec3(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
+    constexpr Vec3(float x = 0, float y = 0, float z = 0) : x(x), y(y), z(z) {}
     Vec3 operator+(const Vec3& other) const { return Vec3(x + other.x, y + other.y, z + other.z); }
     Vec3 operator-(const Vec3& other) const { return Vec3(x - other.x, y - other.y, z - other.z); }
     Vec3 operator*(float scalar) const { return Vec3(x * scalar, y * scalar, z * scalar); }
@@ -40,18 +44,20 @@ struct Mat4 {
         res.m[4] = -s; res.m[5] = c;
         return res;
     }
-    Mat4 operator*(const Mat4& other) const {
-        Mat4 result(0.0f);
-        for (int r = 0; r < 4; ++r) {
-            for (int c = 0; c < 4; ++c) {
-                float sum = 0.0f;
-                for (int k = 0; k < 4; ++k) {
-                    sum += m[k * 4 + r] * other.m[c * 4 + k];
-                }
-                result.m[c * 4 + r] = sum;
-            }
+    Mat4 operator*(const Mat4& other) const { Mat4 result(0.0f); multiply<Simd4>(*this, other, result); return result; }
+    // Column c of a * b is a's columns weighted by b's column c, one 4-lane multiply-add each
+    template <class B>
+    static void multiply(const Mat4& a, const Mat4& b, Mat4& out) {
+        static_assert(B::WIDTH == 4, "Mat4 columns need a 4-lane backend");
+        const typename B::V c0 = B::load(a.m), c1 = B::load(a.m + 4), c2 = B::load(a.m + 8), c3 = B::load(a.m + 12);
+        for (int c = 0; c < 4; ++c) {
+            const float* w = b.m + c * 4;
+            typename B::V r = B::mul(c0, B::splat(w[0]));
+            r = B::madd(c1, B::splat(w[1]), r);
+            r = B::madd(c2, B::splat(w[2]), r);
+            r = B::madd(c3, B::splat(w[3]), r);
+            B::store(out.m + c * 4, r);
         }
-        return result;
     }
     static Mat4 perspective(float fov_y_rad, float aspect, float z_near, float z_far) {
         Mat4 res(0.0f);
@@ -110,4 +116,85 @@ struct Mat4 {
         for(int i=0; i<4; ++i) for(int j=0; j<4; ++j) res.m[j*4+i] = m[i*4+j];
         return res;
     }
-}; 
\ No newline at end of file
+}; 
+
+// Unit normal packed as GL_INT_2_10_10_10_REV: x, y, z in signed normalized 10-bit fields, w = 0
+inline uint32_t pack_normal(float x, float y, float z) {
+    auto field = [](float v) {
+        int q = static_cast<int>(std::lround(std::max(-1.0f, std::min(1.0f, v)) * 511.0f));
+        return static_cast<uint32_t>(q) & 0x3ffu; // Two's complement in 10 bits
+    };
+    return field(x) | (field(y) << 10) | (field(z) << 20);
+}
+
+// Batched kernels over structure-of-arrays coordinates (AtomArrays::x/y/z and the like), WIDTH
+// elements per step with a scalar tail. The backend defaults to the widest one compiled in;
+// pass SimdScalar to get the reference result.
+
+// out = m * (x, y, z, 1) for n points, dropping w (affine transforms). Outputs may alias inputs.
+template <class B = SimdNative>
+void transform_points(const Mat4& m, const float* x, const float* y, const float* z, size_t n,
+                      float* out_x, float* out_y, float* out_z) {
+    typedef typename B::V V;
+    const float* a = m.m;
+    const V m0 = B::splat(a[0]), m1 = B::splat(a[1]), m2 = B::splat(a[2]);
+    const V m4 = B::splat(a[4]), m5 = B::splat(a[5]), m6 = B::splat(a[6]);
+    const V m8 = B::splat(a[8]), m9 = B::splat(a[9]), m10 = B::splat(a[10]);
+    const V t0 = B::splat(a[12]), t1 = B::splat(a[13]), t2 = B::splat(a[14]);
+    size_t i = 0;
+    for (; i + B::WIDTH <= n; i += B::WIDTH) {
+        V vx = B::load(x + i), vy = B::load(y + i), vz = B::load(z + i);
+        B::store(out_x + i, B::madd(m8, vz, B::madd(m4, vy, B::madd(m0, vx, t0))));
+        B::store(out_y + i, B::madd(m9, vz, B::madd(m5, vy, B::madd(m1, vx, t1))));
+        B::store(out_z + i, B::madd(m10, vz, B::madd(m6, vy, B::madd(m2, vx, t2))));
+    }
+    for (; i < n; ++i) {
+        float px = x[i], py = y[i], pz = z[i];
+        out_x[i] = a[0] * px + a[4] * py + a[8] * pz + a[12];
+        out_y[i] = a[1] * px + a[5] * py + a[9] * pz + a[13];
+        out_z[i] = a[2] * px + a[6] * py + a[10] * pz + a[14];
+    }
+}
+
+// out[i] = |(x[i], y[i], z[i]) - p|^2. Evaluated as dx*dx + dy*dy + dz*dz without fused
+// multiply-adds, so every backend gives the same result and bond cutoffs do not depend on it.
+template <class B = SimdNative>
+void squared_distances(const float* x, const float* y, const float* z, size_t n, const Vec3& p, float* out) {
+    typedef typename B::V V;
+    const V px = B::splat(p.x), py = B::splat(p.y), pz = B::splat(p.z);
+    size_t i = 0;
+    for (; i + B::WIDTH <= n; i += B::WIDTH) {
+        V dx = B::sub(B::load(x + i), px), dy = B::sub(B::load(y + i), py), dz = B::sub(B::load(z + i), pz);
+        B::store(out + i, B::add(B::add(B::mul(dx, dx), B::mul(dy, dy)), B::mul(dz, dz)));
+    }
+    for (; i < n; ++i) {
+        float dx = x[i] - p.x, dy = y[i] - p.y, dz = z[i] - p.z;
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+// Axis-aligned box around n spheres, or n points when radius is null. n must be at least 1.
+template <class B = SimdNative>
+void sphere_bounds(const float* x, const float* y, const float* z, const float* radius, size_t n,
+                   float* bounds_min, float* bounds_max) {
+    typedef typename B::V V;
+    const float r0 = radius ? radius[0] : 0.0f;
+    V lo_x = B::splat(x[0] - r0), lo_y = B::splat(y[0] - r0), lo_z = B::splat(z[0] - r0);
+    V hi_x = B::splat(x[0] + r0), hi_y = B::splat(y[0] + r0), hi_z = B::splat(z[0] + r0);
+    size_t i = 0;
+    for (; i + B::WIDTH <= n; i += B::WIDTH) {
+        V vx = B::load(x + i), vy = B::load(y + i), vz = B::load(z + i);
+        V r = radius ? B::load(radius + i) : B::splat(0.0f);
+        lo_x = B::min(lo_x, B::sub(vx, r)); hi_x = B::max(hi_x, B::add(vx, r));
+        lo_y = B::min(lo_y, B::sub(vy, r)); hi_y = B::max(hi_y, B::add(vy, r));
+        lo_z = B::min(lo_z, B::sub(vz, r)); hi_z = B::max(hi_z, B::add(vz, r));
+    }
+    bounds_min[0] = B::reduce_min(lo_x); bounds_min[1] = B::reduce_min(lo_y); bounds_min[2] = B::reduce_min(lo_z);
+    bounds_max[0] = B::reduce_max(hi_x); bounds_max[1] = B::reduce_max(hi_y); bounds_max[2] = B::reduce_max(hi_z);
+    for (; i < n; ++i) {
+        float r = radius ? radius[i] : 0.0f;
+        bounds_min[0] = std::min(bounds_min[0], x[i] - r); bounds_max[0] = std::max(bounds_max[0], x[i] + r);
+        bounds_min[1] = std::min(bounds_min[1], y[i] - r); bounds_max[1] = std::max(bounds_max[1], y[i] + r);
+        bounds_min[2] = std::min(bounds_min[2], z[i] - r); bounds_max[2] = std::max(bounds_max[2], z[i] + r);
+    }
+}
@@ -0,0 +1,166 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int FORSYTH_CACHE_SIZE = 32;
+const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+struct VertexState {
+    int cache_position = -1;           // -1 when not in the simulated cache
+    uint32_t remaining_triangles = 0;  // Not yet emitted triangles using this vertex
+    uint32_t first_triangle = 0;       // Offset into the vertex -> triangle adjacency list
+    float score = 0.0f;
+};
+
+float vertex_score(const VertexState& v) {
+    if (v.remaining_triangles == 0) return -1.0f; // Nothing left to gain from this vertex
+    float score = 0.0f;
+    if (v.cache_position >= 0) {
+        if (v.cache_position < 3) {
+            // The last triangle's vertices get a fixed score so strips do not just ping-pong
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        } else {
+            const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (v.cache_position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+    // Boost vertices with few triangles left so they are finished off and leave the cache
+    score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(v.remaining_triangles), -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+} // namespace
+
+void optimize_vertex_cache(std::vector<uint16_t>& indices, size_t vertex_count) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) return;
+
+    // Vertex -> triangle adjacency in one array (counting sort by vertex)
+    std::vector<VertexState> vertices(vertex_count);
+    for (uint16_t index : indices) vertices[index].remaining_triangles++;
+    uint32_t offset = 0;
+    for (VertexState& v : vertices) {
+        v.first_triangle = offset;
+        offset += v.remaining_triangles;
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(vertex_count, 0);
+    for (size_t t = 0; t < triangle_count; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            uint16_t v = indices[t * 3 + k];
+            adjacency[vertices[v].first_triangle + fill[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    for (VertexState& v : vertices) v.score = vertex_score(v);
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<uint8_t> emitted(triangle_count, 0);
+    for (size_t t = 0; t < triangle_count; ++t) {
+        triangle_score[t] = vertices[indices[t * 3]].score + vertices[indices[t * 3 + 1]].score + vertices[indices[t * 3 + 2]].score;
+    }
+
+    std::vector<uint16_t> output;
+    output.reserve(indices.size());
+    std::vector<int> cache; // Most recent first; may briefly hold FORSYTH_CACHE_SIZE + 3 entries
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    size_t scan_cursor = 0; // Triangles before it are all emitted
+
+    for (size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+        // The best candidate is adjacent to a cached vertex; fall back to a scan when the cache runs dry
+        long best = -1;
+        float best_score = -1.0f;
+        for (int v : cache) {
+            const VertexState& state = vertices[v];
+            for (uint32_t a = 0; a < state.remaining_triangles; ++a) {
+                uint32_t t = adjacency[state.first_triangle + a];
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+        if (best < 0) {
+            while (emitted[scan_cursor]) ++scan_cursor;
+            best = static_cast<long>(scan_cursor);
+            for (size_t t = scan_cursor; t < triangle_count; ++t) {
+                if (!emitted[t] && triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = static_cast<long>(t);
+                }
+            }
+        }
+
+        const uint16_t* triangle = &indices[best * 3];
+        emitted[best] = 1;
+        for (int k = 0; k < 3; ++k) {
+            output.push_back(triangle[k]);
+            // Drop the triangle from the vertex's remaining list (kept as the list's live prefix)
+            VertexState& state = vertices[triangle[k]];
+            uint32_t* list = &adjacency[state.first_triangle];
+            for (uint32_t a = 0; a < state.remaining_triangles; ++a) {
+                if (list[a] == static_cast<uint32_t>(best)) {
+                    std::swap(list[a], list[state.remaining_triangles - 1]);
+                    break;
+                }
+            }
+            state.remaining_triangles--;
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        for (int k = 2; k >= 0; --k) {
+            int v = triangle[k];
+            auto it = std::find(cache.begin(), cache.end(), v);
+            if (it != cache.end()) cache.erase(it);
+            cache.insert(cache.begin(), v);
+        }
+        for (size_t c = 0; c < cache.size(); ++c) {
+            vertices[cache[c]].cache_position = c < FORSYTH_CACHE_SIZE ? static_cast<int>(c) : -1;
+        }
+        // Rescore everything whose vertices moved, including those just pushed out of the cache
+        for (int v : cache) vertices[v].score = vertex_score(vertices[v]);
+        for (int v : cache) {
+            const VertexState& state = vertices[v];
+            for (uint32_t a = 0; a < state.remaining_triangles; ++a) {
+                uint32_t t = adjacency[state.first_triangle + a];
+                triangle_score[t] = vertices[indices[t * 3]].score + vertices[indices[t * 3 + 1]].score +
+                                    vertices[indices[t * 3 + 2]].score;
+            }
+        }
+        if (cache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE)) cache.resize(FORSYTH_CACHE_SIZE);
+    }
+    indices.swap(output);
+}
+
+std::vector<uint16_t> remap_vertices_by_first_use(std::vector<uint16_t>& indices, size_t vertex_count) {
+    const uint16_t unused = 0xffff;
+    std::vector<uint16_t> new_index_of(vertex_count, unused);
+    uint16_t next = 0;
+    for (uint16_t& index : indices) {
+        if (new_index_of[index] == unused) new_index_of[index] = next++;
+        index = new_index_of[index];
+    }
+    for (uint16_t& slot : new_index_of) { // Vertices no triangle references go last
+        if (slot == unused) slot = next++;
+    }
+    return new_index_of;
+}
+
+float average_cache_miss_ratio(const uint16_t* indices, size_t index_count, size_t vertex_count, int cache_size) {
+    if (index_count < 3) return 0.0f;
+    // FIFO: a hit does not refresh the entry. Time stamps stand in for the queue.
+    std::vector<long> inserted_at(vertex_count, -1);
+    long misses = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        long& stamp = inserted_at[indices[i]];
+        if (stamp < 0 || misses - stamp >= cache_size) {
+            stamp = misses;
+            ++misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(index_count / 3);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Post-transform vertex cache optimization for small static index buffers (the primitive meshes).
+
+// Reorders triangles with Tom Forsyth's linear-speed algorithm: greedily emits the triangle
+// whose vertices score highest, favoring vertices in a simulated 32-entry LRU cache and
+// vertices with few remaining triangles so they can be retired. Winding is preserved.
+void optimize_vertex_cache(std::vector<uint16_t>& indices, size_t vertex_count);
+
+// Renumbers vertices in order of first use by the index buffer, so vertex fetches walk memory
+// forward. Rewrites the indices and returns new_index_of[old_index] for reordering vertex data.
+std::vector<uint16_t> remap_vertices_by_first_use(std::vector<uint16_t>& indices, size_t vertex_count);
+
+// Average cache miss ratio: vertex shader invocations per triangle on a FIFO post-transform
+// cache of the given size. 3.0 means no reuse; a well-ordered closed mesh approaches 0.5-0.7.
+float average_cache_miss_ratio(const uint16_t* indices, size_t index_count, size_t vertex_count, int cache_size);
@@ -0,0 +1,525 @@
+#include "molecular_surface.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const int BRICK_SIZE = 16;                  // Cells per brick along each axis
+const size_t MAX_SURFACE_VOXELS = 1u << 24; // Two floats and a byte per voxel, about 150 MB
+const float DISTANCE_INFINITY = 1e20f;
+// Exterior voxels lie up to a voxel beyond the SAS, so distances to them overestimate the
+// distance to the SAS itself; this average correction (in voxels) was fitted against grids
+// seven times finer on single atoms, atom triples and dense clusters.
+const float SES_SEED_OFFSET = 0.25f;
+
+// Cube corners are numbered x | y << 1 | z << 2. Edge e runs along axis e / 4 from the corner
+// whose other two coordinates are the bits of e % 4.
+int edge_corner(int edge, int end) {
+    int axis = edge / 4;
+    int u = edge & 1, v = (edge >> 1) & 1;
+    int coord[3];
+    coord[axis] = end;
+    coord[(axis + 1) % 3] = u;
+    coord[(axis + 2) % 3] = v;
+    return coord[0] | (coord[1] << 1) | (coord[2] << 2);
+}
+
+int edge_between(int corner_a, int corner_b) {
+    for (int e = 0; e < 12; ++e) {
+        int c0 = edge_corner(e, 0), c1 = edge_corner(e, 1);
+        if ((c0 == corner_a && c1 == corner_b) || (c0 == corner_b && c1 == corner_a)) return e;
+    }
+    return -1;
+}
+
+// Marching cubes triangulation of each of the 256 inside/outside corner patterns, derived
+// instead of tabulated by hand. On every cube face the crossings are joined into segments that
+// keep the face's inside corners apart, walking the face counter-clockwise about its outward
+// normal from an outside-to-inside crossing to the next inside-to-outside one. Neighboring
+// cells see the same four corners on a shared face and pick the same segments in the opposite
+// direction, so the mesh is closed and consistently oriented. Segments chain into loops, which
+// are fanned into triangles facing away from the inside.
+struct CaseTable {
+    uint8_t triangle_count[256];
+    uint8_t edges[256][30]; // Three edges per triangle
+};
+
+CaseTable build_case_table() {
+    CaseTable table = {};
+    for (int config = 0; config < 256; ++config) {
+        auto inside = [config](int corner) { return (config >> corner) & 1; };
+        int next[12];
+        std::fill(next, next + 12, -1);
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int side = 0; side < 2; ++side) {
+                // (b, c, axis) is right-handed, so this order is counter-clockwise about +axis
+                const int square[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                int corners[4];
+                for (int k = 0; k < 4; ++k) {
+                    const int* bc = square[side == 1 ? k : 3 - k];
+                    int coord[3];
+                    coord[axis] = side;
+                    coord[(axis + 1) % 3] = bc[0];
+                    coord[(axis + 2) % 3] = bc[1];
+                    corners[k] = coord[0] | (coord[1] << 1) | (coord[2] << 2);
+                }
+                int crossing_edges[4], entering[4], crossings = 0;
+                for (int k = 0; k < 4; ++k) {
+                    int a = corners[k], b = corners[(k + 1) % 4];
+                    if (inside(a) == inside(b)) continue;
+                    crossing_edges[crossings] = edge_between(a, b);
+                    entering[crossings++] = inside(b);
+                }
+                for (int k = 0; k < crossings; ++k) {
+                    if (entering[k]) next[crossing_edges[k]] = crossing_edges[(k + 1) % crossings];
+                }
+            }
+        }
+        bool visited[12] = {};
+        int count = 0;
+        for (int start = 0; start < 12; ++start) {
+            if (next[start] < 0 || visited[start]) continue;
+            int loop[12], length = 0;
+            for (int e = start; !visited[e]; e = next[e]) {
+                visited[e] = true;
+                loop[length++] = e;
+            }
+            for (int k = 1; k + 1 < length; ++k) {
+                uint8_t* tri = &table.edges[config][count++ * 3];
+                tri[0] = static_cast<uint8_t>(loop[0]);
+                tri[1] = static_cast<uint8_t>(loop[k]);
+                tri[2] = static_cast<uint8_t>(loop[k + 1]);
+            }
+        }
+        table.triangle_count[config] = static_cast<uint8_t>(count);
+    }
+    return table;
+}
+
+const CaseTable& case_table() {
+    static const CaseTable table = build_case_table();
+    return table;
+}
+
+struct SurfaceGrid {
+    float origin[3];
+    float spacing;
+    int n[3];                 // Voxels (sample points) per axis
+    int bricks[3];            // Bricks per axis; brick b covers cells [b * BRICK_SIZE, (b + 1) * BRICK_SIZE)
+    std::vector<float> field;  // Positive inside the surface, zero at it
+    std::vector<uint8_t> element; // Atomic number of the atom nearest each voxel, for coloring
+
+    size_t voxel_count() const { return static_cast<size_t>(n[0]) * n[1] * n[2]; }
+    size_t brick_count() const { return static_cast<size_t>(bricks[0]) * bricks[1] * bricks[2]; }
+    size_t index(int i, int j, int k) const { return (static_cast<size_t>(k) * n[1] + j) * n[0] + i; }
+
+    void brick_coords(size_t brick, int* b) const {
+        b[0] = static_cast<int>(brick % bricks[0]);
+        b[1] = static_cast<int>((brick / bricks[0]) % bricks[1]);
+        b[2] = static_cast<int>(brick / (static_cast<size_t>(bricks[0]) * bricks[1]));
+    }
+    // Cell range of a brick. As a voxel range the last brick along an axis also takes the final
+    // voxel layer, so voxel ranges tile the grid too.
+    void brick_range(const int* b, int* lo, int* hi, bool voxels) const {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = b[a] * BRICK_SIZE;
+            hi[a] = std::min(lo[a] + BRICK_SIZE, n[a] - 1);
+            if (voxels && b[a] == bricks[a] - 1) hi[a] = n[a];
+        }
+    }
+    size_t brick_of_voxel(int i, int j, int k) const {
+        int b[3] = {std::min(i / BRICK_SIZE, bricks[0] - 1), std::min(j / BRICK_SIZE, bricks[1] - 1),
+                    std::min(k / BRICK_SIZE, bricks[2] - 1)};
+        return (static_cast<size_t>(b[2]) * bricks[1] + b[1]) * bricks[0] + b[0];
+    }
+};
+
+// Runs make_worker()(brick) for every brick, with one worker closure per thread. Bricks differ
+// widely in cost (empty space against dense surface), so threads pull them one at a time
+// instead of taking fixed ranges.
+template <typename MakeWorker>
+void for_each_brick(size_t brick_count, MakeWorker make_worker) {
+    std::atomic<size_t> next_brick(0);
+    parallel_for(worker_thread_count(), 1, [&](size_t, size_t) {
+        auto work = make_worker(); // Per-thread scratch lives in the returned closure
+        for (size_t brick; (brick = next_brick++) < brick_count;) work(brick);
+    });
+}
+
+// Splats min_i(|p - c_i| - R_i) with R_i = vdW + probe into every voxel within R_i + cutoff of
+// an atom; farther voxels keep +cutoff. Work is split into columns of bricks along x (the y and z
+// brick ranges, every x), so each atom's voxel rows are written in one piece; a column only
+// reads the atoms binned to it.
+void splat_sas_field(const AtomArrays& atoms, float probe, float cutoff, SurfaceGrid& grid) {
+    const float h = grid.spacing;
+    grid.field.assign(grid.voxel_count(), cutoff);
+    grid.element.assign(grid.voxel_count(), 0);
+
+    // Bin atoms to every column their influence box touches (counting sort)
+    auto voxel_range = [&](size_t atom, int axis, int& lo, int& hi) {
+        const float c = (axis == 0 ? atoms.x : axis == 1 ? atoms.y : atoms.z)[atom];
+        const float reach = atoms.properties(atom).vdw_radius + probe + cutoff;
+        lo = std::max(0, static_cast<int>(std::ceil((c - reach - grid.origin[axis]) / h)));
+        hi = std::min(grid.n[axis] - 1, static_cast<int>(std::floor((c + reach - grid.origin[axis]) / h)));
+    };
+    auto for_each_atom_column = [&](size_t atom, auto&& fn) {
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            voxel_range(atom, a, lo[a], hi[a]);
+            if (lo[a] > hi[a]) return;
+            lo[a] = std::min(lo[a] / BRICK_SIZE, grid.bricks[a] - 1);
+            hi[a] = std::min(hi[a] / BRICK_SIZE, grid.bricks[a] - 1);
+        }
+        for (int bz = lo[2]; bz <= hi[2]; ++bz)
+            for (int by = lo[1]; by <= hi[1]; ++by) fn(static_cast<size_t>(bz) * grid.bricks[1] + by);
+    };
+    const size_t column_count = static_cast<size_t>(grid.bricks[1]) * grid.bricks[2];
+    std::vector<uint32_t> column_start(column_count + 1, 0);
+    for (size_t i = 0; i < atoms.size(); ++i) for_each_atom_column(i, [&](size_t c) { ++column_start[c + 1]; });
+    for (size_t c = 0; c < column_count; ++c) column_start[c + 1] += column_start[c];
+    std::vector<uint32_t> column_atoms(column_start.back());
+    std::vector<uint32_t> fill(column_start.begin(), column_start.end() - 1);
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        for_each_atom_column(i, [&](size_t c) { column_atoms[fill[c]++] = static_cast<uint32_t>(i); });
+    }
+
+    for_each_brick(column_count, [&]() {
+        return [&](size_t column) {
+            int b[3] = {0, static_cast<int>(column % grid.bricks[1]), static_cast<int>(column / grid.bricks[1])};
+            int lo[3], hi[3];
+            grid.brick_range(b, lo, hi, true);
+            lo[0] = 0;
+            hi[0] = grid.n[0];
+            for (uint32_t k = column_start[column]; k < column_start[column + 1]; ++k) {
+                const uint32_t atom = column_atoms[k];
+                const float cx = atoms.x[atom], cy = atoms.y[atom], cz = atoms.z[atom];
+                const float radius = atoms.properties(atom).vdw_radius + probe;
+                const float reach = radius + cutoff;
+                const uint8_t element = atoms.atomic_number[atom];
+                int alo[3], ahi[3];
+                for (int a = 0; a < 3; ++a) {
+                    voxel_range(atom, a, alo[a], ahi[a]);
+                    alo[a] = std::max(alo[a], lo[a]);
+                    ahi[a] = std::min(ahi[a], hi[a] - 1);
+                }
+                for (int z = alo[2]; z <= ahi[2]; ++z) {
+                    const float dz = grid.origin[2] + z * h - cz;
+                    for (int y = alo[1]; y <= ahi[1]; ++y) {
+                        const float dy = grid.origin[1] + y * h - cy;
+                        const float rest = reach * reach - dy * dy - dz * dz;
+                        if (rest <= 0.0f) continue;
+                        // Only the voxels of this row inside the atom's reach
+                        const float half = std::sqrt(rest);
+                        const int x0 = std::max(alo[0], static_cast<int>(std::ceil((cx - half - grid.origin[0]) / h)));
+                        const int x1 = std::min(ahi[0], static_cast<int>(std::floor((cx + half - grid.origin[0]) / h)));
+                        const float dyz = dy * dy + dz * dz;
+                        size_t v = grid.index(x0, y, z);
+                        float dx = grid.origin[0] + x0 * h - cx;
+                        for (int x = x0; x <= x1; ++x, ++v, dx += h) {
+                            // sqrt(d2) - radius < field without the square root in the common no-change case
+                            const float limit = grid.field[v] + radius;
+                            const float d2 = dx * dx + dyz;
+                            if (limit <= 0.0f || d2 >= limit * limit) continue;
+                            grid.field[v] = std::sqrt(d2) - radius;
+                            grid.element[v] = element;
+                        }
+                    }
+                }
+            }
+        };
+    });
+}
+
+// Felzenszwalb-Huttenlocher lower envelope of parabolas: d[q] = min_p (q - p)^2 + f[p].
+// v and z are scratch of n and n + 1 entries.
+void distance_transform_1d(const float* f, int n, float* d, int* v, float* z) {
+    const float inf = std::numeric_limits<float>::infinity();
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    for (int q = 1; q < n; ++q) {
+        float s;
+        while (true) { // Pop parabolas hidden by the new one; z[0] = -inf stops at the first
+            const int p = v[k];
+            s = ((f[q] + static_cast<float>(q) * q) - (f[p] + static_cast<float>(p) * p)) / (2.0f * (q - p));
+            if (s > z[k]) break;
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) ++k;
+        const float offset = static_cast<float>(q - v[k]);
+        d[q] = offset * offset + f[v[k]];
+    }
+}
+
+// Exact squared Euclidean distance transform (in voxel units) of `distance`, which holds 0 at
+// seeds and DISTANCE_INFINITY elsewhere, as three separable passes. The y and z passes gather
+// lines in groups of consecutive x so each grid row is read once per group, not once per line.
+void distance_transform_3d(std::vector<float>& distance, const int* n) {
+    const int max_n = std::max(n[0], std::max(n[1], n[2]));
+    parallel_for(static_cast<size_t>(n[1]) * n[2], 64, [&](size_t begin, size_t end) {
+        std::vector<float> line(max_n), z(max_n + 1);
+        std::vector<int> v(max_n);
+        for (size_t row = begin; row < end; ++row) {
+            float* data = distance.data() + row * n[0];
+            std::copy(data, data + n[0], line.begin());
+            distance_transform_1d(line.data(), n[0], data, v.data(), z.data());
+        }
+    });
+    const int GROUP = 16;
+    const int x_groups = (n[0] + GROUP - 1) / GROUP;
+    for (int axis = 1; axis < 3; ++axis) {
+        const int other = axis == 1 ? n[2] : n[1];
+        const size_t stride = axis == 1 ? static_cast<size_t>(n[0]) : static_cast<size_t>(n[0]) * n[1];
+        parallel_for(static_cast<size_t>(x_groups) * other, 4, [&](size_t begin, size_t end) {
+            const int length = n[axis];
+            std::vector<float> block(static_cast<size_t>(length) * GROUP), line(length), out(length), z(length + 1);
+            std::vector<int> v(length);
+            for (size_t job = begin; job < end; ++job) {
+                const int x0 = static_cast<int>(job % x_groups) * GROUP;
+                const int width = std::min(GROUP, n[0] - x0);
+                const int o = static_cast<int>(job / x_groups);
+                const size_t base = axis == 1 ? static_cast<size_t>(o) * n[0] * n[1] + x0 : static_cast<size_t>(o) * n[0] + x0;
+                for (int q = 0; q < length; ++q) {
+                    std::copy_n(&distance[base + q * stride], width, &block[static_cast<size_t>(q) * GROUP]);
+                }
+                for (int x = 0; x < width; ++x) {
+                    for (int q = 0; q < length; ++q) line[q] = block[static_cast<size_t>(q) * GROUP + x];
+                    distance_transform_1d(line.data(), length, out.data(), v.data(), z.data());
+                    for (int q = 0; q < length; ++q) block[static_cast<size_t>(q) * GROUP + x] = out[q];
+                }
+                for (int q = 0; q < length; ++q) {
+                    std::copy_n(&block[static_cast<size_t>(q) * GROUP], width, &distance[base + q * stride]);
+                }
+            }
+        });
+    }
+}
+
+// Turns the SAS field into the SES field. Probe centers can sit anywhere outside the SAS, so a
+// point inside it is excluded when its distance d to the SAS exterior exceeds the probe radius:
+// the field becomes d - probe there, and -(probe + sas) outside the SAS. d is taken from the
+// distance transform of the exterior voxels, and never less than the depth -sas inside the
+// deepest single sphere, which is exact on the convex patches.
+void sas_to_ses_field(SurfaceGrid& grid, float probe) {
+    std::vector<float> distance(grid.voxel_count());
+    parallel_for(distance.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) distance[v] = grid.field[v] >= 0.0f ? 0.0f : DISTANCE_INFINITY;
+    });
+    distance_transform_3d(distance, grid.n);
+    const float h = grid.spacing;
+    parallel_for(distance.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const float sas = grid.field[v];
+            grid.field[v] = sas >= 0.0f ? -(probe + sas) : std::max(-sas, (std::sqrt(distance[v]) - SES_SEED_OFFSET) * h) - probe;
+        }
+    });
+}
+
+// Central-difference gradient of the field at a voxel, one-sided at the grid border
+void field_gradient(const SurfaceGrid& grid, int i, int j, int k, float* g) {
+    const int c[3] = {i, j, k};
+    for (int a = 0; a < 3; ++a) {
+        int lo[3] = {i, j, k}, hi[3] = {i, j, k};
+        lo[a] = std::max(c[a] - 1, 0);
+        hi[a] = std::min(c[a] + 1, grid.n[a] - 1);
+        g[a] = (grid.field[grid.index(hi[0], hi[1], hi[2])] - grid.field[grid.index(lo[0], lo[1], lo[2])]) /
+               static_cast<float>(std::max(hi[a] - lo[a], 1));
+    }
+}
+
+// Whether the field changes sign anywhere on the corners of the brick's cells. Most bricks lie
+// entirely inside or outside and are skipped after this one sequential read.
+bool brick_has_surface(const SurfaceGrid& grid, const int* lo, const int* hi) {
+    const bool inside = grid.field[grid.index(lo[0], lo[1], lo[2])] > 0.0f;
+    for (int k = lo[2]; k <= hi[2]; ++k) {
+        for (int j = lo[1]; j <= hi[1]; ++j) {
+            const float* row = &grid.field[grid.index(0, j, k)];
+            for (int i = lo[0]; i <= hi[0]; ++i) {
+                if ((row[i] > 0.0f) != inside) return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Vertices of one brick: one per sign-changing grid edge whose first voxel lies in the brick.
+// edge_ids are generated in increasing order, so other bricks can binary-search them.
+struct BrickVertices {
+    std::vector<SurfaceVertex> vertices;
+    std::vector<uint32_t> edge_ids; // voxel index * 3 + axis
+};
+
+void extract_brick_vertices(const SurfaceGrid& grid, size_t brick, BrickVertices& out) {
+    int b[3], lo[3], hi[3];
+    grid.brick_coords(brick, b);
+    grid.brick_range(b, lo, hi, false);
+    if (!brick_has_surface(grid, lo, hi)) return;
+    for (int k = lo[2]; k < hi[2]; ++k) {
+        for (int j = lo[1]; j < hi[1]; ++j) {
+            for (int i = lo[0]; i < hi[0]; ++i) {
+                const size_t v0 = grid.index(i, j, k);
+                const float f0 = grid.field[v0];
+                const int c0[3] = {i, j, k};
+                for (int axis = 0; axis < 3; ++axis) {
+                    int c1[3] = {i, j, k};
+                    ++c1[axis]; // Edges of brick cells never leave the grid
+                    const size_t v1 = grid.index(c1[0], c1[1], c1[2]);
+                    const float f1 = grid.field[v1];
+                    if ((f0 > 0.0f) == (f1 > 0.0f)) continue;
+                    const float t = f0 / (f0 - f1);
+                    float g0[3], g1[3];
+                    field_gradient(grid, c0[0], c0[1], c0[2], g0);
+                    field_gradient(grid, c1[0], c1[1], c1[2], g1);
+                    // The field grows inward, so the outward normal is its negated gradient
+                    float nx = -(g0[0] + t * (g1[0] - g0[0]));
+                    float ny = -(g0[1] + t * (g1[1] - g0[1]));
+                    float nz = -(g0[2] + t * (g1[2] - g0[2]));
+                    const float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+                    if (length > 0.0f) {
+                        nx /= length;
+                        ny /= length;
+                        nz /= length;
+                    }
+                    SurfaceVertex vertex;
+                    for (int a = 0; a < 3; ++a) {
+                        vertex.position[a] = grid.origin[a] + (c0[a] + (a == axis ? t : 0.0f)) * grid.spacing;
+                    }
+                    vertex.normal = pack_normal(nx, ny, nz);
+                    // Colored by the atom nearest the inside end of the edge
+                    const ElementProperties& element = element_properties(grid.element[f0 > 0.0f ? v0 : v1]);
+                    auto channel = [](float c) { return static_cast<uint32_t>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f); };
+                    vertex.color = channel(element.color.x) | (channel(element.color.y) << 8) |
+                                   (channel(element.color.z) << 16) | (255u << 24);
+                    out.vertices.push_back(vertex);
+                    out.edge_ids.push_back(static_cast<uint32_t>(v0 * 3 + axis));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool build_molecular_surface(const AtomArrays& atoms, const SurfaceParameters& params, SurfaceMesh& out) {
+    out.clear();
+    if (atoms.empty()) return false;
+    const float probe = std::max(params.probe_radius, 0.0f);
+    const bool excluded = params.type == SurfaceType::SolventExcluded && probe > 0.0f; // SES with probe 0 is the vdW surface
+
+    // Grid over the SAS with a margin of untouched voxels, so the border is always outside
+    float lo[3], hi[3];
+    sphere_bounds(atoms.x.data(), atoms.y.data(), atoms.z.data(), nullptr, atoms.size(), lo, hi);
+    float max_radius = 0.0f;
+    for (size_t i = 0; i < atoms.size(); ++i) max_radius = std::max(max_radius, atoms.properties(i).vdw_radius);
+    SurfaceGrid grid;
+    float h = std::max(params.grid_spacing, 0.05f);
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        const float margin = max_radius + probe + 3.0f * h; // Past the splat cutoff of 2h
+        size_t voxels = 1;
+        for (int a = 0; a < 3; ++a) {
+            grid.origin[a] = lo[a] - margin;
+            grid.n[a] = static_cast<int>(std::ceil((hi[a] - lo[a] + 2.0f * margin) / h)) + 1;
+            voxels *= static_cast<size_t>(grid.n[a]);
+        }
+        if (voxels <= MAX_SURFACE_VOXELS) break;
+        h *= std::cbrt(static_cast<float>(voxels) / MAX_SURFACE_VOXELS) * 1.01f;
+    }
+    grid.spacing = h;
+    for (int a = 0; a < 3; ++a) grid.bricks[a] = (grid.n[a] - 1 + BRICK_SIZE - 1) / BRICK_SIZE;
+    out.grid_spacing = h;
+    std::copy(grid.n, grid.n + 3, out.grid_dims);
+
+    // Field values change by at most h per voxel, so vertex edges and their gradient stencils only
+    // see values within 2h of the surface; beyond that only the sign matters
+    splat_sas_field(atoms, probe, 2.0f * h, grid);
+    if (excluded) {
+        sas_to_ses_field(grid, probe);
+    } else {
+        parallel_for(grid.field.size(), 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) grid.field[v] = -grid.field[v];
+        });
+    }
+
+    // Pass 1: vertices per brick, then global vertex offsets
+    const size_t brick_count = grid.brick_count();
+    std::vector<BrickVertices> brick_vertices(brick_count);
+    for_each_brick(brick_count, [&]() {
+        return [&](size_t brick) { extract_brick_vertices(grid, brick, brick_vertices[brick]); };
+    });
+    std::vector<size_t> vertex_offset(brick_count + 1, 0);
+    for (size_t b = 0; b < brick_count; ++b) vertex_offset[b + 1] = vertex_offset[b] + brick_vertices[b].vertices.size();
+    if (vertex_offset.back() > std::numeric_limits<uint32_t>::max()) return false;
+
+    // Pass 2: triangles per brick. Edges owned by this brick resolve through a dense table;
+    // edges on the far faces belong to a neighbor and are binary-searched in its edge list.
+    const CaseTable& table = case_table();
+    std::vector<std::vector<uint32_t>> brick_indices(brick_count);
+    for_each_brick(brick_count, [&]() {
+        std::vector<uint32_t> local(static_cast<size_t>(BRICK_SIZE) * BRICK_SIZE * BRICK_SIZE * 3);
+        return [&, local](size_t brick) mutable {
+            int b[3], lo[3], hi[3];
+            grid.brick_coords(brick, b);
+            grid.brick_range(b, lo, hi, false);
+            if (!brick_has_surface(grid, lo, hi)) return;
+            const BrickVertices& own = brick_vertices[brick];
+            auto local_slot = [&](int i, int j, int k, int axis) {
+                return ((static_cast<size_t>(k - lo[2]) * BRICK_SIZE + (j - lo[1])) * BRICK_SIZE + (i - lo[0])) * 3 + axis;
+            };
+            for (size_t v = 0; v < own.edge_ids.size(); ++v) {
+                const uint32_t voxel = own.edge_ids[v] / 3;
+                const int i = static_cast<int>(voxel % grid.n[0]);
+                const int j = static_cast<int>((voxel / grid.n[0]) % grid.n[1]);
+                const int k = static_cast<int>(voxel / (static_cast<size_t>(grid.n[0]) * grid.n[1]));
+                local[local_slot(i, j, k, own.edge_ids[v] % 3)] = static_cast<uint32_t>(vertex_offset[brick] + v);
+            }
+            auto vertex_index = [&](int i, int j, int k, int axis) -> uint32_t {
+                if (i < hi[0] && j < hi[1] && k < hi[2]) return local[local_slot(i, j, k, axis)];
+                const size_t owner = grid.brick_of_voxel(i, j, k);
+                const std::vector<uint32_t>& ids = brick_vertices[owner].edge_ids;
+                const uint32_t id = static_cast<uint32_t>(grid.index(i, j, k) * 3 + axis);
+                auto it = std::lower_bound(ids.begin(), ids.end(), id);
+                return static_cast<uint32_t>(vertex_offset[owner] + (it - ids.begin()));
+            };
+            std::vector<uint32_t>& indices = brick_indices[brick];
+            for (int k = lo[2]; k < hi[2]; ++k) {
+                for (int j = lo[1]; j < hi[1]; ++j) {
+                    for (int i = lo[0]; i < hi[0]; ++i) {
+                        int config = 0;
+                        for (int c = 0; c < 8; ++c) {
+                            if (grid.field[grid.index(i + (c & 1), j + ((c >> 1) & 1), k + (c >> 2))] > 0.0f) config |= 1 << c;
+                        }
+                        const int count = table.triangle_count[config];
+                        for (int t = 0; t < count * 3; ++t) {
+                            const int edge = table.edges[config][t];
+                            const int corner = edge_corner(edge, 0);
+                            indices.push_back(vertex_index(i + (corner & 1), j + ((corner >> 1) & 1), k + (corner >> 2), edge / 4));
+                        }
+                    }
+                }
+            }
+        };
+    });
+
+    out.vertices.resize(vertex_offset.back());
+    std::vector<size_t> index_offset(brick_count + 1, 0);
+    for (size_t b = 0; b < brick_count; ++b) index_offset[b + 1] = index_offset[b] + brick_indices[b].size();
+    out.indices.resize(index_offset.back());
+    parallel_for(brick_count, 16, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; ++b) {
+            std::copy(brick_vertices[b].vertices.begin(), brick_vertices[b].vertices.end(), out.vertices.begin() + vertex_offset[b]);
+            std::copy(brick_indices[b].begin(), brick_indices[b].end(), out.indices.begin() + index_offset[b]);
+        }
+    });
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "molecule.h"
+
+// Which molecular surface to extract. Both use the element van der Waals radii.
+//  - SolventExcluded (SES, Connolly): the boundary of the space a probe sphere cannot reach,
+//    i.e. the vdW surface with the crevices between atoms filled to the probe's curvature.
+//  - SolventAccessible (SAS): the surface traced by the probe's center, the union of spheres
+//    of radius vdW + probe. A probe radius of 0 gives the plain vdW surface.
+enum class SurfaceType { SolventExcluded, SolventAccessible };
+
+struct SurfaceParameters {
+    SurfaceType type = SurfaceType::SolventExcluded;
+    float probe_radius = 1.4f; // Water
+    float grid_spacing = 0.5f; // Angstrom; coarsened automatically for very large systems
+};
+
+// Surface vertex: float position, normal packed as GL_INT_2_10_10_10_REV and the color of the
+// nearest atom's element as RGBA8, 20 bytes in total
+struct SurfaceVertex {
+    float position[3];
+    uint32_t normal;
+    uint32_t color;
+};
+
+// Indexed triangle mesh, counter-clockwise seen from outside. Every vertex lies on a grid edge
+// and is shared by all triangles using that edge, so the mesh is closed and has no duplicates.
+struct SurfaceMesh {
+    std::vector<SurfaceVertex> vertices;
+    std::vector<uint32_t> indices; // Drawn as GL_UNSIGNED_INT
+    float grid_spacing = 0.0f;     // Spacing actually used
+    int grid_dims[3] = {0, 0, 0};
+
+    void clear() { vertices.clear(); indices.clear(); }
+};
+
+// Builds the surface of all atoms on a regular grid and extracts it with marching cubes.
+//
+// The SAS distance field min_i(|p - c_i| - (r_i + probe)) is splatted per grid brick from the
+// atoms overlapping that brick. For the SES an exact Euclidean distance transform then gives,
+// inside the SAS, the distance to the nearest point a probe center can reach; the SES is where
+// that distance equals the probe radius. Field splatting, the distance transform and the mesh
+// extraction all run over bricks or grid lines with parallel_for.
+// Returns false (with an empty mesh) when there are no atoms.
+bool build_molecular_surface(const AtomArrays& atoms, const SurfaceParameters& params, SurfaceMesh& out);
@@ -1,33 +1,107 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <map>
+#include <array>
+#include <cstdint>
 #include "math.h"
+#include "elements.h"
 
-struct Atom {
-    float x, y, z;
-    std::string element;
-    float covalent_radius; // Was 'radius'
-    float vdw_radius;      // Van der Waals radius
-    Vec3 color;
+// Structure-of-arrays atom storage: three contiguous coordinate arrays and one atomic number
+// byte per atom (13 bytes). Radii and colors are per-element and come from element_properties().
+struct AtomArrays {
+    std::vector<float> x, y, z;
+    std::vector<uint8_t> atomic_number; // 0 = unknown element
+
+    size_t size() const { return atomic_number.size(); }
+    bool empty() const { return atomic_number.empty(); }
+    void reserve(size_t n) { x.reserve(n); y.reserve(n); z.reserve(n); atomic_number.reserve(n); }
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); atomic_number.resize(n); }
+    void clear() { x.clear(); y.clear(); z.clear(); atomic_number.clear(); }
+    void push_back(float px, float py, float pz, int element) {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        atomic_number.push_back(static_cast<uint8_t>(element));
+    }
+
+    Vec3 position(size_t i) const { return Vec3(x[i], y[i], z[i]); }
+    const char* element(size_t i) const { return element_symbol(atomic_number[i]); }
+    const ElementProperties& properties(size_t i) const { return element_properties(atomic_number[i]); }
+
+    // Heap bytes held by the arrays (capacity, not size)
+    size_t memory_bytes() const {
+        return (x.capacity() + y.capacity() + z.capacity()) * sizeof(float) + atomic_number.capacity();
+    }
 };
 
 struct Bond {
     size_t atom1_idx;
     size_t atom2_idx;
     int order = 1; // Default to single bond
+    // Lattice translation (in cell vectors) of the atom2 image that atom1 bonds to; nonzero
+    // only for bonds across the faces of a periodic cell
+    int8_t image[3] = {0, 0, 0};
+    bool crosses_cell() const { return image[0] != 0 || image[1] != 0 || image[2] != 0; }
+};
+
+// Periodic cell of a crystal or simulation box (extended XYZ Lattice="..." / pbc="...").
+// Orthorhombic and triclinic cells alike are given by three lattice vectors.
+struct UnitCell {
+    Vec3 a, b, c;
+    bool pbc[3] = {false, false, false}; // Periodic along a, b, c
+
+    bool periodic() const { return pbc[0] || pbc[1] || pbc[2]; }
+    const Vec3& vector(int axis) const { return axis == 0 ? a : (axis == 1 ? b : c); }
+    Vec3 translation(int na, int nb, int nc) const { return a * static_cast<float>(na) + b * static_cast<float>(nb) + c * static_cast<float>(nc); }
+    Vec3 translation(const int8_t image[3]) const { return translation(image[0], image[1], image[2]); }
+    bool operator==(const UnitCell& o) const {
+        for (int k = 0; k < 3; ++k) {
+            const Vec3 &u = vector(k), &v = o.vector(k);
+            if (u.x != v.x || u.y != v.y || u.z != v.z || pbc[k] != o.pbc[k]) return false;
+        }
+        return true;
+    }
+    bool operator!=(const UnitCell& o) const { return !(*this == o); }
+    void clear() { *this = UnitCell(); }
+};
+
+// Residue record for macromolecular formats (PDB/mmCIF). Each residue is a contiguous atom range.
+struct Residue {
+    char name[4];        // Residue name, NUL-padded (e.g. "ALA")
+    char chain_id[4];    // Author chain id, NUL-padded
+    int seq_num;
+    char insertion_code; // ' ' when absent
+    bool hetero;         // From HETATM records
+    uint32_t first_atom;
+    uint32_t atom_count;
+};
+
+// Compact side table of per-residue and per-atom metadata; empty for formats without it (XYZ)
+struct StructureInfo {
+    std::vector<Residue> residues;
+    std::vector<std::array<char, 4>> atom_names; // Per atom, NUL-padded (e.g. "CA", "O5'")
+    std::vector<float> b_factors;                // Per atom
+    void clear() {
+        residues.clear();
+        atom_names.clear();
+        b_factors.clear();
+    }
 };
 
 struct Molecule {
-    std::vector<Atom> atoms;
+    AtomArrays atoms;
     std::vector<Bond> bonds;
     std::string name;    // For molecule name/comment
     std::string formula; // For calculated molecular formula
+    StructureInfo structure;
+    UnitCell cell;       // Not periodic unless the file declares a lattice
     void clear() {
         atoms.clear();
         bonds.clear();
         name.clear();
         formula.clear();
+        structure.clear();
+        cell.clear();
     }
     // Could add global VAO/VBO for the whole molecule later
 };
@@ -35,12 +109,10 @@ struct Molecule {
 enum class Representation {
     BallAndStick,
     SpaceFill,
-    Licorice
+    Licorice,
+    Surface // Molecular surface mesh instead of atoms and bonds
 };
 
-// Helper to get some default atom properties
-void get_atom_properties(const std::string& element, float& cov_radius, float& vdw_r, Vec3& color);
-
 // Create a sample water molecule
 Molecule create_sample_molecule();
 
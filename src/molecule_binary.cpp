@@ -0,0 +1,131 @@
+#include "molecule_binary.h"
+#include <iostream>
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The MOLB format is written and read in host byte order, which must be little-endian"
+#endif
+
+static size_t pad4(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
+
+static void append_bytes(std::vector<uint8_t>& out, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+    out.resize(pad4(out.size()), 0);
+}
+
+std::vector<uint8_t> encode_molecule_binary(const Molecule& mol) {
+    const size_t atom_count = mol.atoms.size();
+    const size_t bond_count = mol.bonds.size();
+
+    MolbHeader header = {};
+    std::memcpy(header.magic, "MOLB", 4);
+    header.version = MOLB_VERSION;
+    header.header_size = sizeof(MolbHeader);
+    header.atom_count = static_cast<uint32_t>(atom_count);
+    header.bond_count = static_cast<uint32_t>(bond_count);
+    header.name_length = static_cast<uint32_t>(mol.name.size());
+    const bool periodic = mol.cell.periodic();
+    header.flags = periodic ? MOLB_FLAG_PERIODIC : 0;
+
+    std::vector<uint32_t> bond_atoms(bond_count * 2);
+    std::vector<uint8_t> bond_orders(bond_count);
+    for (size_t i = 0; i < bond_count; ++i) {
+        bond_atoms[2 * i] = static_cast<uint32_t>(mol.bonds[i].atom1_idx);
+        bond_atoms[2 * i + 1] = static_cast<uint32_t>(mol.bonds[i].atom2_idx);
+        bond_orders[i] = static_cast<uint8_t>(mol.bonds[i].order);
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(sizeof(MolbHeader) + pad4(mol.name.size()) + atom_count * 3 * sizeof(float) + pad4(atom_count) +
+                bond_atoms.size() * sizeof(uint32_t) + pad4(bond_count));
+    append_bytes(out, &header, sizeof(header));
+    append_bytes(out, mol.name.data(), mol.name.size());
+    // The sections mirror AtomArrays, so each one is a single block copy
+    append_bytes(out, mol.atoms.x.data(), atom_count * sizeof(float));
+    append_bytes(out, mol.atoms.y.data(), atom_count * sizeof(float));
+    append_bytes(out, mol.atoms.z.data(), atom_count * sizeof(float));
+    append_bytes(out, mol.atoms.atomic_number.data(), atom_count);
+    append_bytes(out, bond_atoms.data(), bond_atoms.size() * sizeof(uint32_t));
+    append_bytes(out, bond_orders.data(), bond_orders.size());
+    if (periodic) {
+        const UnitCell& cell = mol.cell;
+        const float lattice[9] = {cell.a.x, cell.a.y, cell.a.z, cell.b.x, cell.b.y, cell.b.z, cell.c.x, cell.c.y, cell.c.z};
+        const uint8_t pbc[3] = {cell.pbc[0], cell.pbc[1], cell.pbc[2]};
+        std::vector<int8_t> bond_images(bond_count * 3);
+        for (size_t i = 0; i < bond_count; ++i) std::memcpy(&bond_images[3 * i], mol.bonds[i].image, 3);
+        append_bytes(out, lattice, sizeof(lattice));
+        append_bytes(out, pbc, sizeof(pbc));
+        append_bytes(out, bond_images.data(), bond_images.size());
+    }
+    return out;
+}
+
+bool decode_molecule_binary(const uint8_t* data, size_t length, Molecule& out) {
+    MolbHeader header;
+    if (length < sizeof(MolbHeader)) {
+        std::cerr << "MOLB Error: Buffer of " << length << " bytes is too small for a header." << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, "MOLB", 4) != 0) {
+        std::cerr << "MOLB Error: Bad magic; not a binary molecule file." << std::endl;
+        return false;
+    }
+    if (header.version < 1 || header.version > MOLB_VERSION || header.header_size < sizeof(MolbHeader)) {
+        std::cerr << "MOLB Error: Unsupported version " << header.version << "." << std::endl;
+        return false;
+    }
+
+    const uint64_t atom_count = header.atom_count;
+    const uint64_t bond_count = header.bond_count;
+    const uint64_t name_offset = pad4(header.header_size);
+    const uint64_t coords_offset = name_offset + pad4(header.name_length);
+    const uint64_t numbers_offset = coords_offset + atom_count * 3 * sizeof(float);
+    const uint64_t bond_atoms_offset = numbers_offset + pad4(atom_count);
+    const uint64_t bond_orders_offset = bond_atoms_offset + bond_count * 2 * sizeof(uint32_t);
+    const bool periodic = header.version >= 2 && (header.flags & MOLB_FLAG_PERIODIC) != 0;
+    const uint64_t cell_offset = bond_orders_offset + pad4(bond_count);
+    const uint64_t pbc_offset = cell_offset + 9 * sizeof(float);
+    const uint64_t bond_images_offset = pbc_offset + pad4(3);
+    const uint64_t total = periodic ? bond_images_offset + bond_count * 3 : bond_orders_offset + bond_count;
+    if (total > length) {
+        std::cerr << "MOLB Error: Truncated buffer (" << length << " bytes, expected " << total << ")." << std::endl;
+        return false;
+    }
+
+    out.name.assign(reinterpret_cast<const char*>(data + name_offset), header.name_length);
+    const float* coords = reinterpret_cast<const float*>(data + coords_offset);
+    const uint8_t* atomic_numbers = data + numbers_offset;
+    out.atoms.x.assign(coords, coords + atom_count);
+    out.atoms.y.assign(coords + atom_count, coords + 2 * atom_count);
+    out.atoms.z.assign(coords + 2 * atom_count, coords + 3 * atom_count);
+    out.atoms.atomic_number.assign(atomic_numbers, atomic_numbers + atom_count);
+
+    const uint32_t* bond_atoms = reinterpret_cast<const uint32_t*>(data + bond_atoms_offset);
+    const uint8_t* bond_orders = data + bond_orders_offset;
+    out.bonds.resize(bond_count);
+    for (size_t i = 0; i < bond_count; ++i) {
+        Bond& bond = out.bonds[i];
+        bond.atom1_idx = bond_atoms[2 * i];
+        bond.atom2_idx = bond_atoms[2 * i + 1];
+        bond.order = bond_orders[i];
+        if (bond.atom1_idx >= atom_count || bond.atom2_idx >= atom_count) {
+            std::cerr << "MOLB Error: Bond " << i << " references atom out of range." << std::endl;
+            out.clear();
+            return false;
+        }
+    }
+    out.cell.clear();
+    if (periodic) {
+        float lattice[9];
+        std::memcpy(lattice, data + cell_offset, sizeof(lattice));
+        out.cell.a = Vec3(lattice[0], lattice[1], lattice[2]);
+        out.cell.b = Vec3(lattice[3], lattice[4], lattice[5]);
+        out.cell.c = Vec3(lattice[6], lattice[7], lattice[8]);
+        for (int k = 0; k < 3; ++k) out.cell.pbc[k] = data[pbc_offset + k] != 0;
+        const int8_t* bond_images = reinterpret_cast<const int8_t*>(data + bond_images_offset);
+        for (size_t i = 0; i < bond_count; ++i) std::memcpy(out.bonds[i].image, &bond_images[3 * i], 3);
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "molecule.h"
+
+// Compact binary molecule format ("MOLB"), little-endian, every section 4-byte aligned:
+//
+//   MolbHeader                     32 bytes
+//   name                           name_length bytes of UTF-8, zero-padded to 4
+//   x[atom_count], y[..], z[..]    float32 coordinates, one array per axis
+//   atomic_number[atom_count]      uint8 (0 = unknown), zero-padded to 4
+//   bond_atoms[2 * bond_count]     uint32 atom index pairs
+//   bond_order[bond_count]         uint8, zero-padded to 4
+//
+// With MOLB_FLAG_PERIODIC set in flags (version 2), the periodic cell follows:
+//
+//   cell[9]                        float32 lattice vectors a, b, c
+//   pbc[3]                         uint8 periodic along a, b, c, zero-padded to 4
+//   bond_image[3 * bond_count]     int8 lattice translation of each bond's atom2, zero-padded to 4
+//
+// Bonds are stored precomputed, so loading never runs bond perception. Version 1 files (no
+// flags, never periodic) are still read.
+const uint16_t MOLB_VERSION = 2;
+const uint32_t MOLB_FLAG_PERIODIC = 1;
+
+struct MolbHeader {
+    char magic[4];        // "MOLB"
+    uint16_t version;     // MOLB_VERSION
+    uint16_t header_size; // sizeof(MolbHeader); readers skip any fields a later version appends
+    uint32_t atom_count;
+    uint32_t bond_count;
+    uint32_t name_length;
+    uint32_t flags;       // MOLB_FLAG_*; zero in version 1
+    uint32_t reserved[2];
+};
+static_assert(sizeof(MolbHeader) == 32, "MolbHeader must stay 32 bytes");
+
+// Serializes atoms, bonds, name and (for periodic molecules) the unit cell and bond images
+std::vector<uint8_t> encode_molecule_binary(const Molecule& mol);
+
+// Decodes a buffer produced by encode_molecule_binary, reading it in place (no staging copy);
+// data must be 4-byte aligned, as malloc'd buffers are. Returns false on a bad magic, unsupported version or truncated buffer.
+bool decode_molecule_binary(const uint8_t* data, size_t length, Molecule& out);
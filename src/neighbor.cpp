@@ -0,0 +1,599 @@
+#include "neighbor.h"
+#include "math.h"
+#include "parallel.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+void CellGrid::build(const AtomArrays& atoms, float min_cell_size) {
+    cell_start.clear();
+    cell_atoms.clear();
+    if (atoms.empty()) return;
+
+    float lo[3], hi[3];
+    sphere_bounds(atoms.x.data(), atoms.y.data(), atoms.z.data(), nullptr, atoms.size(), lo, hi);
+    float min_x = lo[0], max_x = hi[0];
+    float min_y = lo[1], max_y = hi[1];
+    float min_z = lo[2], max_z = hi[2];
+    origin_x = min_x; origin_y = min_y; origin_z = min_z;
+    cell_size = std::max(min_cell_size, 1e-3f);
+
+    // Keep the grid no larger than ~2 cells per atom; sparse systems just get coarser cells
+    double extent_x = max_x - min_x, extent_y = max_y - min_y, extent_z = max_z - min_z;
+    double max_cells = 2.0 * atoms.size() + 27.0;
+    double cells = (std::floor(extent_x / cell_size) + 1) * (std::floor(extent_y / cell_size) + 1) * (std::floor(extent_z / cell_size) + 1);
+    if (cells > max_cells) {
+        cell_size *= static_cast<float>(std::cbrt(cells / max_cells)) * 1.01f;
+    }
+    dim_x = static_cast<int>(extent_x / cell_size) + 1;
+    dim_y = static_cast<int>(extent_y / cell_size) + 1;
+    dim_z = static_cast<int>(extent_z / cell_size) + 1;
+
+    // Counting sort of atoms into cells (stable, so indices stay ascending per cell)
+    size_t cell_count = static_cast<size_t>(dim_x) * dim_y * dim_z;
+    cell_start.assign(cell_count + 1, 0);
+    std::vector<uint32_t> atom_cell(atoms.size());
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        int cell = cell_index(cell_coord(atoms.x[i], origin_x, dim_x), cell_coord(atoms.y[i], origin_y, dim_y), cell_coord(atoms.z[i], origin_z, dim_z));
+        atom_cell[i] = static_cast<uint32_t>(cell);
+        cell_start[cell + 1]++;
+    }
+    for (size_t c = 0; c < cell_count; ++c) cell_start[c + 1] += cell_start[c];
+    cell_atoms.resize(atoms.size());
+    cell_x.resize(atoms.size());
+    cell_y.resize(atoms.size());
+    cell_z.resize(atoms.size());
+    std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        uint32_t k = fill[atom_cell[i]]++;
+        cell_atoms[k] = static_cast<uint32_t>(i);
+        cell_x[k] = atoms.x[i];
+        cell_y[k] = atoms.y[i];
+        cell_z[k] = atoms.z[i];
+    }
+}
+
+// Covalent radius per atomic number, so inner loops read a small local table. Returns the
+// largest radius among the atoms.
+static float fill_radius_table(const AtomArrays& atoms, float (&radius_by_element)[ELEMENT_COUNT + 1]) {
+    for (int z = 0; z <= ELEMENT_COUNT; ++z) radius_by_element[z] = element_properties(z).covalent_radius;
+    float max_cov_radius = 0.0f;
+    for (uint8_t z : atoms.atomic_number) max_cov_radius = std::max(max_cov_radius, radius_by_element[z]);
+    return max_cov_radius;
+}
+
+// Pairs (i, j, image) with j an image of a later atom, or a translated image of i itself,
+// within the pair's bond cutoff plus extra, grouped by i in index order and sorted by
+// (j, image) within each group
+struct PeriodicPairs {
+    std::vector<uint32_t> start;     // atom_count + 1 offsets
+    std::vector<uint32_t> partner;
+    std::vector<int8_t> image;       // 3 per pair: lattice translation of the partner
+    std::vector<float> cutoff_sq;    // Squared bond cutoff of the pair
+    int dims[3] = {0, 0, 0};         // Cell list size along a, b, c
+};
+
+// Cell vectors for fractional coordinates: the lattice vectors along periodic axes, completed
+// by unit normals where a non-periodic axis is degenerate (slabs and wires often give zero
+// vectors there). Returns false if the periodic vectors themselves are degenerate.
+static bool periodic_basis(const UnitCell& cell, Vec3 (&basis)[3]) {
+    int periodic_axes[3], periodic_count = 0;
+    for (int k = 0; k < 3; ++k) {
+        basis[k] = cell.vector(k);
+        if (cell.pbc[k]) periodic_axes[periodic_count++] = k;
+    }
+    auto volume = [&] { return Vec3::dot(basis[0], Vec3::cross(basis[1], basis[2])); };
+    if (std::fabs(volume()) > 1e-6f) return true;
+    if (periodic_count == 3) return false;
+    if (periodic_count == 2) {
+        Vec3 normal = Vec3::cross(basis[periodic_axes[0]], basis[periodic_axes[1]]).normalize();
+        if (normal.length() == 0.0f) return false;
+        basis[3 - periodic_axes[0] - periodic_axes[1]] = normal;
+    } else {
+        const Vec3 axis = basis[periodic_axes[0]];
+        const Vec3 helper = std::fabs(axis.x) <= std::fabs(axis.y) && std::fabs(axis.x) <= std::fabs(axis.z) ? Vec3(1, 0, 0)
+                          : (std::fabs(axis.y) <= std::fabs(axis.z) ? Vec3(0, 1, 0) : Vec3(0, 0, 1));
+        const Vec3 u = Vec3::cross(axis, helper).normalize();
+        const Vec3 w = Vec3::cross(axis, u).normalize();
+        bool first = true;
+        for (int k = 0; k < 3; ++k) {
+            if (cell.pbc[k]) continue;
+            basis[k] = first ? u : w;
+            first = false;
+        }
+    }
+    return std::fabs(volume()) > 1e-6f;
+}
+
+// Cell list in fractional coordinates, which handles orthorhombic and triclinic cells alike.
+// Periodic axes are wrapped into [0, 1) and cut into slabs at least `reach` thick (measured
+// perpendicular to the slab), so every neighbor of an atom lies in the adjacent slabs, across
+// the cell boundary with a lattice shift when needed; cells thinner than the reach are searched
+// over as many images as it takes. Non-periodic axes are bucketed over the atoms' extent.
+// Images are reported relative to the input (unwrapped) coordinates.
+static bool find_periodic_pairs(const Molecule& mol, float extra, bool skip_overlaps, PeriodicPairs& out) {
+    const AtomArrays& atoms = mol.atoms;
+    const UnitCell& cell = mol.cell;
+    const size_t n = atoms.size();
+    out = PeriodicPairs();
+    out.start.assign(n + 1, 0);
+    Vec3 basis[3];
+    if (!periodic_basis(cell, basis)) {
+        std::cerr << "C++: Degenerate periodic cell; no bonds generated." << std::endl;
+        return false;
+    }
+    float radius_by_element[ELEMENT_COUNT + 1];
+    const float reach = 2.0f * fill_radius_table(atoms, radius_by_element) * BOND_DISTANCE_TOLERANCE_FACTOR + extra;
+
+    // Rows of the inverse basis give fractional coordinates; 1 / |row k| is the cell's width
+    // perpendicular to the other two vectors
+    const float inv_volume = 1.0f / Vec3::dot(basis[0], Vec3::cross(basis[1], basis[2]));
+    const Vec3 inverse[3] = {Vec3::cross(basis[1], basis[2]) * inv_volume, Vec3::cross(basis[2], basis[0]) * inv_volume,
+                             Vec3::cross(basis[0], basis[1]) * inv_volume};
+    std::vector<float> frac[3];
+    std::vector<int> wrap[3]; // Whole cells subtracted to wrap an atom into [0, 1)
+    std::vector<float> px(n), py(n), pz(n); // Wrapped Cartesian positions
+    float lo[3], span[3];
+    int dim[3], reach_cells[3];
+    for (int k = 0; k < 3; ++k) {
+        frac[k].resize(n);
+        wrap[k].assign(n, 0);
+        float min_f = 0.0f, max_f = 1.0f;
+        if (!cell.pbc[k]) { min_f = 1e30f; max_f = -1e30f; }
+        for (size_t i = 0; i < n; ++i) {
+            float f = Vec3::dot(inverse[k], atoms.position(i));
+            if (cell.pbc[k]) {
+                float whole = std::floor(f);
+                f -= whole;
+                if (f >= 1.0f) { f = 0.0f; whole += 1.0f; } // Rounding of tiny negative values
+                wrap[k][i] = static_cast<int>(whole);
+            } else {
+                min_f = std::min(min_f, f);
+                max_f = std::max(max_f, f);
+            }
+            frac[k][i] = f;
+        }
+        lo[k] = min_f;
+        span[k] = std::max(max_f - min_f, 1e-6f);
+        const float width = span[k] / inverse[k].length();
+        dim[k] = std::max(1, static_cast<int>(width / reach));
+    }
+    // Keep the grid no larger than ~2 cells per atom, as CellGrid does
+    const double max_cells = 2.0 * n + 27.0;
+    const double cells = static_cast<double>(dim[0]) * dim[1] * dim[2];
+    if (cells > max_cells) {
+        const double shrink = std::cbrt(cells / max_cells) * 1.01;
+        for (int& d : dim) d = std::max(1, static_cast<int>(d / shrink));
+    }
+    for (int k = 0; k < 3; ++k) {
+        // A slab of a cell split in two or more is at least the reach thick; a single slab may be
+        // thinner, and then more than the nearest images are within reach
+        const float width = 1.0f / inverse[k].length();
+        reach_cells[k] = (cell.pbc[k] && dim[k] == 1) ? std::max(1, static_cast<int>(std::ceil(reach / width))) : 1;
+        out.dims[k] = dim[k];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Vec3 p = atoms.position(i) - cell.translation(wrap[0][i], wrap[1][i], wrap[2][i]);
+        px[i] = p.x; py[i] = p.y; pz[i] = p.z;
+    }
+
+    // Counting sort into cells, ascending atom index within each cell
+    const size_t cell_count = static_cast<size_t>(dim[0]) * dim[1] * dim[2];
+    auto cell_of = [&](int k, size_t i) {
+        int c = static_cast<int>((frac[k][i] - lo[k]) / span[k] * dim[k]);
+        return c < 0 ? 0 : (c >= dim[k] ? dim[k] - 1 : c);
+    };
+    std::vector<uint32_t> cell_start(cell_count + 1, 0), cell_atoms(n);
+    std::vector<int> home_cell(3 * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) home_cell[3 * i + k] = cell_of(k, i);
+        cell_start[(home_cell[3 * i + 2] * dim[1] + home_cell[3 * i + 1]) * dim[0] + home_cell[3 * i] + 1]++;
+    }
+    for (size_t c = 0; c < cell_count; ++c) cell_start[c + 1] += cell_start[c];
+    // Positions and radii are copied in cell order beside cell_atoms, as in CellGrid
+    std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+    std::vector<float> cell_x(n), cell_y(n), cell_z(n), cell_radius(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t slot = fill[(home_cell[3 * i + 2] * dim[1] + home_cell[3 * i + 1]) * dim[0] + home_cell[3 * i]]++;
+        cell_atoms[slot] = static_cast<uint32_t>(i);
+        cell_x[slot] = px[i];
+        cell_y[slot] = py[i];
+        cell_z[slot] = pz[i];
+        cell_radius[slot] = radius_by_element[atoms.atomic_number[i]];
+    }
+
+    // Tasks over atom ranges, each into a buffer of its own; concatenated in range order below
+    struct Found {
+        uint32_t j;
+        int8_t image[3];
+        float cutoff_sq;
+        bool operator<(const Found& o) const {
+            if (j != o.j) return j < o.j;
+            return std::lexicographical_compare(image, image + 3, o.image, o.image + 3);
+        }
+    };
+    struct TaskPairs {
+        size_t first_atom;
+        std::vector<Found> pairs;
+    };
+    // Cell index c along axis k, wrapped into the grid for periodic axes with the lattice shift
+    // that takes; false past the edge of a non-periodic axis
+    auto neighbor_cell = [&](int k, int c, int& wrapped, int& shift) {
+        shift = 0;
+        if (cell.pbc[k]) {
+            shift = c >= 0 ? c / dim[k] : -((dim[k] - 1 - c) / dim[k]); // floor(c / dim)
+            c -= shift * dim[k];
+        } else if (c < 0 || c >= dim[k]) {
+            return false;
+        }
+        wrapped = c;
+        return true;
+    };
+    std::vector<uint32_t> pair_count(n, 0);
+    std::vector<TaskPairs> buffers;
+    std::mutex buffers_mutex;
+    parallel_for(n, 1024, [&](size_t begin, size_t end) {
+        TaskPairs local{begin, {}};
+        std::vector<Found> found;
+        std::vector<float> distance_sq;
+        for (size_t i = begin; i < end; ++i) {
+            const int* home = &home_cell[3 * i];
+            const float radius_i = radius_by_element[atoms.atomic_number[i]];
+            found.clear();
+            for (int oz = -reach_cells[2]; oz <= reach_cells[2]; ++oz)
+            for (int oy = -reach_cells[1]; oy <= reach_cells[1]; ++oy) {
+                int shift[3], cy, cz;
+                if (!neighbor_cell(1, home[1] + oy, cy, shift[1]) || !neighbor_cell(2, home[2] + oz, cz, shift[2])) continue;
+                const size_t row = static_cast<size_t>(cz * dim[1] + cy) * dim[0];
+                // Cells along a with the same shift are adjacent in cell_atoms: one run each
+                for (int ox = -reach_cells[0]; ox <= reach_cells[0];) {
+                    int first_cx;
+                    if (!neighbor_cell(0, home[0] + ox, first_cx, shift[0])) { ++ox; continue; }
+                    int last_cx = first_cx, next_cx, next_shift;
+                    for (++ox; ox <= reach_cells[0] && neighbor_cell(0, home[0] + ox, next_cx, next_shift) &&
+                               next_shift == shift[0] && next_cx == last_cx + 1; ++ox) {
+                        last_cx = next_cx;
+                    }
+                    const uint32_t run_begin = cell_start[row + first_cx], run_end = cell_start[row + last_cx + 1];
+                    if (run_begin == run_end) continue;
+                    const bool translated = shift[0] != 0 || shift[1] != 0 || shift[2] != 0;
+                    // Of the two translations -t and t between an atom and its own images, keep the
+                    // lexicographically positive one so that each such bond is found once
+                    const bool positive_shift = shift[0] > 0 || (shift[0] == 0 && (shift[1] > 0 || (shift[1] == 0 && shift[2] > 0)));
+                    const bool self_image = translated && positive_shift;
+                    const Vec3 center = Vec3(px[i], py[i], pz[i]) - cell.translation(shift[0], shift[1], shift[2]);
+                    const size_t count = run_end - run_begin;
+                    if (distance_sq.size() < count) distance_sq.resize(count);
+                    squared_distances(&cell_x[run_begin], &cell_y[run_begin], &cell_z[run_begin], count, center, distance_sq.data());
+                    for (size_t k = 0; k < count; ++k) {
+                        const uint32_t slot = run_begin + static_cast<uint32_t>(k);
+                        const uint32_t j = cell_atoms[slot];
+                        if (j < i || (j == i && !self_image)) continue;
+                        float max_bond_dist = (radius_i + cell_radius[slot]) * BOND_DISTANCE_TOLERANCE_FACTOR;
+                        float list_dist = max_bond_dist + extra;
+                        if (distance_sq[k] > list_dist * list_dist || (skip_overlaps && distance_sq[k] <= 0.0001f)) continue;
+                        Found pair{j, {0, 0, 0}, max_bond_dist * max_bond_dist};
+                        bool representable = true;
+                        for (int axis = 0; axis < 3; ++axis) {
+                            int image = shift[axis] + wrap[axis][i] - wrap[axis][j];
+                            representable = representable && image >= -127 && image <= 127;
+                            pair.image[axis] = static_cast<int8_t>(image);
+                        }
+                        if (representable) found.push_back(pair); // Else coordinates lie ~100 cells apart
+                    }
+                }
+            }
+            std::sort(found.begin(), found.end());
+            pair_count[i] = static_cast<uint32_t>(found.size());
+            local.pairs.insert(local.pairs.end(), found.begin(), found.end());
+        }
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(std::move(local));
+    });
+    std::sort(buffers.begin(), buffers.end(), [](const TaskPairs& a, const TaskPairs& b) { return a.first_atom < b.first_atom; });
+
+    for (size_t i = 0; i < n; ++i) out.start[i + 1] = out.start[i] + pair_count[i];
+    out.partner.reserve(out.start[n]);
+    out.image.reserve(3 * out.start[n]);
+    out.cutoff_sq.reserve(out.start[n]);
+    for (const TaskPairs& buffer : buffers) {
+        for (const Found& pair : buffer.pairs) {
+            out.partner.push_back(pair.j);
+            out.image.insert(out.image.end(), pair.image, pair.image + 3);
+            out.cutoff_sq.push_back(pair.cutoff_sq);
+        }
+    }
+    return true;
+}
+
+// generate_bonds for a molecule with a periodic cell: minimum-image bonds, plus further images
+// in cells smaller than a bond
+static void generate_periodic_bonds(Molecule& mol) {
+    PeriodicPairs pairs;
+    if (!find_periodic_pairs(mol, 0.0f, true, pairs)) return;
+    const size_t first_bond = mol.bonds.size();
+    mol.bonds.resize(first_bond + pairs.partner.size());
+    size_t crossing = 0;
+    for (size_t i = 0; i + 1 < pairs.start.size(); ++i) {
+        for (uint32_t k = pairs.start[i]; k < pairs.start[i + 1]; ++k) {
+            Bond& bond = mol.bonds[first_bond + k];
+            bond = {i, pairs.partner[k], 1};
+            std::copy_n(&pairs.image[3 * k], 3, bond.image);
+            crossing += bond.crosses_cell();
+        }
+    }
+    std::cout << "C++: Automatically generated " << pairs.partner.size() << " bonds, " << crossing
+              << " across cell faces (periodic cell list " << pairs.dims[0] << "x" << pairs.dims[1] << "x"
+              << pairs.dims[2] << ")." << std::endl;
+}
+
+void generate_bonds(Molecule& mol) {
+    const AtomArrays& atoms = mol.atoms;
+    if (atoms.empty()) return;
+    if (mol.cell.periodic()) {
+        generate_periodic_bonds(mol);
+        return;
+    }
+
+    float radius_by_element[ELEMENT_COUNT + 1];
+    float max_cov_radius = fill_radius_table(atoms, radius_by_element);
+    // No bond can be longer than twice the largest covalent radius times the tolerance
+    CellGrid grid;
+    grid.build(atoms, 2.0f * max_cov_radius * BOND_DISTANCE_TOLERANCE_FACTOR);
+
+    // Cells are split among threads. Each task records, for every atom i in its cells, the
+    // partners j > i in ascending order in a buffer of its own; since every atom lives in exactly
+    // one cell, a counting sort by i then merges the buffers into the pairwise-scan order,
+    // independent of the thread count and of which task ran where.
+    const size_t n = atoms.size();
+    const size_t cell_count = grid.cell_start.size() - 1;
+    std::vector<float> cell_radius(n); // Covalent radius of cell_atoms[k], beside cell_x/y/z
+    parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) cell_radius[k] = radius_by_element[atoms.atomic_number[grid.cell_atoms[k]]];
+    });
+    std::vector<uint32_t> partner_count(n), partner_offset(n), partner_buffer(n);
+    std::vector<std::vector<uint32_t>> buffers;
+    std::mutex buffers_mutex;
+    parallel_for(cell_count, 64, [&](size_t first_cell, size_t last_cell) {
+        std::vector<uint32_t> local;      // Partner lists of this task's atoms, back to back
+        std::vector<uint32_t> partners;   // Bonded j > i for the current atom
+        std::vector<float> distance_sq;   // Squared distances to one run of candidates
+        std::vector<uint32_t> task_atoms; // Atoms with partners, to tag with the buffer index
+        for (uint32_t slot = grid.cell_start[first_cell]; slot < grid.cell_start[last_cell]; ++slot) {
+            const uint32_t i = grid.cell_atoms[slot];
+            const Vec3 center(grid.cell_x[slot], grid.cell_y[slot], grid.cell_z[slot]);
+            const float radius_i = cell_radius[slot];
+            partners.clear();
+            grid.for_each_candidate_run(center.x, center.y, center.z, [&](uint32_t begin, uint32_t end) {
+                const size_t count = end - begin;
+                if (distance_sq.size() < count) distance_sq.resize(count);
+                squared_distances(&grid.cell_x[begin], &grid.cell_y[begin], &grid.cell_z[begin], count, center, distance_sq.data());
+                for (size_t k = 0; k < count; ++k) {
+                    uint32_t j = grid.cell_atoms[begin + k];
+                    if (j <= i) continue;
+                    float max_bond_dist = (radius_i + cell_radius[begin + k]) * BOND_DISTANCE_TOLERANCE_FACTOR;
+                    // The small epsilon skips overlapping duplicate atoms in bad input
+                    if (distance_sq[k] <= max_bond_dist * max_bond_dist && distance_sq[k] > 0.0001f) {
+                        partners.push_back(j);
+                    }
+                }
+            });
+            partner_count[i] = static_cast<uint32_t>(partners.size());
+            if (partners.empty()) continue;
+            // Cells are visited out of index order; sort to keep the pairwise-scan ordering
+            std::sort(partners.begin(), partners.end());
+            partner_offset[i] = static_cast<uint32_t>(local.size());
+            local.insert(local.end(), partners.begin(), partners.end());
+            task_atoms.push_back(i);
+        }
+        if (local.empty()) return;
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        for (uint32_t i : task_atoms) partner_buffer[i] = static_cast<uint32_t>(buffers.size());
+        buffers.push_back(std::move(local));
+    });
+
+    // Counting sort by the first atom; each atom's bonds are copied in one piece
+    const size_t first_bond = mol.bonds.size();
+    std::vector<size_t> bond_start(n + 1, first_bond);
+    for (size_t i = 0; i < n; ++i) bond_start[i + 1] = bond_start[i] + partner_count[i];
+    mol.bonds.resize(bond_start[n]);
+    parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (partner_count[i] == 0) continue;
+            const uint32_t* partners = buffers[partner_buffer[i]].data() + partner_offset[i];
+            Bond* out = &mol.bonds[bond_start[i]];
+            for (uint32_t k = 0; k < partner_count[i]; ++k) {
+                out[k] = {i, partners[k], 1}; // Default to order 1 for auto-generated bonds
+            }
+        }
+    });
+    std::cout << "C++: Automatically generated " << mol.bonds.size() << " bonds (cell list "
+              << grid.dim_x << "x" << grid.dim_y << "x" << grid.dim_z << ")." << std::endl;
+}
+
+void BondNeighborList::clear() {
+    pair_start.clear();
+    partners.clear();
+    pair_cutoff_sq.clear();
+    pair_image.clear();
+    pair_shift.clear();
+    bonded_scratch.clear();
+    ref_x.clear();
+    ref_y.clear();
+    ref_z.clear();
+    cell.clear();
+}
+
+void BondNeighborList::build(const Molecule& mol) {
+    clear();
+    const AtomArrays& atoms = mol.atoms;
+    const size_t n = atoms.size();
+    build_count++;
+    if (n == 0) return;
+    ref_x = atoms.x;
+    ref_y = atoms.y;
+    ref_z = atoms.z;
+    cell = mol.cell;
+
+    if (cell.periodic()) {
+        PeriodicPairs pairs;
+        find_periodic_pairs(mol, skin, false, pairs);
+        pair_start = std::move(pairs.start);
+        partners = std::move(pairs.partner);
+        pair_cutoff_sq = std::move(pairs.cutoff_sq);
+        pair_image = std::move(pairs.image);
+        pair_shift.resize(pair_image.size());
+        for (size_t k = 0; k < partners.size(); ++k) {
+            Vec3 t = cell.translation(&pair_image[3 * k]);
+            pair_shift[3 * k] = t.x;
+            pair_shift[3 * k + 1] = t.y;
+            pair_shift[3 * k + 2] = t.z;
+        }
+        return;
+    }
+
+    float radius_by_element[ELEMENT_COUNT + 1];
+    float max_cov_radius = fill_radius_table(atoms, radius_by_element);
+    CellGrid grid;
+    grid.build(atoms, 2.0f * max_cov_radius * BOND_DISTANCE_TOLERANCE_FACTOR + skin);
+
+    // Same scheme as generate_bonds: tasks over ranges of cells write each atom's sorted pairs
+    // into buffers of their own, then the pairs are gathered per atom in index order, so the
+    // list does not depend on the thread count.
+    const size_t cell_count = grid.cell_start.size() - 1;
+    std::vector<float> cell_radius(n);
+    for (size_t k = 0; k < n; ++k) cell_radius[k] = radius_by_element[atoms.atomic_number[grid.cell_atoms[k]]];
+    struct TaskPairs {
+        std::vector<uint32_t> partners;
+        std::vector<float> cutoff_sq;
+    };
+    std::vector<uint32_t> pair_count(n), pair_offset(n), pair_buffer(n);
+    std::vector<TaskPairs> buffers;
+    std::mutex buffers_mutex;
+    parallel_for(cell_count, 64, [&](size_t first_cell, size_t last_cell) {
+        TaskPairs local;
+        std::vector<std::pair<uint32_t, float>> found; // Partner and squared bond cutoff
+        std::vector<float> distance_sq;
+        std::vector<uint32_t> task_atoms;
+        for (uint32_t slot = grid.cell_start[first_cell]; slot < grid.cell_start[last_cell]; ++slot) {
+            const uint32_t i = grid.cell_atoms[slot];
+            const Vec3 center(grid.cell_x[slot], grid.cell_y[slot], grid.cell_z[slot]);
+            const float radius_i = cell_radius[slot];
+            found.clear();
+            grid.for_each_candidate_run(center.x, center.y, center.z, [&](uint32_t begin, uint32_t end) {
+                const size_t count = end - begin;
+                if (distance_sq.size() < count) distance_sq.resize(count);
+                squared_distances(&grid.cell_x[begin], &grid.cell_y[begin], &grid.cell_z[begin], count, center, distance_sq.data());
+                for (size_t k = 0; k < count; ++k) {
+                    uint32_t j = grid.cell_atoms[begin + k];
+                    if (j <= i) continue;
+                    // Same expression as generate_bonds, so a listed pair bonds exactly when it would there
+                    float max_bond_dist = (radius_i + cell_radius[begin + k]) * BOND_DISTANCE_TOLERANCE_FACTOR;
+                    float list_dist = max_bond_dist + skin;
+                    if (distance_sq[k] <= list_dist * list_dist) found.push_back({j, max_bond_dist * max_bond_dist});
+                }
+            });
+            pair_count[i] = static_cast<uint32_t>(found.size());
+            if (found.empty()) continue;
+            std::sort(found.begin(), found.end());
+            pair_offset[i] = static_cast<uint32_t>(local.partners.size());
+            for (const auto& pair : found) {
+                local.partners.push_back(pair.first);
+                local.cutoff_sq.push_back(pair.second);
+            }
+            task_atoms.push_back(i);
+        }
+        if (local.partners.empty()) return;
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        for (uint32_t i : task_atoms) pair_buffer[i] = static_cast<uint32_t>(buffers.size());
+        buffers.push_back(std::move(local));
+    });
+
+    pair_start.assign(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) pair_start[i + 1] = pair_start[i] + pair_count[i];
+    partners.resize(pair_start[n]);
+    pair_cutoff_sq.resize(pair_start[n]);
+    parallel_for(n, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (pair_count[i] == 0) continue;
+            const TaskPairs& buffer = buffers[pair_buffer[i]];
+            std::copy_n(buffer.partners.begin() + pair_offset[i], pair_count[i], partners.begin() + pair_start[i]);
+            std::copy_n(buffer.cutoff_sq.begin() + pair_offset[i], pair_count[i], pair_cutoff_sq.begin() + pair_start[i]);
+        }
+    });
+}
+
+bool BondNeighborList::needs_rebuild(const Molecule& mol) const {
+    const AtomArrays& atoms = mol.atoms;
+    const size_t n = atoms.size();
+    if (n == 0 || ref_x.size() != n || mol.cell != cell) return true;
+    // Two atoms that each moved at most skin / 2 closed their distance by at most the skin
+    const float limit_sq = 0.25f * skin * skin;
+    float max_sq = 0.0f;
+    for (size_t i = 0; i < n; ++i) { // No early exit, so the loop vectorizes
+        float dx = atoms.x[i] - ref_x[i], dy = atoms.y[i] - ref_y[i], dz = atoms.z[i] - ref_z[i];
+        max_sq = std::max(max_sq, dx * dx + dy * dy + dz * dz);
+    }
+    return max_sq > limit_sq;
+}
+
+bool BondNeighborList::update_bonds(Molecule& mol) {
+    const AtomArrays& atoms = mol.atoms;
+    const bool rebuilt = needs_rebuild(mol);
+    if (rebuilt) build(mol);
+    mol.bonds.clear();
+    const size_t n = atoms.size();
+    if (n == 0) return rebuilt;
+
+    // One pass over the pairs. Every pair is written to the scratch list and the output advances
+    // only past the bonded ones, which avoids a hard-to-predict branch per pair.
+    const float* x = atoms.x.data();
+    const float* y = atoms.y.data();
+    const float* z = atoms.z.data();
+    const uint32_t* js = partners.data();
+    const float* cutoff_sq = pair_cutoff_sq.data();
+    bonded_scratch.resize(2 * partners.size() + 2);
+    uint32_t* out = bonded_scratch.data();
+    size_t bond_count = 0;
+    if (!pair_shift.empty()) {
+        // Periodic: the same pass against each pair's image, recording the pair rather than j
+        const float* shift = pair_shift.data();
+        for (size_t i = 0; i < n; ++i) {
+            const float xi = x[i], yi = y[i], zi = z[i];
+            const uint32_t last = pair_start[i + 1];
+            for (uint32_t k = pair_start[i]; k < last; ++k) {
+                const uint32_t j = js[k];
+                float dx = x[j] + shift[3 * k] - xi, dy = y[j] + shift[3 * k + 1] - yi, dz = z[j] + shift[3 * k + 2] - zi;
+                float distance_sq = dx * dx + dy * dy + dz * dz;
+                out[2 * bond_count] = static_cast<uint32_t>(i);
+                out[2 * bond_count + 1] = k;
+                bond_count += (distance_sq <= cutoff_sq[k]) & (distance_sq > 0.0001f);
+            }
+        }
+        mol.bonds.resize(bond_count);
+        for (size_t b = 0; b < bond_count; ++b) {
+            const uint32_t k = out[2 * b + 1];
+            mol.bonds[b] = {out[2 * b], js[k], 1};
+            std::copy_n(&pair_image[3 * k], 3, mol.bonds[b].image);
+        }
+        return rebuilt;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const float xi = x[i], yi = y[i], zi = z[i];
+        const uint32_t last = pair_start[i + 1];
+        for (uint32_t k = pair_start[i]; k < last; ++k) {
+            const uint32_t j = js[k];
+            float dx = x[j] - xi, dy = y[j] - yi, dz = z[j] - zi;
+            float distance_sq = dx * dx + dy * dy + dz * dz;
+            out[2 * bond_count] = static_cast<uint32_t>(i);
+            out[2 * bond_count + 1] = j;
+            // The small epsilon skips overlapping duplicate atoms, as in generate_bonds
+            bond_count += (distance_sq <= cutoff_sq[k]) & (distance_sq > 0.0001f);
+        }
+    }
+    mol.bonds.resize(bond_count);
+    for (size_t b = 0; b < bond_count; ++b) mol.bonds[b] = {out[2 * b], out[2 * b + 1], 1};
+    return rebuilt;
+}
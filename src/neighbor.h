@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "molecule.h"
+
+// Allow bonds up to 20% longer than the sum of covalent radii
+const float BOND_DISTANCE_TOLERANCE_FACTOR = 1.2f;
+
+// Uniform grid (cell list) over atom positions for fixed-radius neighbor queries.
+// Atoms are bucketed with a counting sort, so each cell lists its atoms in ascending index order.
+// Cells along x are adjacent in memory, so each row of a 3x3x3 query block is one contiguous run
+// of cell_atoms, with the coordinates copied alongside for batched distance kernels.
+struct CellGrid {
+    float origin_x = 0.0f, origin_y = 0.0f, origin_z = 0.0f;
+    float cell_size = 1.0f;
+    int dim_x = 0, dim_y = 0, dim_z = 0;
+    std::vector<uint32_t> cell_start; // cell_count + 1 offsets into cell_atoms
+    std::vector<uint32_t> cell_atoms; // Atom indices grouped by cell
+    std::vector<float> cell_x, cell_y, cell_z; // Coordinates of cell_atoms[k] at index k
+
+    // min_cell_size must be >= the largest query radius; cells may grow for sparse systems
+    void build(const AtomArrays& atoms, float min_cell_size);
+
+    int cell_coord(float v, float origin, int dim) const {
+        int c = static_cast<int>((v - origin) / cell_size);
+        return c < 0 ? 0 : (c >= dim ? dim - 1 : c);
+    }
+    int cell_index(int cx, int cy, int cz) const { return (cz * dim_y + cy) * dim_x + cx; }
+
+    // Calls fn(begin, end) for the up to nine non-empty runs [begin, end) of cell_atoms that
+    // make up the 3x3x3 block of cells around (x, y, z)
+    template <typename Fn>
+    void for_each_candidate_run(float x, float y, float z, Fn&& fn) const {
+        if (cell_start.empty()) return;
+        int cx = cell_coord(x, origin_x, dim_x);
+        int cy = cell_coord(y, origin_y, dim_y);
+        int cz = cell_coord(z, origin_z, dim_z);
+        int x_first = cx > 0 ? cx - 1 : 0;
+        int x_last = cx < dim_x - 1 ? cx + 1 : dim_x - 1;
+        for (int z0 = cz - 1; z0 <= cz + 1; ++z0) {
+            if (z0 < 0 || z0 >= dim_z) continue;
+            for (int y0 = cy - 1; y0 <= cy + 1; ++y0) {
+                if (y0 < 0 || y0 >= dim_y) continue;
+                uint32_t begin = cell_start[cell_index(x_first, y0, z0)];
+                uint32_t end = cell_start[cell_index(x_last, y0, z0) + 1];
+                if (begin < end) fn(begin, end);
+            }
+        }
+    }
+
+    // Visit every atom in the 3x3x3 block of cells around (x, y, z)
+    template <typename Fn>
+    void for_each_candidate(float x, float y, float z, Fn&& fn) const {
+        for_each_candidate_run(x, y, z, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t k = begin; k < end; ++k) fn(cell_atoms[k]);
+        });
+    }
+};
+
+// Distance-based bond perception using a cell list. Appends bonds ordered by (atom1_idx, atom2_idx),
+// identical to a full pairwise scan over j > i. In a periodic cell (mol.cell) atoms bond to the
+// nearest images of their neighbors across the cell faces, with the lattice shift in Bond::image;
+// an atom bonded to several images of one partner (or to its own images, in cells smaller than a
+// bond) gets one bond per image, ordered by image after the partner index.
+void generate_bonds(Molecule& mol);
+
+// Verlet skin for BondNeighborList, in Angstrom. Larger skins list more pairs per atom but
+// survive more frames between rebuilds.
+const float BOND_NEIGHBOR_SKIN = 0.8f;
+
+// Verlet neighbor list for bond perception over moving coordinates (trajectory frames). It
+// holds every pair i < j closer than the pair's bond cutoff plus the skin when it was built.
+// Until some atom has moved more than half the skin from its position at that time, no unlisted
+// pair can have come within bonding distance, so bonds are re-tested only against the list.
+// Pairs are stored per first atom, in ascending order, so the bonds come out in the same order
+// as from generate_bonds. In a periodic cell each pair also records the image it refers to.
+struct BondNeighborList {
+    float skin = BOND_NEIGHBOR_SKIN;
+    std::vector<uint32_t> pair_start;     // atom_count + 1 offsets into partners
+    std::vector<uint32_t> partners;       // j > i for the pairs of atom i
+    std::vector<float> pair_cutoff_sq;    // Squared bond cutoff of each listed pair
+    std::vector<int8_t> pair_image;       // Periodic cells: 3 per pair, lattice translation of j
+    std::vector<float> pair_shift;        // Periodic cells: 3 per pair, the same translation in Angstrom
+    std::vector<uint32_t> bonded_scratch; // Bonded pairs (i, j) found by update_bonds
+    std::vector<float> ref_x, ref_y, ref_z; // Atom positions at the last build
+    UnitCell cell;                        // Cell at the last build
+    size_t build_count = 0;
+
+    void clear();
+    size_t atom_count() const { return ref_x.size(); }
+    void build(const Molecule& mol);
+    bool needs_rebuild(const Molecule& mol) const; // Empty, resized, new cell, or moved past skin / 2
+
+    // Replaces mol.bonds with the single bonds among the listed pairs, rebuilding the list first
+    // when needs_rebuild says so. O(N) per call apart from rebuilds. Returns true if it rebuilt.
+    bool update_bonds(Molecule& mol);
+};
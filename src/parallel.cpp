@@ -0,0 +1,180 @@
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PARALLEL_HAS_THREADS 1
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#endif
+
+static std::atomic<unsigned> thread_limit(0); // 0 = hardware concurrency
+
+static unsigned hardware_thread_count() {
+#ifdef PARALLEL_HAS_THREADS
+    static const unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    return count;
+#else
+    return 1;
+#endif
+}
+
+unsigned worker_thread_count() {
+    unsigned limit = thread_limit.load(std::memory_order_relaxed);
+    return limit == 0 ? hardware_thread_count() : std::min(limit, hardware_thread_count());
+}
+
+void set_worker_thread_count(unsigned count) {
+    thread_limit = count;
+}
+
+#ifdef PARALLEL_HAS_THREADS
+namespace {
+
+// One parallel_for call; done once every index has been processed
+struct Job {
+    const std::function<void(size_t, size_t)>* fn;
+    size_t grain;
+    std::atomic<size_t> remaining;
+};
+
+struct Task {
+    Job* job;
+    size_t begin, end;
+};
+
+// Double-ended task queue: the owner pushes and pops at the back (newest, smallest ranges,
+// still warm in its cache), thieves take from the front (oldest, largest ranges)
+struct TaskDeque {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+
+    void push(const Task& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task);
+    }
+    bool pop(Task& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+    bool steal(Task& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+};
+
+// Deque 0 belongs to the threads calling parallel_for (the main thread, or a loader thread);
+// deque k > 0 to pool worker k. Workers start on first use and live for the program.
+class ThreadPool {
+public:
+    static ThreadPool& instance() {
+        static ThreadPool* pool = new ThreadPool(); // Never destroyed: workers may outlive statics
+        return *pool;
+    }
+
+    void run(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+        Job job{&fn, grain, {count}};
+        push(Task{&job, 0, count});
+        // Help until the job is finished; this may run tasks of other jobs, which is harmless
+        Task task;
+        while (job.remaining.load(std::memory_order_acquire) > 0) {
+            if (find_task(task)) execute(task);
+            else std::this_thread::yield();
+        }
+    }
+
+private:
+    ThreadPool() : deques(hardware_thread_count()) {
+        for (auto& deque : deques) deque.reset(new TaskDeque());
+        for (size_t k = 1; k < deques.size(); ++k) std::thread(&ThreadPool::worker_loop, this, k).detach();
+    }
+
+    static size_t& current_slot() {
+        static thread_local size_t slot = 0;
+        return slot;
+    }
+
+    void push(const Task& task) {
+        queued.fetch_add(1, std::memory_order_release); // Before the push, so a thief never sees it drop below 0
+        deques[current_slot()]->push(task);
+        if (sleeping.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            wake.notify_one();
+        }
+    }
+
+    bool find_task(Task& task) {
+        const size_t self = current_slot();
+        bool found = deques[self]->pop(task);
+        for (size_t k = 1; !found && k < deques.size(); ++k) {
+            found = deques[(self + k) % deques.size()]->steal(task);
+        }
+        if (found) queued.fetch_sub(1, std::memory_order_relaxed);
+        return found;
+    }
+
+    // Splits off upper halves for other threads until the range is at most one grain, then runs it
+    void execute(Task task) {
+        Job* job = task.job;
+        while (task.end - task.begin > job->grain) {
+            size_t mid = task.begin + (task.end - task.begin) / 2;
+            push(Task{job, mid, task.end});
+            task.end = mid;
+        }
+        (*job->fn)(task.begin, task.end);
+        job->remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+    }
+
+    void worker_loop(size_t slot) {
+        current_slot() = slot;
+        Task task;
+        while (true) {
+            // Workers past the configured thread limit stay idle
+            if (slot < worker_thread_count() && find_task(task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping.fetch_add(1, std::memory_order_acq_rel);
+            wake.wait_for(lock, std::chrono::milliseconds(10), [&] {
+                return slot < worker_thread_count() && queued.load(std::memory_order_acquire) > 0;
+            });
+            sleeping.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    std::vector<std::unique_ptr<TaskDeque>> deques;
+    std::atomic<size_t> queued{0};
+    std::atomic<int> sleeping{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+};
+
+} // namespace
+#endif
+
+void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) return;
+    min_chunk = std::max<size_t>(min_chunk, 1);
+    size_t threads = std::min<size_t>(worker_thread_count(), (count + min_chunk - 1) / min_chunk);
+    if (threads <= 1) {
+        fn(0, count);
+        return;
+    }
+#ifdef PARALLEL_HAS_THREADS
+    // About eight leaf ranges per thread leave room to rebalance uneven work by stealing
+    size_t grain = std::max(min_chunk, count / (threads * 8));
+    ThreadPool::instance().run(count, grain, fn);
+#endif
+}
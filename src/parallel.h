@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+// Threads parallel_for may use: the hardware concurrency in pthread builds (make THREADS=1)
+// and native tools, 1 in single-threaded WebAssembly builds, or the limit set below.
+unsigned worker_thread_count();
+
+// Caps the threads parallel_for uses (including the caller); 0 restores the hardware
+// concurrency. Used for scaling measurements; the pool itself is never resized.
+void set_worker_thread_count(unsigned count);
+
+// Calls fn(begin, end) over contiguous chunks covering [0, count) and returns when all are
+// done. Chunks are at least min_chunk long, so small inputs stay on the calling thread.
+// fn must be safe to run concurrently on disjoint ranges.
+//
+// Work runs on a persistent work-stealing pool: a thread holding a range splits off its upper
+// half for others until the range is small, idle threads steal the oldest (largest) pending
+// halves, and the caller works too until the whole range is done, so nested calls are fine.
+void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& fn);
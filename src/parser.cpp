@@ -1,131 +1,175 @@
 #include "parser.h"
 #include "renderer.h"
+#include "neighbor.h"
+#include "xyz_reader.h"
+#include "trajectory.h"
+#include "sdf_library.h"
+#include "pdb_reader.h"
+#include "cif_reader.h"
+#include "molecule_binary.h"
+#include "loader.h"
 #include <iostream>
-#include <sstream>
+#include <cstring>
+
+// Streaming load state: the molecule and any further trajectory frames are staged here and
+// swapped into current_molecule and current_trajectory on finish
+static XyzStreamParser xyz_stream;
+static Molecule xyz_stream_molecule;
+static Trajectory xyz_stream_trajectory;
+static XyzFrameIndexer xyz_stream_indexer;
+static size_t xyz_stream_bytes = 0;
+static size_t xyz_stream_expected_bytes = 0;
+static double xyz_stream_start = 0.0;
+
+// Common tail of every XYZ load: throughput report, formula and bond perception
+static void finish_xyz_load(size_t bytes, double parse_ms) {
+    std::cout << "C++: Successfully loaded " << current_molecule.atoms.size() << " atoms from XYZ string." << std::endl;
+    std::cout << "C++: Parsed " << bytes / 1.0e6 << " MB in " << parse_ms << " ms ("
+              << (parse_ms > 0.0 ? (bytes / 1.0e6) / (parse_ms / 1000.0) : 0.0) << " MB/s)." << std::endl;
+    std::cout << "C++: Atom storage: " << current_molecule.atoms.memory_bytes() << " bytes ("
+              << static_cast<double>(current_molecule.atoms.memory_bytes()) / current_molecule.atoms.size() << " bytes/atom)." << std::endl;
+
+    // Generate molecular formula
+    current_molecule.formula = generate_molecular_formula(current_molecule);
+    std::cout << "C++: Molecule Name: " << current_molecule.name << ", Formula: " << current_molecule.formula << std::endl;
+
+    // --- Automatic Bond Generation ---
+    // XYZ carries no connectivity, so bonds are inferred from interatomic distances
+    generate_bonds(current_molecule);
+}
+
+// Loads a structure whose reader also builds the bonds (PDB, mmCIF)
+static void load_structure(const char* data, const char* format_name, bool (*parse)(const char*, size_t, Molecule&)) {
+    cancel_background_load(); // A direct load supersedes a background one
+    current_trajectory.clear();
+    current_sdf_library.clear();
+    current_molecule.clear();
+    current_molecule.name = "N/A";
+    current_molecule.formula = "N/A";
+    mark_instances_dirty();
+    std::cout << "C++: Attempting to load molecule from " << format_name << " string..." << std::endl;
+
+    size_t length = std::strlen(data);
+    double parse_start = emscripten_get_now();
+    if (!parse(data, length, current_molecule)) {
+        current_molecule.clear();
+        return;
+    }
+    double parse_ms = emscripten_get_now() - parse_start;
+    current_molecule.formula = generate_molecular_formula(current_molecule);
+    std::cout << "C++: Loaded " << current_molecule.atoms.size() << " atoms, " << current_molecule.structure.residues.size()
+              << " residues and " << current_molecule.bonds.size() << " bonds from " << format_name << " in " << parse_ms << " ms." << std::endl;
+    std::cout << "C++: Molecule Name: " << current_molecule.name << ", Formula: " << current_molecule.formula << std::endl;
+}
 
 extern "C" {
 EMSCRIPTEN_KEEPALIVE
 void load_molecule_from_xyz_string(const char* xyz_data_str) {
+    cancel_background_load(); // A direct load supersedes a background one
+    current_trajectory.clear();
+    current_sdf_library.clear();
     current_molecule.clear();
     current_molecule.name = "N/A"; // Default name
     current_molecule.formula = "N/A"; // Default formula
+    mark_instances_dirty();
     std::cout << "C++: Attempting to load molecule from XYZ string..." << std::endl;
 
-    std::istringstream stream(xyz_data_str);
-    std::string line;
-    int num_atoms = 0;
-    int line_number = 0;
-
-    try {
-        // Line 1: Number of atoms
-        if (std::getline(stream, line)) {
-            line_number++;
-            if (line.empty()) {
-                 std::cerr << "XYZ Parse Error (Line " << line_number << "): Number of atoms line is empty." << std::endl; return;
-            }
-            num_atoms = std::stoi(line);
-            if (num_atoms <= 0) {
-                std::cerr << "XYZ Parse Error (Line " << line_number << "): Invalid number of atoms: " << num_atoms << std::endl; return;
-            }
-        } else {
-            std::cerr << "XYZ Parse Error: Could not read number of atoms line." << std::endl; return;
-        }
-
-        // Line 2: Comment line (potential name)
-        if (std::getline(stream, line)) {
-            line_number++;
-            current_molecule.name = line; // Store the comment line as the name
-            // Trim whitespace from name (optional but good)
-            current_molecule.name.erase(0, current_molecule.name.find_first_not_of(" \t\n\r\f\v"));
-            current_molecule.name.erase(current_molecule.name.find_last_not_of(" \t\n\r\f\v") + 1);
-            if(current_molecule.name.empty()) current_molecule.name = "Untitled Molecule";
-
-        } else {
-            std::cerr << "XYZ Parse Error: Could not read comment line." << std::endl; return;
-        }
-
-        // Subsequent lines: Atom data
-        for (int i = 0; i < num_atoms; ++i) {
-            if (std::getline(stream, line)) {
-                line_number++;
-                if (line.empty() && i < num_atoms -1) { // Allow last line to be empty only if all atoms parsed
-                    std::cerr << "XYZ Parse Error (Line " << line_number << "): Atom line is empty." << std::endl; return;
-                }
-                if (line.empty() && i == num_atoms -1) break; // Trailing empty line after all atoms are fine
-
-                std::istringstream atom_line_stream(line);
-                std::string element_symbol;
-                float x, y, z; // Removed radius_default
-                float cov_r_default, vdw_r_default; // Added separate radius variables
-                Vec3 color_default;
-                
-                if (!(atom_line_stream >> element_symbol >> x >> y >> z)) {
-                    std::cerr << "XYZ Parse Error (Line " << line_number << "): Could not parse atom data: " << line << std::endl; return;
-                }
-                get_atom_properties(element_symbol, cov_r_default, vdw_r_default, color_default);
-                current_molecule.atoms.push_back({x, y, z, element_symbol, cov_r_default, vdw_r_default, color_default});
-            } else {
-                std::cerr << "XYZ Parse Error: Unexpected end of file. Expected " << num_atoms << " atoms, got " << i << std::endl; return;
-            }
-        }
-        std::cout << "C++: Successfully loaded " << current_molecule.atoms.size() << " atoms from XYZ string." << std::endl;
-        
-        // Generate molecular formula
-        current_molecule.formula = generate_molecular_formula(current_molecule);
-        std::cout << "C++: Molecule Name: " << current_molecule.name << ", Formula: " << current_molecule.formula << std::endl;
-
-    } catch (const std::invalid_argument& ia) {
-        std::cerr << "XYZ Parse Error (Line " << line_number << "): Invalid number format - " << ia.what() << " Line content: \"" << line << "\"" << std::endl;
+    size_t length = std::strlen(xyz_data_str);
+    double parse_start = emscripten_get_now();
+    if (!parse_xyz(xyz_data_str, length, current_molecule)) {
         current_molecule.clear(); // Clear partially loaded molecule on error
-    } catch (const std::out_of_range& oor) {
-        std::cerr << "XYZ Parse Error (Line " << line_number << "): Number out of range - " << oor.what() << " Line content: \"" << line << "\"" << std::endl;
-        current_molecule.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "XYZ Parse Error (Line " << line_number << "): Generic error - " << e.what() << " Line content: \"" << line << "\"" << std::endl;
-        current_molecule.clear();
-    } catch (...) {
-        std::cerr << "XYZ Parse Error (Line " << line_number << "): Unknown error during parsing. Line content: \"" << line << "\"" << std::endl;
-        current_molecule.clear();
         return; // Return on error so we don't try to generate bonds on incomplete data
     }
+    finish_xyz_load(length, emscripten_get_now() - parse_start);
+}
 
-    // --- Automatic Bond Generation ---
-    if (!current_molecule.atoms.empty()) {
-        const float BOND_DISTANCE_TOLERANCE_FACTOR = 1.2f; // Allow bonds up to 20% longer than sum of covalent radii
-        // A slightly more generous factor for H bonds or slightly longer bonds if desired: 1.3f
-        // Or a fixed tolerance: e.g. sum_radii + 0.4 Angstroms
+EMSCRIPTEN_KEEPALIVE
+void xyz_stream_begin(double expected_bytes) {
+    xyz_stream_molecule.clear();
+    xyz_stream_trajectory.clear();
+    xyz_stream.begin(xyz_stream_molecule);
+    xyz_stream_bytes = 0;
+    xyz_stream_expected_bytes = expected_bytes > 0.0 ? static_cast<size_t>(expected_bytes) : 0;
+    xyz_stream_start = emscripten_get_now();
+    std::cout << "C++: Streaming molecule from XYZ chunks..." << std::endl;
+}
 
-        size_t num_loaded_atoms = current_molecule.atoms.size();
-        for (size_t i = 0; i < num_loaded_atoms; ++i) {
-            for (size_t j = i + 1; j < num_loaded_atoms; ++j) { // Iterate unique pairs (j > i)
-                const Atom& atom_i = current_molecule.atoms[i];
-                const Atom& atom_j = current_molecule.atoms[j];
+EMSCRIPTEN_KEEPALIVE
+int xyz_stream_feed(const char* chunk, int length) {
+    if (xyz_stream.has_failed()) return 0;
+    if (length <= 0) return 1;
+    xyz_stream_bytes += static_cast<size_t>(length);
+    size_t rest = static_cast<size_t>(length);
+    if (!xyz_stream.frame_done()) {
+        if (xyz_stream.feed(chunk, rest)) return 1; // Still inside frame 0
+        if (xyz_stream.has_failed() || xyz_stream_molecule.atoms.empty()) return 0;
+        // Frame 0 is complete; whatever follows is kept and indexed as further trajectory frames
+        rest = xyz_stream.unconsumed();
+        begin_streamed_trajectory(xyz_stream_trajectory, xyz_stream_indexer, xyz_stream_molecule, xyz_stream.lines_read() + 1);
+        if (xyz_stream_expected_bytes > xyz_stream_bytes) xyz_stream_trajectory.text.reserve(xyz_stream_expected_bytes - xyz_stream_bytes + rest);
+    }
+    if (rest == 0) return 1;
+    return append_streamed_trajectory(xyz_stream_trajectory, xyz_stream_indexer, chunk + length - rest, rest) ? 1 : 0;
+}
 
-                Vec3 pos_i(atom_i.x, atom_i.y, atom_i.z);
-                Vec3 pos_j(atom_j.x, atom_j.y, atom_j.z);
+EMSCRIPTEN_KEEPALIVE
+int xyz_stream_finish() {
+    // Validate before touching the displayed molecule, so a bad file leaves it on screen
+    if (!xyz_stream.finish()) {
+        xyz_stream_molecule = Molecule(); // Discard the partially parsed molecule on error
+        xyz_stream_trajectory.clear();
+        std::cerr << "C++: Streamed XYZ rejected; keeping the current molecule." << std::endl;
+        return 0;
+    }
+    cancel_background_load(); // A direct load supersedes a background one
+    current_trajectory.clear();
+    current_sdf_library.clear();
+    mark_instances_dirty();
+    std::swap(current_molecule, xyz_stream_molecule); // Atoms, name and any extended-XYZ cell
+    xyz_stream_molecule = Molecule(); // Release the staging storage (the previous molecule)
+    finish_xyz_load(xyz_stream_bytes, emscripten_get_now() - xyz_stream_start);
+    if (xyz_stream_trajectory.frame_count() > 0) { // Frame 0 completed before the end of the input
+        finish_streamed_trajectory(xyz_stream_trajectory, xyz_stream_indexer);
+        std::swap(current_trajectory, xyz_stream_trajectory);
+        xyz_stream_trajectory.clear();
+        if (current_trajectory.frame_count() > 1) {
+            std::cout << "C++: Indexed trajectory with " << current_trajectory.frame_count() << " frames of "
+                      << current_trajectory.atom_count << " atoms." << std::endl;
+        }
+    }
+    return 1;
+}
 
-                float distance_sq = (pos_j - pos_i).length() * (pos_j - pos_i).length(); // More efficient to compare squared distances first
-                
-                float sum_cov_radii = atom_i.covalent_radius + atom_j.covalent_radius;
-                float max_bond_dist = sum_cov_radii * BOND_DISTANCE_TOLERANCE_FACTOR;
-                float max_bond_dist_sq = max_bond_dist * max_bond_dist;
+EMSCRIPTEN_KEEPALIVE
+void load_molecule_from_pdb_string(const char* pdb_data_str) {
+    load_structure(pdb_data_str, "PDB", parse_pdb);
+}
 
-                // A common lower bound to avoid bonding everything to H if radii are small
-                // Adjust if H atoms are not bonding correctly or too aggressively.
-                // float min_bond_dist = 0.4f; // Example: don't bond if atoms are too close (e.g. H-H very short)
-                // float min_bond_dist_sq = min_bond_dist * min_bond_dist;
+EMSCRIPTEN_KEEPALIVE
+void load_molecule_from_mmcif_string(const char* cif_data_str) {
+    load_structure(cif_data_str, "mmCIF", parse_mmcif);
+}
 
-                // if (distance_sq <= max_bond_dist_sq && distance_sq >= min_bond_dist_sq) {
-                if (distance_sq <= max_bond_dist_sq && distance_sq > 0.0001f) { // check distance_sq is not zero
-                     // Ensure the distance isn't *too* small, which might indicate overlapping identical atoms if data is bad
-                     // (though XYZ usually doesn't have this problem). The 0.0001f is a small epsilon.
-                    current_molecule.bonds.push_back({i, j, 1}); // Default to order 1 for auto-generated bonds
-                }
-            }
-        }
-        std::cout << "C++: Automatically generated " << current_molecule.bonds.size() << " bonds." << std::endl;
+EMSCRIPTEN_KEEPALIVE
+int load_molecule_from_binary(const uint8_t* data, int length) {
+    cancel_background_load(); // A direct load supersedes a background one
+    current_trajectory.clear();
+    current_sdf_library.clear();
+    current_molecule.clear();
+    current_molecule.name = "N/A";
+    current_molecule.formula = "N/A";
+    mark_instances_dirty();
+
+    double decode_start = emscripten_get_now();
+    if (length <= 0 || !decode_molecule_binary(data, static_cast<size_t>(length), current_molecule)) {
+        current_molecule.clear();
+        return 0;
     }
-    // Note: Bonds are not parsed from XYZ. If needed, bond generation logic (e.g., based on distance) would go here.
-    // The bond generation logic above *is* the distance based logic.
+    double decode_ms = emscripten_get_now() - decode_start;
+    current_molecule.formula = generate_molecular_formula(current_molecule);
+    std::cout << "C++: Loaded " << current_molecule.atoms.size() << " atoms and " << current_molecule.bonds.size()
+              << " bonds from " << length << " byte binary in " << decode_ms << " ms." << std::endl;
+    std::cout << "C++: Molecule Name: " << current_molecule.name << ", Formula: " << current_molecule.formula << std::endl;
+    return 1;
+}
 }
-} 
\ No newline at end of file
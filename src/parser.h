@@ -2,8 +2,32 @@
 #include "molecule.h"
 #include <emscripten/emscripten.h>
 
-// XYZ File Parsing Functions
+// Molecule File Parsing Functions
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     void load_molecule_from_xyz_string(const char* xyz_data_str);
-} 
\ No newline at end of file
+
+    // Streaming XYZ loading: begin (with the file size, used to reserve trajectory storage; 0 if
+    // unknown), feed raw chunks (lines may span chunks), then finish. Frames after the first are
+    // indexed as they arrive and become a trajectory. xyz_stream_feed returns 0 once parsing failed
+    // or the rest of the input cannot be further frames.
+    EMSCRIPTEN_KEEPALIVE
+    void xyz_stream_begin(double expected_bytes);
+
+    EMSCRIPTEN_KEEPALIVE
+    int xyz_stream_feed(const char* chunk, int length);
+
+    EMSCRIPTEN_KEEPALIVE
+    int xyz_stream_finish();
+
+    // Macromolecular formats: bonds come from the file and residue templates
+    EMSCRIPTEN_KEEPALIVE
+    void load_molecule_from_pdb_string(const char* pdb_data_str);
+
+    EMSCRIPTEN_KEEPALIVE
+    void load_molecule_from_mmcif_string(const char* cif_data_str);
+
+    // Loads a MOLB buffer (see molecule_binary.h) from the WASM heap; returns 1 on success
+    EMSCRIPTEN_KEEPALIVE
+    int load_molecule_from_binary(const uint8_t* data, int length);
+}
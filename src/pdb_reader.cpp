@@ -0,0 +1,158 @@
+#include "pdb_reader.h"
+#include "residue_templates.h"
+#include "text_scan.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Copies a blank-trimmed field into a NUL-padded fixed-size buffer
+template <size_t N>
+void copy_trimmed(const char* b, const char* e, char (&out)[N]) {
+    std::memset(out, 0, N);
+    b = skip_blanks(b, e);
+    while (e > b && is_blank(e[-1])) --e;
+    for (size_t i = 0; i < N - 1 && b + i < e; ++i) out[i] = b[i];
+}
+
+bool record_is(const char* line_begin, const char* line_end, const char* tag) {
+    size_t n = std::strlen(tag);
+    return static_cast<size_t>(line_end - line_begin) >= n && std::memcmp(line_begin, tag, n) == 0;
+}
+
+// Element from columns 77-78, or guessed from the atom name when that column is absent
+int pdb_element(const char* line_begin, const char* line_end, bool hetero) {
+    const char* b;
+    const char* e;
+    column_field(line_begin, line_end, 77, 78, b, e);
+    b = skip_blanks(b, e);
+    if (b < e) return atomic_number_from_symbol(b, e);
+
+    column_field(line_begin, line_end, 13, 16, b, e);
+    if (b < e && *b != ' ' && !is_digit(*b) && hetero) return atomic_number_from_symbol(b, e); // e.g. "FE  "
+    while (b < e && (*b == ' ' || is_digit(*b))) ++b;
+    return atomic_number_from_symbol(b, b < e ? b + 1 : e);
+}
+
+} // namespace
+
+bool parse_pdb(const char* data, size_t length, Molecule& out) {
+    StructureInfo& info = out.structure;
+    LineReader reader(data, data + length);
+    const char* line_begin;
+    const char* line_end;
+
+    std::vector<std::pair<int, uint32_t>> serial_to_index; // (serial, atom index)
+    std::vector<std::pair<int, int>> conect_pairs;          // Serial pairs from CONECT records
+    bool first_model_done = false;
+    std::string header_id;
+
+    while (reader.next(line_begin, line_end)) {
+        bool is_atom = record_is(line_begin, line_end, "ATOM  ");
+        bool is_hetatm = record_is(line_begin, line_end, "HETATM");
+        if (is_atom || is_hetatm) {
+            if (first_model_done) continue;
+            const char* alt_loc = line_begin + 16;
+            if (alt_loc < line_end && *alt_loc != ' ' && *alt_loc != 'A' && *alt_loc != '1') continue;
+
+            float x, y, z;
+            if (!parse_column_float(line_begin, line_end, 31, 38, x) ||
+                !parse_column_float(line_begin, line_end, 39, 46, y) ||
+                !parse_column_float(line_begin, line_end, 47, 54, z)) {
+                std::cerr << "PDB Parse Error (Line " << reader.line_number << "): Could not parse coordinates: "
+                          << std::string(line_begin, line_end) << std::endl;
+                return false;
+            }
+            int atomic_number = pdb_element(line_begin, line_end, is_hetatm);
+
+            float b_factor = 0.0f;
+            parse_column_float(line_begin, line_end, 61, 66, b_factor); // Optional column
+
+            const char* b;
+            const char* e;
+            Residue res;
+            column_field(line_begin, line_end, 18, 20, b, e);
+            copy_trimmed(b, e, res.name);
+            column_field(line_begin, line_end, 22, 22, b, e);
+            copy_trimmed(b, e, res.chain_id);
+            res.seq_num = 0;
+            parse_column_int(line_begin, line_end, 23, 26, res.seq_num);
+            res.insertion_code = (line_begin + 26 < line_end) ? line_begin[26] : ' ';
+            res.hetero = is_hetatm;
+
+            uint32_t atom_index = static_cast<uint32_t>(out.atoms.size());
+            bool same_residue = !info.residues.empty();
+            if (same_residue) {
+                const Residue& last = info.residues.back();
+                same_residue = last.seq_num == res.seq_num && last.insertion_code == res.insertion_code &&
+                               last.hetero == res.hetero && std::memcmp(last.name, res.name, 4) == 0 &&
+                               std::memcmp(last.chain_id, res.chain_id, 4) == 0;
+            }
+            if (same_residue) {
+                info.residues.back().atom_count++;
+            } else {
+                res.first_atom = atom_index;
+                res.atom_count = 1;
+                info.residues.push_back(res);
+            }
+
+            char name[5];
+            column_field(line_begin, line_end, 13, 16, b, e);
+            copy_trimmed(b, e, name);
+            info.atom_names.push_back({{name[0], name[1], name[2], name[3]}});
+            info.b_factors.push_back(b_factor);
+
+            int serial = 0;
+            if (parse_column_int(line_begin, line_end, 7, 11, serial)) serial_to_index.push_back({serial, atom_index});
+            out.atoms.push_back(x, y, z, atomic_number);
+        } else if (record_is(line_begin, line_end, "CONECT")) {
+            int from = 0;
+            if (!parse_column_int(line_begin, line_end, 7, 11, from)) continue;
+            for (int col = 12; col <= 27; col += 5) {
+                int to = 0;
+                if (parse_column_int(line_begin, line_end, col, col + 4, to)) conect_pairs.push_back({from, to});
+            }
+        } else if (record_is(line_begin, line_end, "ENDMDL")) {
+            first_model_done = true; // Only the first model of an NMR ensemble is loaded
+        } else if (record_is(line_begin, line_end, "TITLE ") && out.name.empty()) {
+            const char* b;
+            const char* e;
+            column_field(line_begin, line_end, 11, 80, b, e);
+            b = skip_blanks(b, e);
+            while (e > b && is_blank(e[-1])) --e;
+            out.name.assign(b, e);
+        } else if (record_is(line_begin, line_end, "HEADER")) {
+            const char* b;
+            const char* e;
+            column_field(line_begin, line_end, 63, 66, b, e);
+            b = skip_blanks(b, e);
+            while (e > b && is_blank(e[-1])) --e;
+            header_id.assign(b, e);
+        }
+    }
+
+    if (out.atoms.empty()) {
+        std::cerr << "PDB Parse Error: No ATOM or HETATM records found." << std::endl;
+        return false;
+    }
+    if (out.name.empty()) out.name = header_id.empty() ? "Untitled Structure" : header_id;
+
+    // Resolve CONECT serials to atom indices
+    std::sort(serial_to_index.begin(), serial_to_index.end());
+    auto lookup = [&](int serial) -> long {
+        auto it = std::lower_bound(serial_to_index.begin(), serial_to_index.end(), std::make_pair(serial, 0u));
+        return (it != serial_to_index.end() && it->first == serial) ? static_cast<long>(it->second) : -1;
+    };
+    std::vector<Bond> explicit_bonds;
+    explicit_bonds.reserve(conect_pairs.size());
+    for (const auto& pair : conect_pairs) {
+        long i = lookup(pair.first);
+        long j = lookup(pair.second);
+        if (i >= 0 && j >= 0 && i != j) explicit_bonds.push_back({static_cast<size_t>(i), static_cast<size_t>(j), 1});
+    }
+
+    build_structure_bonds(out, explicit_bonds);
+    return true;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+#include "molecule.h"
+
+// Parses ATOM/HETATM records of the first model into out, filling out.structure with residue,
+// chain and B-factor data. Bonds come from CONECT records and residue templates (see
+// build_structure_bonds) instead of a global distance search. Only the first alternate
+// location of each atom is kept.
+bool parse_pdb(const char* data, size_t length, Molecule& out);
@@ -1,8 +1,19 @@
 #include "renderer.h"
 #include "geometry.h"
 #include "input.h"
+#include "trajectory.h"
+#include "shader.h"
+#include "bvh.h"
+#include "surface_atoms.h"
+#include "parallel.h"
+#include "loader.h"
 #include <iostream>
 #include <algorithm>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <string>
 
 // Appearance Settings
 float g_atom_display_scale_factor = 0.65f; // Default atom scale factor
@@ -17,128 +28,715 @@ const float DOUBLE_BOND_OFFSET_FACTOR = 1.0f;         // Increased offset from 0
 const float TRIPLE_BOND_CYLINDER_RADIUS_SCALE = 0.33f; // Each cylinder in a triple bond is X% of main bond_radius
 const float TRIPLE_BOND_OFFSET_FACTOR = 1.34f;        // Increased offset from 0.67f (approx doubled)
 
-// Global WebGL context, shader program, matrices, and uniform locations
+// Global WebGL context, shader programs and matrices
 EMSCRIPTEN_WEBGL_CONTEXT_HANDLE gl_context = 0;
-GLuint shader_program = 0;
-GLint position_attribute_location = -1;
-GLint normal_attribute_location = -1; // Added for normals
 
 Mat4 projection_matrix;
 Mat4 view_matrix;
 
-GLint u_model_matrix_loc = -1;
-GLint u_view_matrix_loc = -1;
-GLint u_projection_matrix_loc = -1;
-GLint u_color_loc = -1;
-GLint u_normal_matrix_loc = -1; // For transforming normals
+ShaderProgram sphere_instance_program;
+ShaderProgram cylinder_instance_program;
+ShaderProgram sphere_impostor_program;
+ShaderProgram cylinder_impostor_program;
+ShaderProgram surface_program;
+
+GLuint frame_uniform_buffer = 0;
+GLuint material_uniform_buffer = 0;
 
 // VAO/VBO for the sphere mesh
 GLuint sphere_vao = 0;
 GLuint sphere_vbo_vertices = 0; // For vertex data (pos, norm)
 GLuint sphere_vbo_indices = 0;  // For index data
+GLuint sphere_vbo_instances = 0; // 7 floats per atom: center xyz, radius, color rgb
+GLsizei atom_instance_count = 0;
 
 // VAO/VBO for the cylinder mesh
 GLuint cylinder_vao = 0;
 GLuint cylinder_vbo_vertices = 0;
 GLuint cylinder_vbo_indices = 0;
+GLuint cylinder_vbo_instances = 0; // 10 floats per cylinder: start xyz, radius, color rgb, end xyz
+GLsizei bond_instance_count = 0;
+
+// Impostor quads share the instance buffers above
+GLuint impostor_quad_vbo = 0;
+GLuint sphere_impostor_vao = 0;
+GLuint cylinder_impostor_vao = 0;
+
+// VAO/VBO for the molecular surface mesh
+GLuint surface_vao = 0;
+GLuint surface_vbo_vertices = 0; // SurfaceVertex: position, packed normal, RGBA8 color
+GLuint surface_vbo_indices = 0;
+GLsizei surface_index_count = 0;
+SurfaceParameters surface_parameters;
+
+static bool instances_dirty = true;
+
+// CPU copies of the instance data in molecule order (7 floats per sphere, 10 per cylinder)
+static std::vector<float> atom_instance_data;
+static std::vector<float> bond_instance_data;
+
+// BVH over the displayed atom spheres for frustum culling and picking. Rebuilt when the atom
+// set changes, refit when atoms only move or change size.
+static AtomBvh atom_bvh;
+static bool atom_bvh_needs_build = true;
+static std::vector<float> atom_display_radii; // Per atom, matches the instance radius
+static std::vector<uint32_t> visible_atoms;
+static std::vector<uint32_t> visible_bonds;
+static long hovered_atom = -1;
+
+// SpaceFill only: atoms enclosed by their neighbors' spheres, left out of every draw. Empty
+// when no filtering applies.
+static std::vector<uint8_t> buried_atoms;
+static size_t buried_atom_count = 0;
+static bool buried_atoms_stale = true;
+
+// Surface only: the mesh is kept across representation changes and rebuilt when atoms move or
+// the surface settings change
+static SurfaceMesh surface_mesh;
+static bool surface_stale = true;
+// Set while coordinates arrive through update_atom_positions; cleared once the stream goes idle
+static bool coordinates_streaming = false;
+static double last_stream_time = 0.0;
+const double STREAM_IDLE_SECONDS = 0.5;
+// While coordinates stream in, the surface is rebuilt at most this often rather than per frame
+const double STREAM_SURFACE_INTERVAL_SECONDS = 1.0;
+static double last_surface_build_time = 0.0;
+
+// Level of detail: instances are counting-sorted by projected radius into LOD buckets so each
+// bucket is one contiguous range of the instance buffer and one instanced draw.
+struct LodBuckets {
+    GLsizei first[LOD_LEVELS];
+    GLsizei count[LOD_LEVELS];
+};
+static LodBuckets atom_lod_buckets = {};
+static LodBuckets bond_lod_buckets = {};
+static bool lod_buckets_valid = false;
+static Mat4 lod_view_matrix;       // View the buckets were computed for
+static Mat4 lod_projection_matrix;
+static int viewport_width = 600;
+static int viewport_height = 400;
+
+// Projected radius in pixels at or above which each LOD is chosen; anything smaller falls
+// through to the coarsest level
+static const float SPHERE_LOD_MIN_PIXELS[LOD_LEVELS] = {24.0f, 8.0f, 3.0f, 0.0f};
+static const float CYLINDER_LOD_MIN_PIXELS[LOD_LEVELS] = {6.0f, 3.0f, 1.5f, 0.0f};
+
+// Supercell replication of periodic structures. Every atom and bond instance is drawn once per
+// image of the unit cell: the instance attributes advance only every cell_image_count()
+// instances and the vertex shaders add the image's lattice translation from FrameUniforms, so
+// instance data and buffers stay the size of one cell however many cells are shown.
+const int MAX_CELL_IMAGES = 10; // Per axis
+static int requested_cell_images[3] = {1, 1, 1};
+static GLuint applied_instance_divisor = 1;
+
+// Frames are only drawn after something requested a redraw; the canvas keeps the last image
+static bool redraw_requested = true;
+static double rendered_frame_count = 0.0;
+static double skipped_frame_count = 0.0;
+
+// Triangles submitted in the last frame, and what the same instances cost at full detail
+static double frame_triangle_count = 0.0;
+static double frame_full_detail_triangle_count = 0.0;
+
+// GL calls issued while drawing a frame, counted by wrapping each call on the draw path
+static int frame_gl_call_count = 0;
+#define COUNT_GL(call) (++frame_gl_call_count, call)
+
+// Shading per representation, uploaded to the MaterialUniforms block when the representation changes.
+// Indexed by Representation.
+static const MaterialUniforms REPRESENTATION_MATERIALS[4] = {
+    {0.25f, 1.0f, {0.0f, 0.0f}}, // BallAndStick
+    {0.25f, 1.0f, {0.0f, 0.0f}}, // SpaceFill
+    {0.25f, 1.0f, {0.0f, 0.0f}}, // Licorice
+    {0.3f, 0.9f, {0.0f, 0.0f}},  // Surface: a little more ambient for the crevices
+};
+static int uploaded_material = -1;
+static const Vec3 LIGHT_DIRECTION_WORLD = Vec3(0.5f, 0.8f, 1.0f).normalize();
 
 Molecule current_molecule; // Store the molecule globally for rendering
 Representation current_representation = Representation::BallAndStick;
+RenderMode current_render_mode = RenderMode::Mesh;
+
+// Images along a, b and c for the current molecule; always 1 along non-periodic axes
+static void cell_image_counts(int (&counts)[3]) {
+    for (int k = 0; k < 3; ++k) counts[k] = current_molecule.cell.pbc[k] ? requested_cell_images[k] : 1;
+}
+
+static int cell_image_count() {
+    int counts[3];
+    cell_image_counts(counts);
+    return counts[0] * counts[1] * counts[2];
+}
+
+// Lattice translations of the images, numbered like the shaders number them (a fastest). Each
+// axis runs from -(n - 1) / 2, so the original cell is always one of them.
+static void cell_image_translations(std::vector<Vec3>& translations) {
+    int n[3];
+    cell_image_counts(n);
+    translations.clear();
+    for (int c = 0; c < n[2]; ++c) {
+        for (int b = 0; b < n[1]; ++b) {
+            for (int a = 0; a < n[0]; ++a) {
+                translations.push_back(current_molecule.cell.translation(a - (n[0] - 1) / 2, b - (n[1] - 1) / 2, c - (n[2] - 1) / 2));
+            }
+        }
+    }
+}
+
+// Points the per-instance attributes of the bound VAO at the bound GL_ARRAY_BUFFER, starting at
+// first_instance. Cylinders (stride 10) also carry an end point. Only the pointers change between
+// LOD buckets; enabling and divisors are VAO state set once by set_instance_attributes.
+static void point_instance_attributes(size_t stride_floats, size_t first_instance) {
+    const GLsizei stride = static_cast<GLsizei>(stride_floats * sizeof(float));
+    const size_t base = first_instance * stride_floats * sizeof(float);
+    COUNT_GL(glVertexAttribPointer(ATTRIB_INSTANCE_CENTER_RADIUS, 4, GL_FLOAT, GL_FALSE, stride, (void*)base));
+    COUNT_GL(glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 3, GL_FLOAT, GL_FALSE, stride, (void*)(base + 4 * sizeof(float))));
+    if (stride_floats == 10) {
+        COUNT_GL(glVertexAttribPointer(ATTRIB_INSTANCE_END, 3, GL_FLOAT, GL_FALSE, stride, (void*)(base + 7 * sizeof(float))));
+    }
+}
+
+static void set_instance_attributes(size_t stride_floats) {
+    point_instance_attributes(stride_floats, 0);
+    const GLuint attributes[3] = {ATTRIB_INSTANCE_CENTER_RADIUS, ATTRIB_INSTANCE_COLOR, ATTRIB_INSTANCE_END};
+    for (int a = 0; a < (stride_floats == 10 ? 3 : 2); ++a) {
+        glEnableVertexAttribArray(attributes[a]);
+        glVertexAttribDivisor(attributes[a], applied_instance_divisor);
+    }
+}
+
+// Makes the instance attributes of every instanced VAO advance once per `divisor` instances,
+// i.e. once per atom or bond when each is drawn for `divisor` cell images
+static void set_instance_divisor(GLuint divisor) {
+    const GLuint vaos[4] = {sphere_vao, sphere_impostor_vao, cylinder_vao, cylinder_impostor_vao};
+    for (int v = 0; v < 4; ++v) {
+        COUNT_GL(glBindVertexArray(vaos[v]));
+        COUNT_GL(glVertexAttribDivisor(ATTRIB_INSTANCE_CENTER_RADIUS, divisor));
+        COUNT_GL(glVertexAttribDivisor(ATTRIB_INSTANCE_COLOR, divisor));
+        if (v >= 2) COUNT_GL(glVertexAttribDivisor(ATTRIB_INSTANCE_END, divisor));
+    }
+    COUNT_GL(glBindVertexArray(0));
+    applied_instance_divisor = divisor;
+}
+
+// Points position and normal at the bound MeshVertex buffer. Normals are signed normalized
+// 2_10_10_10 and arrive in the shader as a unit vec3.
+static void set_mesh_attributes() {
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(ATTRIB_NORMAL);
+}
 
 void setup_sphere_geometry() {
-    create_uv_sphere(1.0f, 32, 32); // Create a unit sphere, will be scaled per atom
+    create_sphere_lods(SphereMeshType::Icosphere); // Unit spheres at every LOD, scaled per atom by the shader
 
     glGenVertexArrays(1, &sphere_vao);
     glBindVertexArray(sphere_vao);
 
     glGenBuffers(1, &sphere_vbo_vertices);
     glBindBuffer(GL_ARRAY_BUFFER, sphere_vbo_vertices);
-    glBufferData(GL_ARRAY_BUFFER, sphere_vertices.size() * sizeof(float), sphere_vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sphere_vertices.size() * sizeof(MeshVertex), sphere_vertices.data(), GL_STATIC_DRAW);
 
     glGenBuffers(1, &sphere_vbo_indices);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphere_vbo_indices);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphere_indices.size() * sizeof(unsigned int), sphere_indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphere_indices.size() * sizeof(uint16_t), sphere_indices.data(), GL_STATIC_DRAW);
+
+    set_mesh_attributes();
+
+    // Per-instance attributes, filled with the visible atoms by sort_instances_by_lod()
+    glGenBuffers(1, &sphere_vbo_instances);
+    glBindBuffer(GL_ARRAY_BUFFER, sphere_vbo_instances);
+    set_instance_attributes(7);
+    glBindVertexArray(0); // Unbind VAO
+}
+
+static void bind_impostor_quad(GLuint& vao) {
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, impostor_quad_vbo);
+    glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+}
+
+// Must run after setup_sphere_geometry and setup_cylinder_geometry, whose instance buffers
+// these VAOs read
+void setup_impostor_geometry() {
+    const float corners[8] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f}; // Triangle strip
+    glGenBuffers(1, &impostor_quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, impostor_quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    bind_impostor_quad(sphere_impostor_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, sphere_vbo_instances);
+    set_instance_attributes(7);
+
+    bind_impostor_quad(cylinder_impostor_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, cylinder_vbo_instances);
+    set_instance_attributes(10);
+    glBindVertexArray(0);
+}
+
+void setup_surface_geometry() {
+    glGenVertexArrays(1, &surface_vao);
+    glBindVertexArray(surface_vao);
+    glGenBuffers(1, &surface_vbo_vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, surface_vbo_vertices);
+    glGenBuffers(1, &surface_vbo_indices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface_vbo_indices);
+
+    const GLsizei stride = sizeof(SurfaceVertex);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SurfaceVertex, position));
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(SurfaceVertex, normal));
+    glEnableVertexAttribArray(ATTRIB_NORMAL);
+    glVertexAttribPointer(ATTRIB_VERTEX_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(SurfaceVertex, color));
+    glEnableVertexAttribArray(ATTRIB_VERTEX_COLOR);
+    glBindVertexArray(0);
+}
+
+void setup_uniform_buffers() {
+    glGenBuffers(1, &frame_uniform_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frame_uniform_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frame_uniform_buffer);
+
+    glGenBuffers(1, &material_uniform_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, material_uniform_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(MaterialUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_UNIFORM_BINDING, material_uniform_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploaded_material = -1;
+}
 
-    // Vertex positions
-    if (position_attribute_location != -1) {
-        glVertexAttribPointer(position_attribute_location, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(position_attribute_location);
+// Camera and light for every program in one upload, replacing per-program glUniform calls
+static void upload_frame_uniforms() {
+    FrameUniforms frame;
+    std::memcpy(frame.view, view_matrix.m, sizeof(frame.view));
+    std::memcpy(frame.projection, projection_matrix.m, sizeof(frame.projection));
+    std::memcpy(frame.view_projection, (projection_matrix * view_matrix).m, sizeof(frame.view_projection));
+    const Vec3& l = LIGHT_DIRECTION_WORLD;
+    const float* v = view_matrix.m;
+    Vec3 light_view = Vec3(v[0] * l.x + v[4] * l.y + v[8] * l.z, v[1] * l.x + v[5] * l.y + v[9] * l.z,
+                           v[2] * l.x + v[6] * l.y + v[10] * l.z).normalize();
+    const float light_world[4] = {l.x, l.y, l.z, 0.0f};
+    const float light_view_4[4] = {light_view.x, light_view.y, light_view.z, 0.0f};
+    std::memcpy(frame.light_dir_world, light_world, sizeof(light_world));
+    std::memcpy(frame.light_dir_view, light_view_4, sizeof(light_view_4));
+    int images[3];
+    cell_image_counts(images);
+    for (int k = 0; k < 3; ++k) {
+        const Vec3& v = current_molecule.cell.vector(k);
+        const float cell_vector[4] = {v.x, v.y, v.z, static_cast<float>(images[k])};
+        std::memcpy(frame.cell[k], cell_vector, sizeof(cell_vector));
     }
-    // Vertex normals
-    if (normal_attribute_location != -1) {
-        glVertexAttribPointer(normal_attribute_location, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(normal_attribute_location);
+    COUNT_GL(glBindBuffer(GL_UNIFORM_BUFFER, frame_uniform_buffer));
+    COUNT_GL(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame), &frame));
+
+    int material = static_cast<int>(current_representation);
+    if (material != uploaded_material) {
+        COUNT_GL(glBindBuffer(GL_UNIFORM_BUFFER, material_uniform_buffer));
+        COUNT_GL(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(MaterialUniforms), &REPRESENTATION_MATERIALS[material]));
+        uploaded_material = material;
     }
-    glBindVertexArray(0); // Unbind VAO
+}
+
+float atom_display_radius(const ElementProperties& element, Representation representation, float scale) {
+    float base_radius = element.covalent_radius;
+    if (representation == Representation::SpaceFill || representation == Representation::Surface) {
+        base_radius = element.vdw_radius; // Surface: only used for picking
+    } else if (representation == Representation::Licorice) {
+        base_radius = element.covalent_radius * 0.25f; // Licorice atoms are small
+    }
+    return base_radius * scale;
+}
+
+float atom_display_radius(const ElementProperties& element, Representation representation) {
+    return atom_display_radius(element, representation, g_atom_display_scale_factor);
+}
+
+void request_redraw() {
+    redraw_requested = true;
+}
+
+void mark_instances_dirty() {
+    instances_dirty = true;
+    redraw_requested = true;
+    atom_bvh_needs_build = true;
+    buried_atoms_stale = true;
+    surface_stale = true;
+    hovered_atom = -1;
+}
+
+// Display radii or bond sizes changed but no atom moved, so the molecular surface stays valid
+static void mark_display_sizes_dirty() {
+    instances_dirty = true;
+    redraw_requested = true;
+    buried_atoms_stale = true;
+}
+
+void mark_atom_coordinates_dirty() {
+    mark_display_sizes_dirty();
+    surface_stale = true;
+}
+
+void mark_atom_coordinates_streamed() {
+    mark_atom_coordinates_dirty();
+    coordinates_streaming = true;
+    last_stream_time = emscripten_get_now() / 1000.0;
+}
+
+// Recomputes the buried-atom mask after the atoms, the representation or the atom scale changed.
+// While a trajectory plays or coordinates stream in the pass would rerun every frame, so all
+// atoms are drawn instead.
+static void update_buried_atoms() {
+    if (current_representation != Representation::SpaceFill || current_trajectory.playing || coordinates_streaming) {
+        buried_atoms.clear();
+        buried_atom_count = 0;
+        buried_atoms_stale = true;
+        return;
+    }
+    if (!buried_atoms_stale) return;
+    double start = emscripten_get_now();
+    buried_atom_count = find_buried_atoms(current_molecule.atoms, atom_display_radii, buried_atoms);
+    buried_atoms_stale = false;
+    std::cout << "C++: SpaceFill: " << buried_atom_count << " of " << current_molecule.atoms.size()
+              << " atoms are buried and skipped (" << emscripten_get_now() - start << " ms on "
+              << worker_thread_count() << " thread(s))." << std::endl;
+}
+
+// Rebuilds the surface mesh in the Surface representation once something marked it stale.
+// Trajectory frames move the atoms, so playback rebuilds it every frame. Streamed coordinates
+// can arrive every frame for as long as a simulation runs, so meanwhile the last mesh stays up
+// and is rebuilt at most once per STREAM_SURFACE_INTERVAL_SECONDS; it is stale when the stream
+// goes idle and catches up then.
+static void update_molecular_surface() {
+    if (current_representation != Representation::Surface || !surface_stale) return;
+    double start = emscripten_get_now();
+    if (coordinates_streaming && !surface_mesh.vertices.empty() &&
+        start / 1000.0 - last_surface_build_time < STREAM_SURFACE_INTERVAL_SECONDS) {
+        return;
+    }
+    build_molecular_surface(current_molecule.atoms, surface_parameters, surface_mesh);
+    surface_stale = false;
+    last_surface_build_time = emscripten_get_now() / 1000.0;
+    surface_index_count = static_cast<GLsizei>(surface_mesh.indices.size());
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, surface_vbo_vertices));
+    COUNT_GL(glBufferData(GL_ARRAY_BUFFER, surface_mesh.vertices.size() * sizeof(SurfaceVertex), surface_mesh.vertices.data(), GL_DYNAMIC_DRAW));
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    COUNT_GL(glBindVertexArray(0)); // The element buffer binding is VAO state
+    COUNT_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface_vbo_indices));
+    COUNT_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, surface_mesh.indices.size() * sizeof(uint32_t), surface_mesh.indices.data(), GL_DYNAMIC_DRAW));
+    COUNT_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    std::cout << "C++: " << (surface_parameters.type == SurfaceType::SolventExcluded ? "SES" : "SAS") << " surface: "
+              << surface_mesh.vertices.size() << " vertices, " << surface_index_count / 3 << " triangles on a "
+              << surface_mesh.grid_dims[0] << "x" << surface_mesh.grid_dims[1] << "x" << surface_mesh.grid_dims[2]
+              << " grid (" << surface_mesh.grid_spacing << " A) in " << emscripten_get_now() - start << " ms on "
+              << worker_thread_count() << " thread(s)." << std::endl;
+}
+
+// Sphere instances and display radii for the given settings. Reads no renderer state, so the
+// background loader can run it for a molecule that is not displayed yet.
+static void fill_atom_instances(const AtomArrays& atoms, Representation representation, float scale,
+                                std::vector<float>& instance_data, std::vector<float>& radii) {
+    instance_data.resize(atoms.size() * 7); // Reused between frames; no allocation once sized
+    radii.resize(atoms.size());
+    float* out = instance_data.data();
+    for (size_t i = 0; i < atoms.size(); ++i, out += 7) { // Instance i is atom i, so BVH results index both
+        const ElementProperties& element = atoms.properties(i);
+        float radius = atom_display_radius(element, representation, scale);
+        radii[i] = radius;
+        out[0] = atoms.x[i];
+        out[1] = atoms.y[i];
+        out[2] = atoms.z[i];
+        out[3] = radius;
+        out[4] = element.color.x;
+        out[5] = element.color.y;
+        out[6] = element.color.z;
+    }
+}
+
+// The CPU instance arrays are rebuilt from current_molecule in render_frame only when something
+// marked them dirty, so a static scene rebuilds nothing per frame. The GPU buffers receive only
+// the visible instances, in LOD order, from sort_instances_by_lod.
+void build_atom_instances() {
+    const AtomArrays& atoms = current_molecule.atoms;
+    fill_atom_instances(atoms, current_representation, g_atom_display_scale_factor, atom_instance_data, atom_display_radii);
+    atom_instance_count = static_cast<GLsizei>(atoms.size());
+
+    if (atom_bvh_needs_build || atom_bvh.atom_count() != atoms.size()) {
+        double start = emscripten_get_now();
+        atom_bvh.build(atoms, atom_display_radii);
+        atom_bvh_needs_build = false;
+        std::cout << "C++: Built BVH over " << atoms.size() << " atoms (" << atom_bvh.nodes.size() << " nodes) in "
+                  << emscripten_get_now() - start << " ms." << std::endl;
+    } else {
+        atom_bvh.refit(atoms, atom_display_radii);
+    }
+    update_buried_atoms();
+}
+
+static void append_cylinder(std::vector<float>& out, const Vec3& start, const Vec3& end, float radius, const Vec3& color) {
+    out.insert(out.end(), {start.x, start.y, start.z, radius, color.x, color.y, color.z, end.x, end.y, end.z});
+}
+
+// Bond cylinders are shortened to the displayed atom surfaces and double/triple bonds are
+// expanded into parallel cylinders here, so the shader only stretches a cylinder between two points.
+// Like fill_atom_instances, this reads nothing but its arguments and the constant bond_color.
+static void fill_bond_instances(const Molecule& mol, Representation representation, float atom_scale, float bond_radius,
+                                std::vector<float>& instance_data) {
+    const AtomArrays& atoms = mol.atoms;
+    instance_data.clear();
+    if (representation != Representation::SpaceFill && representation != Representation::Surface) {
+        instance_data.reserve(mol.bonds.size() * 10);
+        for (const auto& bond : mol.bonds) {
+            if (bond.atom1_idx >= atoms.size() || bond.atom2_idx >= atoms.size()) {
+                std::cerr << "Error: Invalid atom index in bond." << std::endl;
+                continue;
+            }
+            Vec3 p1 = atoms.position(bond.atom1_idx);
+            Vec3 p2 = atoms.position(bond.atom2_idx);
+            // A bond across a cell face runs from atom1 to an image of atom2: draw it as two
+            // halves, each from one atom out to the midpoint of the bond to the other's image
+            Vec3 translation = bond.crosses_cell() ? mol.cell.translation(bond.image) : Vec3();
+            p2 = p2 + translation;
+            float r1_shorten = std::max(atom_display_radius(atoms.properties(bond.atom1_idx), representation, atom_scale), 0.0f);
+            float r2_shorten = std::max(atom_display_radius(atoms.properties(bond.atom2_idx), representation, atom_scale), 0.0f);
+
+            Vec3 bond_vector = p2 - p1;
+            float distance_centers = bond_vector.length();
+            if (distance_centers < 1e-5) continue;
+            Vec3 bond_direction = bond_vector * (1.0f / distance_centers);
+            if (distance_centers - r1_shorten - r2_shorten <= 0.001f) continue;
+            Vec3 start = p1 + bond_direction * r1_shorten;
+            Vec3 end = p2 - bond_direction * r2_shorten;
+            if (bond.crosses_cell()) {
+                Vec3 middle = (start + end) * 0.5f;
+                append_cylinder(instance_data, start, middle, bond_radius, bond_color);
+                append_cylinder(instance_data, middle - translation, end - translation, bond_radius, bond_color);
+                continue; // Perceived bonds are single bonds
+            }
+
+            // Multiple bonds are offset sideways along the same perpendicular the shader uses
+            Vec3 ref = std::abs(bond_direction.y) < 0.99f ? Vec3(0, 1, 0) : Vec3(1, 0, 0);
+            Vec3 side = Vec3::cross(bond_direction, ref).normalize();
+
+            if (bond.order == 2) { // Double bond
+                float radius = bond_radius * DOUBLE_BOND_CYLINDER_RADIUS_SCALE;
+                Vec3 offset = side * (bond_radius * DOUBLE_BOND_OFFSET_FACTOR);
+                append_cylinder(instance_data, start + offset, end + offset, radius, bond_color);
+                append_cylinder(instance_data, start - offset, end - offset, radius, bond_color);
+            } else if (bond.order == 3) { // Triple bond
+                float radius = bond_radius * TRIPLE_BOND_CYLINDER_RADIUS_SCALE;
+                Vec3 offset = side * (bond_radius * TRIPLE_BOND_OFFSET_FACTOR);
+                append_cylinder(instance_data, start, end, radius, bond_color);
+                append_cylinder(instance_data, start + offset, end + offset, radius, bond_color);
+                append_cylinder(instance_data, start - offset, end - offset, radius, bond_color);
+            } else { // Single bond (or any other order defaults to single)
+                append_cylinder(instance_data, start, end, bond_radius, bond_color);
+            }
+        }
+    }
+}
+
+void build_bond_instances() {
+    fill_bond_instances(current_molecule, current_representation, g_atom_display_scale_factor, bond_radius_scale, bond_instance_data);
+    bond_instance_count = static_cast<GLsizei>(bond_instance_data.size() / 10);
+}
+
+void prepare_instances(const Molecule& mol, PreparedInstances& out) {
+    fill_atom_instances(mol.atoms, out.representation, out.atom_scale, out.atom_data, out.atom_radii);
+    fill_bond_instances(mol, out.representation, out.atom_scale, out.bond_radius, out.bond_data);
+    out.bvh.build(mol.atoms, out.atom_radii);
+    out.buried_count = 0;
+    out.buried.clear();
+    if (out.representation == Representation::SpaceFill) {
+        out.buried_count = find_buried_atoms(mol.atoms, out.atom_radii, out.buried);
+    }
+}
+
+PreparedInstances current_instance_settings() {
+    PreparedInstances settings;
+    settings.representation = current_representation;
+    settings.atom_scale = g_atom_display_scale_factor;
+    settings.bond_radius = bond_radius_scale;
+    return settings;
+}
+
+void adopt_prepared_instances(PreparedInstances& prepared) {
+    mark_instances_dirty();
+    coordinates_streaming = false;
+    // Settings changed while the load ran: keep the dirty flags and rebuild from current_molecule
+    if (prepared.representation != current_representation || prepared.atom_scale != g_atom_display_scale_factor ||
+        prepared.bond_radius != bond_radius_scale || prepared.atom_radii.size() != current_molecule.atoms.size()) {
+        return;
+    }
+    std::swap(atom_instance_data, prepared.atom_data);
+    std::swap(atom_display_radii, prepared.atom_radii);
+    std::swap(bond_instance_data, prepared.bond_data);
+    std::swap(atom_bvh, prepared.bvh);
+    std::swap(buried_atoms, prepared.buried);
+    buried_atom_count = prepared.buried_count;
+    buried_atoms_stale = current_representation != Representation::SpaceFill;
+    atom_instance_count = static_cast<GLsizei>(current_molecule.atoms.size());
+    bond_instance_count = static_cast<GLsizei>(bond_instance_data.size() / 10);
+    atom_bvh_needs_build = false;
+    instances_dirty = false;
+    lod_buckets_valid = false;
 }
 
 void setup_cylinder_geometry() {
-    create_cylinder_mesh(1.0f, 1.0f, 16); // Unit cylinder: radius 1, height 1, 16 segments
+    create_cylinder_lods(); // Unit cylinders (radius 1, height 1) at every LOD
 
     glGenVertexArrays(1, &cylinder_vao);
     glBindVertexArray(cylinder_vao);
 
     glGenBuffers(1, &cylinder_vbo_vertices);
     glBindBuffer(GL_ARRAY_BUFFER, cylinder_vbo_vertices);
-    glBufferData(GL_ARRAY_BUFFER, cylinder_vertices.size() * sizeof(float), cylinder_vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, cylinder_vertices.size() * sizeof(MeshVertex), cylinder_vertices.data(), GL_STATIC_DRAW);
 
     glGenBuffers(1, &cylinder_vbo_indices);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinder_vbo_indices);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cylinder_indices.size() * sizeof(unsigned int), cylinder_indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cylinder_indices.size() * sizeof(uint16_t), cylinder_indices.data(), GL_STATIC_DRAW);
 
-    if (position_attribute_location != -1) {
-        glVertexAttribPointer(position_attribute_location, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(position_attribute_location);
-    }
-    if (normal_attribute_location != -1) {
-        glVertexAttribPointer(normal_attribute_location, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(normal_attribute_location);
-    }
+    set_mesh_attributes();
+
+    // Per-instance attributes, filled with the visible bonds by sort_instances_by_lod()
+    glGenBuffers(1, &cylinder_vbo_instances);
+    glBindBuffer(GL_ARRAY_BUFFER, cylinder_vbo_instances);
+    set_instance_attributes(10);
     glBindVertexArray(0);
 }
 
-// Helper function to create rotation matrix to align Y-axis with a given direction vector
-Mat4 align_yaxis_to_vector(const Vec3& target_dir_normalized) {
-    Vec3 y_axis(0, 1, 0);
-    Vec3 rotation_axis = Vec3::cross(y_axis, target_dir_normalized);
-    float rotation_angle = std::acos(Vec3::dot(y_axis, target_dir_normalized));
-    Mat4 rotation_matrix = Mat4::identity();
-    if (std::abs(Vec3::dot(y_axis, target_dir_normalized)) > 0.9999f) { 
-        if (Vec3::dot(y_axis, target_dir_normalized) < 0) { 
-            Mat4 rotX180 = Mat4::identity();
-            rotX180.m[5] = -1.0f; rotX180.m[10] = -1.0f; 
-            return rotX180;
+// Bonds are few per atom, so they are culled by their bounding spheres without a hierarchy
+static void cull_cylinders(const Frustum& frustum, const std::vector<float>& data, std::vector<uint32_t>& visible) {
+    const size_t n = data.size() / 10;
+    for (size_t i = 0; i < n; ++i) {
+        const float* c = &data[i * 10];
+        float dx = c[7] - c[0], dy = c[8] - c[1], dz = c[9] - c[2];
+        float bound = 0.5f * std::sqrt(dx * dx + dy * dy + dz * dz) + c[3];
+        if (!frustum.sphere_outside(c[0] + 0.5f * dx, c[1] + 0.5f * dy, c[2] + 0.5f * dz, bound)) {
+            visible.push_back(static_cast<uint32_t>(i));
         }
-        return Mat4::identity(); 
     }
-    if (rotation_axis.length() < 1e-6) return Mat4::identity(); // Should be caught by above, but safety.
-    rotation_axis = rotation_axis.normalize();
-    float c = std::cos(rotation_angle);
-    float s = std::sin(rotation_angle);
-    float t = 1.0f - c;
-    float x = rotation_axis.x, y = rotation_axis.y, z = rotation_axis.z;
-    rotation_matrix.m[0] = t*x*x + c;   rotation_matrix.m[4] = t*x*y - s*z; rotation_matrix.m[8] = t*x*z + s*y;
-    rotation_matrix.m[1] = t*x*y + s*z; rotation_matrix.m[5] = t*y*y + c;   rotation_matrix.m[9] = t*y*z - s*x;
-    rotation_matrix.m[2] = t*x*z - s*y; rotation_matrix.m[6] = t*y*z + s*x; rotation_matrix.m[10] = t*z*z + c;
-    return rotation_matrix;
 }
 
-// Helper to draw a single cylinder given its complete model matrix
-// (Internal helper for render_frame's bond drawing loop)
-void draw_one_cylinder_internal(const Mat4& model_matrix_bond) {
-    glUniformMatrix4fv(u_model_matrix_loc, 1, GL_FALSE, model_matrix_bond.m);
+// Assigns every visible instance a LOD from its projected radius and uploads them grouped by
+// LOD; culled instances are left out. Cylinders are measured at their midpoint. With several
+// cell images, each instance is measured at its image nearest to the eye.
+static void sort_instances_by_lod(const std::vector<float>& data, size_t stride, const std::vector<uint32_t>& visible,
+                                  const std::vector<Vec3>& images, const float* min_pixels, GLuint vbo, LodBuckets& buckets) {
+    static std::vector<uint8_t> levels;
+    static std::vector<float> sorted;
+    const size_t n = visible.size();
+    const float* v = view_matrix.m;
+    const float pixels_per_unit = projection_matrix.m[5] * 0.5f * viewport_height; // At view depth 1
+    float image_depth = 0.0f; // Depth of the nearest image relative to the instance itself
+    for (const Vec3& t : images) image_depth = std::min(image_depth, -(v[2] * t.x + v[6] * t.y + v[10] * t.z));
+    const bool replicated = images.size() > 1;
+    levels.resize(n);
+    GLsizei counts[LOD_LEVELS] = {};
+    for (size_t i = 0; i < n; ++i) {
+        const float* instance = &data[visible[i] * stride];
+        float cx = instance[0], cy = instance[1], cz = instance[2];
+        if (stride == 10) {
+            cx = 0.5f * (cx + instance[7]);
+            cy = 0.5f * (cy + instance[8]);
+            cz = 0.5f * (cz + instance[9]);
+        }
+        float depth = -(v[2] * cx + v[6] * cy + v[10] * cz + v[14]) + image_depth;
+        // Behind the eye: coarsest, unless another image may be just in front of it
+        float pixels = depth > 1e-3f ? instance[3] * pixels_per_unit / depth : (replicated ? min_pixels[0] : 0.0f);
+        int level = 0;
+        while (level < LOD_LEVELS - 1 && pixels < min_pixels[level]) ++level;
+        levels[i] = static_cast<uint8_t>(level);
+        ++counts[level];
+    }
 
-    // Calculate and set normal matrix
-    Mat4 model_inv_bond = model_matrix_bond.affineInverse(); // Potential performance consideration for many calls
-    Mat4 normal_matrix_m4_bond = model_inv_bond.transpose();
-    Mat3 normal_matrix_m3_bond = normal_matrix_m4_bond.toMat3();
-    glUniformMatrix3fv(u_normal_matrix_loc, 1, GL_FALSE, normal_matrix_m3_bond.m);
+    GLsizei cursor[LOD_LEVELS];
+    GLsizei first = 0;
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        buckets.first[level] = cursor[level] = first;
+        buckets.count[level] = counts[level];
+        first += counts[level];
+    }
+    sorted.resize(n * stride);
+    for (size_t i = 0; i < n; ++i) {
+        const float* instance = &data[visible[i] * stride];
+        std::copy(instance, instance + stride, &sorted[cursor[levels[i]]++ * stride]);
+    }
+    // Respecifying the whole store orphans the old one: draws still reading it keep their copy and
+    // this upload never waits for them, which matters when coordinates stream in every frame
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    COUNT_GL(glBufferData(GL_ARRAY_BUFFER, sorted.size() * sizeof(float), sorted.data(), GL_STREAM_DRAW));
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+// One instanced draw per non-empty LOD bucket, re-pointing the instance attributes at the bucket.
+// Each instance is drawn `images` times, once per cell image.
+static void draw_lod_buckets(GLuint vao, GLuint vbo, size_t stride, const MeshLod* lods, const LodBuckets& buckets, GLsizei images) {
+    COUNT_GL(glBindVertexArray(vao));
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        if (buckets.count[level] == 0) continue;
+        point_instance_attributes(stride, buckets.first[level]);
+        COUNT_GL(glDrawElementsInstanced(GL_TRIANGLES, lods[level].index_count, GL_UNSIGNED_SHORT,
+                                         (void*)(lods[level].first_index * sizeof(uint16_t)), buckets.count[level] * images));
+        frame_triangle_count += static_cast<double>(lods[level].index_count / 3) * buckets.count[level] * images;
+    }
+    COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
 
-    glDrawElements(GL_TRIANGLES, cylinder_index_count, GL_UNSIGNED_INT, 0);
+// Ray through a canvas point given in CSS pixels, from the last frame's camera
+static void camera_ray(float css_x, float css_y, Vec3& origin, Vec3& direction) {
+    double css_width = 0.0, css_height = 0.0;
+    if (emscripten_get_element_css_size("#canvas", &css_width, &css_height) != EMSCRIPTEN_RESULT_SUCCESS || css_width <= 0.0) {
+        css_width = viewport_width;
+        css_height = viewport_height;
+    }
+    float ndc_x = 2.0f * css_x / static_cast<float>(css_width) - 1.0f;
+    float ndc_y = 1.0f - 2.0f * css_y / static_cast<float>(css_height);
+    // The view matrix is a rotation R and translation t: world = R^T * (view - t)
+    const float* m = view_matrix.m;
+    Vec3 view_dir(ndc_x / projection_matrix.m[0], ndc_y / projection_matrix.m[5], -1.0f);
+    Vec3 col_x(m[0], m[4], m[8]), col_y(m[1], m[5], m[9]), col_z(m[2], m[6], m[10]);
+    direction = (col_x * view_dir.x + col_y * view_dir.y + col_z * view_dir.z).normalize();
+    origin = (col_x * m[12] + col_y * m[13] + col_z * m[14]) * -1.0f;
+}
+
+long pick_atom_at(float css_x, float css_y) {
+    if (atom_bvh.atom_count() != current_molecule.atoms.size()) return -1; // Not built for this molecule yet
+    Vec3 origin, direction;
+    camera_ray(css_x, css_y, origin, direction);
+    std::vector<Vec3> images;
+    cell_image_translations(images);
+    if (images.size() == 1) return atom_bvh.pick(origin, direction, current_molecule.atoms, atom_display_radii);
+
+    // Each cell image is the original seen along the ray moved by -t; keep the nearest hit
+    long best = -1;
+    float best_distance = 0.0f;
+    for (const Vec3& t : images) {
+        const Vec3 image_origin = origin - t;
+        long hit = atom_bvh.pick(image_origin, direction, current_molecule.atoms, atom_display_radii);
+        if (hit < 0) continue;
+        Vec3 to_center = current_molecule.atoms.position(hit) - image_origin;
+        float along = Vec3::dot(to_center, direction);
+        float radius = atom_display_radii[hit];
+        float distance = along - std::sqrt(std::max(radius * radius - (Vec3::dot(to_center, to_center) - along * along), 0.0f));
+        if (best < 0 || distance < best_distance) {
+            best = hit;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+void update_hovered_atom(float css_x, float css_y) {
+    hovered_atom = pick_atom_at(css_x, css_y);
 }
 
 void render_frame() {
-    if (!gl_context || !shader_program) return;
+    if (!gl_context || !sphere_instance_program || !cylinder_instance_program) return;
 
     // Get current time for auto-rotation
     double current_time = emscripten_get_now() / 1000.0; // Convert to seconds
@@ -148,6 +746,19 @@ void render_frame() {
     double delta_time = current_time - last_frame_time;
     last_frame_time = current_time;
 
+    // A molecule finished loading in the background replaces the current one between frames
+    adopt_background_load();
+
+    // Advance trajectory playback before drawing
+    update_trajectory_playback(delta_time);
+
+    // Once streamed coordinates stop arriving, redraw once more so the buried-atom pass runs
+    // and a throttled surface catches up
+    if (coordinates_streaming && current_time - last_stream_time > STREAM_IDLE_SECONDS) {
+        coordinates_streaming = false;
+        mark_display_sizes_dirty();
+    }
+
     // Handle auto-rotation
     if (auto_rotate_enabled && !mouse_dragging) {
         camera_angle_y += auto_rotate_speed * delta_time;
@@ -155,12 +766,19 @@ void render_frame() {
         if (camera_angle_y > 2.0f * PI) {
             camera_angle_y -= 2.0f * PI;
         }
+        redraw_requested = true;
     }
 
-    glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (!redraw_requested) { // Nothing changed since the last drawn frame
+        skipped_frame_count += 1.0;
+        return;
+    }
+    redraw_requested = false;
+    rendered_frame_count += 1.0;
+    frame_gl_call_count = 0;
 
-    glUseProgram(shader_program);
+    COUNT_GL(glClearColor(0.1f, 0.1f, 0.2f, 1.0f));
+    COUNT_GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
     // Calculate view matrix based on camera angles and distance
     // Rotation around Y, then X, then translate out by distance
@@ -175,126 +793,97 @@ void render_frame() {
     float eye_z = camera_distance * std::cos(camera_angle_y) * std::cos(camera_angle_x);
 
     view_matrix = Mat4::lookAt(Vec3(eye_x, eye_y, eye_z), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+    upload_frame_uniforms();
 
-    glUniformMatrix4fv(u_view_matrix_loc, 1, GL_FALSE, view_matrix.m);
-    glUniformMatrix4fv(u_projection_matrix_loc, 1, GL_FALSE, projection_matrix.m);
-
-    // Draw Atoms
-    glBindVertexArray(sphere_vao);
-    for (const auto& atom : current_molecule.atoms) {
-        float base_radius = atom.covalent_radius; 
-        if (current_representation == Representation::SpaceFill) {
-            base_radius = atom.vdw_radius;
-        } else if (current_representation == Representation::Licorice) {
-            base_radius = atom.covalent_radius * 0.25f; // Licorice atoms are small
-        }
-        float display_radius = base_radius * g_atom_display_scale_factor;
-
-        // Ensure display_radius is not zero or negative to avoid scaling issues
-        if (display_radius <= 0.0f && current_representation != Representation::Licorice) display_radius = 0.01f; 
-        else if (display_radius <= 0.0f && current_representation == Representation::Licorice) {
-            // For licorice, if atoms are meant to be invisible, we could skip drawing them.
-            // For now, let's ensure a tiny non-zero radius if scaling makes it zero.
-            // Or, we could have a separate flag/check to not draw atoms in Licorice mode.
-            // Let's allow zero radius for licorice for now, effectively making atoms invisible.
-        }
+    // Draw Atoms and Bonds: one instanced call each (per LOD bucket in mesh mode)
+    if (instances_dirty) {
+        build_atom_instances();
+        build_bond_instances();
+        instances_dirty = false;
+        lod_buckets_valid = false;
+    }
+    update_molecular_surface();
 
-        if (display_radius > 0.0f) { // Only draw if radius is positive
-            Mat4 model_matrix_atom = Mat4::translate(Vec3(atom.x, atom.y, atom.z)) * Mat4::scale(Vec3(display_radius, display_radius, display_radius));
-            glUniformMatrix4fv(u_model_matrix_loc, 1, GL_FALSE, model_matrix_atom.m);
-            Mat4 model_inv_atom = model_matrix_atom.affineInverse();
-            Mat4 normal_matrix_m4_atom = model_inv_atom.transpose();
-            Mat3 normal_matrix_m3_atom = normal_matrix_m4_atom.toMat3();
-            glUniformMatrix3fv(u_normal_matrix_loc, 1, GL_FALSE, normal_matrix_m3_atom.m);
-            glUniform4f(u_color_loc, atom.color.x, atom.color.y, atom.color.z, 1.0f);
-            glDrawElements(GL_TRIANGLES, sphere_index_count, GL_UNSIGNED_INT, 0);
+    if (current_representation == Representation::Surface) {
+        frame_triangle_count = frame_full_detail_triangle_count = static_cast<double>(surface_index_count / 3);
+        if (surface_index_count > 0 && surface_program) {
+            COUNT_GL(glUseProgram(surface_program.program));
+            COUNT_GL(glBindVertexArray(surface_vao));
+            COUNT_GL(glDrawElements(GL_TRIANGLES, surface_index_count, GL_UNSIGNED_INT, (void*)0));
+            COUNT_GL(glBindVertexArray(0));
         }
+        return;
     }
-    glBindVertexArray(0);
-
-    // Draw Bonds
-    if (current_representation != Representation::SpaceFill && !current_molecule.bonds.empty() && cylinder_vao != 0) {
-        glBindVertexArray(cylinder_vao);
-        glUniform4f(u_color_loc, bond_color.x, bond_color.y, bond_color.z, 1.0f); 
+    const GLsizei image_count = cell_image_count();
+    if (static_cast<GLuint>(image_count) != applied_instance_divisor) set_instance_divisor(image_count);
+    frame_triangle_count = 0.0;
+    frame_full_detail_triangle_count = (static_cast<double>(sphere_lods[0].index_count / 3) * atom_instance_count +
+                                        static_cast<double>(cylinder_lods[0].index_count / 3) * bond_instance_count) * image_count;
 
-        for (const auto& bond : current_molecule.bonds) {
-            if (bond.atom1_idx >= current_molecule.atoms.size() || bond.atom2_idx >= current_molecule.atoms.size()) {
-                std::cerr << "Error: Invalid atom index in bond." << std::endl;
-                continue;
-            }
-            const Atom& atom1 = current_molecule.atoms[bond.atom1_idx];
-            const Atom& atom2 = current_molecule.atoms[bond.atom2_idx];
-
-            Vec3 p1(atom1.x, atom1.y, atom1.z);
-            Vec3 p2(atom2.x, atom2.y, atom2.z);
-            
-            float r1_shorten, r2_shorten;
-            if (current_representation == Representation::Licorice) {
-                r1_shorten = (atom1.covalent_radius * 0.25f) * g_atom_display_scale_factor;
-                r2_shorten = (atom2.covalent_radius * 0.25f) * g_atom_display_scale_factor;
-                if ( (atom1.covalent_radius * 0.25f * g_atom_display_scale_factor) <= 0.0f) r1_shorten = 0.0f;
-                if ( (atom2.covalent_radius * 0.25f * g_atom_display_scale_factor) <= 0.0f) r2_shorten = 0.0f;
-            } else { // BallAndStick
-                r1_shorten = atom1.covalent_radius * g_atom_display_scale_factor;
-                r2_shorten = atom2.covalent_radius * g_atom_display_scale_factor;
+    // Cull and re-bucket only when the camera or the instances changed since the last pass
+    if (!lod_buckets_valid || std::memcmp(lod_view_matrix.m, view_matrix.m, sizeof(view_matrix.m)) != 0 ||
+        std::memcmp(lod_projection_matrix.m, projection_matrix.m, sizeof(projection_matrix.m)) != 0) {
+        // An instance is kept if any of its images is in view; one frustum per image, with the
+        // image's translation folded into the view-projection matrix
+        static std::vector<Vec3> images;
+        cell_image_translations(images);
+        const Mat4 view_projection = projection_matrix * view_matrix;
+        visible_atoms.clear();
+        visible_bonds.clear();
+        for (const Vec3& t : images) {
+            Frustum frustum = Frustum::from_matrix(view_projection * Mat4::translate(t));
+            atom_bvh.cull(frustum, current_molecule.atoms, atom_display_radii, visible_atoms);
+            cull_cylinders(frustum, bond_instance_data, visible_bonds);
+        }
+        if (images.size() > 1) {
+            for (std::vector<uint32_t>* visible : {&visible_atoms, &visible_bonds}) {
+                std::sort(visible->begin(), visible->end());
+                visible->erase(std::unique(visible->begin(), visible->end()), visible->end());
             }
+        }
+        if (buried_atom_count > 0) {
+            visible_atoms.erase(std::remove_if(visible_atoms.begin(), visible_atoms.end(),
+                                               [](uint32_t i) { return buried_atoms[i] != 0; }),
+                                visible_atoms.end());
+        }
+        sort_instances_by_lod(atom_instance_data, 7, visible_atoms, images, SPHERE_LOD_MIN_PIXELS, sphere_vbo_instances, atom_lod_buckets);
+        sort_instances_by_lod(bond_instance_data, 10, visible_bonds, images, CYLINDER_LOD_MIN_PIXELS, cylinder_vbo_instances, bond_lod_buckets);
+        lod_view_matrix = view_matrix;
+        lod_projection_matrix = projection_matrix;
+        lod_buckets_valid = true;
+    }
+    const GLsizei visible_atom_count = static_cast<GLsizei>(visible_atoms.size());
+    const GLsizei visible_bond_count = static_cast<GLsizei>(visible_bonds.size());
 
-            Vec3 bond_vector = p2 - p1;
-            float distance_centers = bond_vector.length();
-
-            if (distance_centers < 1e-5) continue; 
-            Vec3 bond_direction = bond_vector.normalize();
-
-            float cylinder_actual_length = distance_centers - r1_shorten - r2_shorten;
-
-            if (cylinder_actual_length <= 0.001f) continue; 
-
-            Vec3 cylinder_midpoint = p1 + bond_direction * (r1_shorten + cylinder_actual_length / 2.0f);
-            
-            Mat4 translation_to_midpoint = Mat4::translate(cylinder_midpoint);
-            Mat4 rotation_to_align = align_yaxis_to_vector(bond_direction);
-            Mat4 base_transform = translation_to_midpoint * rotation_to_align;
-
-            if (bond.order == 2) { // Double bond
-                float double_cyl_eff_radius = bond_radius_scale * DOUBLE_BOND_CYLINDER_RADIUS_SCALE;
-                float double_offset_dist = bond_radius_scale * DOUBLE_BOND_OFFSET_FACTOR;
-
-                Mat4 scale_double = Mat4::scale(Vec3(double_cyl_eff_radius, cylinder_actual_length, double_cyl_eff_radius));
-                
-                // Cylinder 1 (offset in local +X before rotation)
-                Mat4 model_dbl1 = base_transform * Mat4::translate(Vec3(double_offset_dist, 0, 0)) * scale_double;
-                draw_one_cylinder_internal(model_dbl1);
-
-                // Cylinder 2 (offset in local -X before rotation)
-                Mat4 model_dbl2 = base_transform * Mat4::translate(Vec3(-double_offset_dist, 0, 0)) * scale_double;
-                draw_one_cylinder_internal(model_dbl2);
-
-            } else if (bond.order == 3) { // Triple bond
-                float triple_cyl_eff_radius = bond_radius_scale * TRIPLE_BOND_CYLINDER_RADIUS_SCALE;
-                float triple_offset_dist = bond_radius_scale * TRIPLE_BOND_OFFSET_FACTOR;
-
-                Mat4 scale_triple = Mat4::scale(Vec3(triple_cyl_eff_radius, cylinder_actual_length, triple_cyl_eff_radius));
-
-                // Cylinder 1 (Center - no local offset)
-                Mat4 model_tpl1 = base_transform * scale_triple;
-                draw_one_cylinder_internal(model_tpl1);
-                
-                // Cylinder 2 (Offset in local +X before rotation)
-                Mat4 model_tpl2 = base_transform * Mat4::translate(Vec3(triple_offset_dist, 0, 0)) * scale_triple;
-                draw_one_cylinder_internal(model_tpl2);
-
-                // Cylinder 3 (Offset in local -X before rotation)
-                Mat4 model_tpl3 = base_transform * Mat4::translate(Vec3(-triple_offset_dist, 0, 0)) * scale_triple;
-                draw_one_cylinder_internal(model_tpl3);
-
-            } else { // Single bond (or any other order defaults to single)
-                Mat4 scale_single = Mat4::scale(Vec3(bond_radius_scale, cylinder_actual_length, bond_radius_scale));
-                Mat4 model_single = base_transform * scale_single;
-                draw_one_cylinder_internal(model_single);
-            }
+    if (current_render_mode == RenderMode::Impostor && sphere_impostor_program && cylinder_impostor_program) {
+        // Quads are built facing the eye, so their winding depends on the view; skip culling
+        COUNT_GL(glDisable(GL_CULL_FACE));
+        if (visible_atom_count > 0) { // Visible instances are packed at the front of the buffer
+            COUNT_GL(glUseProgram(sphere_impostor_program.program));
+            COUNT_GL(glBindVertexArray(sphere_impostor_vao));
+            COUNT_GL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, visible_atom_count * image_count));
+        }
+        if (visible_bond_count > 0) {
+            COUNT_GL(glUseProgram(cylinder_impostor_program.program));
+            COUNT_GL(glBindVertexArray(cylinder_impostor_vao));
+            COUNT_GL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, visible_bond_count * image_count));
         }
-        glBindVertexArray(0);
+        frame_triangle_count = 2.0 * (visible_atom_count + visible_bond_count) * image_count;
+        COUNT_GL(glEnable(GL_CULL_FACE));
+        COUNT_GL(glBindVertexArray(0));
+        return;
+    }
+
+    // Camera and lighting come from the uniform blocks, so switching programs needs no uniform calls
+    if (visible_atom_count > 0 && sphere_instance_program) {
+        COUNT_GL(glUseProgram(sphere_instance_program.program));
+        draw_lod_buckets(sphere_vao, sphere_vbo_instances, 7, sphere_lods, atom_lod_buckets, image_count);
+    }
+    if (visible_bond_count > 0 && cylinder_instance_program) {
+        COUNT_GL(glUseProgram(cylinder_instance_program.program));
+        draw_lod_buckets(cylinder_vao, cylinder_vbo_instances, 10, cylinder_lods, bond_lod_buckets, image_count);
     }
+    COUNT_GL(glBindVertexArray(0));
 }
 
 extern "C" {
@@ -302,6 +891,7 @@ EMSCRIPTEN_KEEPALIVE
 void set_atom_display_scale(float scale) {
     if (scale > 0.0f && scale < 10.0f) { // Basic validation for scale
         g_atom_display_scale_factor = scale;
+        mark_display_sizes_dirty();
         std::cout << "C++: Atom display scale set to " << g_atom_display_scale_factor << std::endl;
     } else {
         std::cerr << "C++: Invalid atom display scale value: " << scale << std::endl;
@@ -312,6 +902,7 @@ EMSCRIPTEN_KEEPALIVE
 void set_bond_radius_value(float radius) {
     if (radius > 0.0f) {
         bond_radius_scale = radius;
+        mark_display_sizes_dirty();
         std::cout << "C++: Bond radius scale set to " << bond_radius_scale << std::endl;
     } else {
         std::cerr << "C++: Invalid bond radius value: " << radius << std::endl;
@@ -328,6 +919,7 @@ void set_zoom_level(float zoom) {
         
         // Clamp to existing limits
         camera_distance = std::max(MIN_CAMERA_DISTANCE, std::min(MAX_CAMERA_DISTANCE, camera_distance));
+        request_redraw();
         
         std::cout << "C++: Zoom level set to " << zoom << " (camera distance: " << camera_distance << ")" << std::endl;
     } else {
@@ -338,24 +930,76 @@ void set_zoom_level(float zoom) {
 EMSCRIPTEN_KEEPALIVE
 void set_auto_rotate(int enabled) {
     auto_rotate_enabled = (enabled != 0);
+    request_redraw();
     std::cout << "C++: Auto-rotation " << (auto_rotate_enabled ? "enabled" : "disabled") << std::endl;
 }
 
 EMSCRIPTEN_KEEPALIVE
 void set_representation(int rep_value) {
-    if (rep_value >= 0 && rep_value < 3) { // Basic validation
+    if (rep_value >= 0 && rep_value < 4) { // Basic validation
         current_representation = static_cast<Representation>(rep_value);
+        mark_display_sizes_dirty();
         std::cout << "C++: Representation set to " << rep_value << std::endl;
     } else {
         std::cerr << "C++: Invalid representation value: " << rep_value << std::endl;
     }
 }
 
+EMSCRIPTEN_KEEPALIVE
+void set_render_mode(int mode_value) {
+    if (mode_value >= 0 && mode_value < 2) {
+        current_render_mode = static_cast<RenderMode>(mode_value);
+        request_redraw();
+        std::cout << "C++: Render mode set to " << (current_render_mode == RenderMode::Impostor ? "impostor" : "mesh") << std::endl;
+    } else {
+        std::cerr << "C++: Invalid render mode value: " << mode_value << std::endl;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_surface_type(int type_value) {
+    if (type_value >= 0 && type_value < 2) {
+        surface_parameters.type = static_cast<SurfaceType>(type_value);
+        surface_stale = true;
+        request_redraw();
+        std::cout << "C++: Surface type set to " << (type_value == 0 ? "solvent-excluded" : "solvent-accessible") << std::endl;
+    } else {
+        std::cerr << "C++: Invalid surface type value: " << type_value << std::endl;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_surface_probe_radius(float radius) {
+    if (radius >= 0.0f && radius < 10.0f) {
+        surface_parameters.probe_radius = radius;
+        surface_stale = true;
+        request_redraw();
+        std::cout << "C++: Surface probe radius set to " << radius << std::endl;
+    } else {
+        std::cerr << "C++: Invalid surface probe radius: " << radius << std::endl;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_surface_resolution(float spacing) {
+    if (spacing >= 0.1f && spacing <= 5.0f) {
+        surface_parameters.grid_spacing = spacing;
+        surface_stale = true;
+        request_redraw();
+        std::cout << "C++: Surface grid spacing set to " << spacing << std::endl;
+    } else {
+        std::cerr << "C++: Invalid surface grid spacing: " << spacing << std::endl;
+    }
+}
+
 EMSCRIPTEN_KEEPALIVE
 void update_projection_matrix_aspect(int width, int height) {
     if (height == 0) height = 1; // prevent division by zero
     float aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
+    viewport_width = width;
+    viewport_height = height; // Used to turn projected radii into pixels for LOD selection
     projection_matrix = Mat4::perspective(PI / 3.0f, aspect_ratio, 0.1f, 100.0f);
+    request_redraw(); // Resizing the canvas also clears it
     
     // Update WebGL viewport to match the new drawing buffer size
     if (gl_context) { // Make sure GL context is available
@@ -370,6 +1014,131 @@ void update_projection_matrix_aspect(int width, int height) {
     std::cout << "C++: Projection matrix updated for aspect ratio: " << aspect_ratio << std::endl;
 }
 
+EMSCRIPTEN_KEEPALIVE
+double get_frame_triangle_count() {
+    return frame_triangle_count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double get_full_detail_triangle_count() {
+    return frame_full_detail_triangle_count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_cell_replication(int na, int nb, int nc) {
+    const int counts[3] = {na, nb, nc};
+    for (int count : counts) {
+        if (count < 1 || count > MAX_CELL_IMAGES) {
+            std::cerr << "C++: Invalid cell replication " << na << "x" << nb << "x" << nc << std::endl;
+            return;
+        }
+    }
+    std::copy(counts, counts + 3, requested_cell_images);
+    lod_buckets_valid = false; // Culling and LOD depend on the images
+    request_redraw();
+    std::cout << "C++: Cell replication set to " << na << "x" << nb << "x" << nc << " (" << cell_image_count()
+              << " images of the current cell)." << std::endl;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_cell_periodic_axes() {
+    const UnitCell& cell = current_molecule.cell;
+    return (cell.pbc[0] ? 1 : 0) | (cell.pbc[1] ? 2 : 0) | (cell.pbc[2] ? 4 : 0);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_frame_gl_call_count() {
+    return frame_gl_call_count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double get_rendered_frame_count() {
+    return rendered_frame_count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double get_skipped_frame_count() {
+    return skipped_frame_count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_buried_atom_count() {
+    return static_cast<int>(buried_atom_count);
+}
+
+EMSCRIPTEN_KEEPALIVE
+double get_surface_triangle_count() {
+    return static_cast<double>(surface_index_count / 3);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_hovered_atom_index() {
+    return static_cast<int>(hovered_atom);
+}
+
+EMSCRIPTEN_KEEPALIVE
+const char* get_hovered_atom_label() {
+    static std::string label;
+    const AtomArrays& atoms = current_molecule.atoms;
+    if (hovered_atom < 0 || static_cast<size_t>(hovered_atom) >= atoms.size()) return "None";
+    const size_t i = static_cast<size_t>(hovered_atom);
+    label = std::string(atoms.element(i)) + " #" + std::to_string(i + 1);
+    const StructureInfo& info = current_molecule.structure;
+    if (i < info.atom_names.size() && !info.residues.empty()) {
+        // Residues are in atom order, so the owner is the last one starting at or before i
+        auto it = std::upper_bound(info.residues.begin(), info.residues.end(), static_cast<uint32_t>(i),
+                                   [](uint32_t atom, const Residue& r) { return atom < r.first_atom; });
+        const Residue& res = *(it - 1);
+        label = std::string(info.atom_names[i].data(), strnlen(info.atom_names[i].data(), 4)) + " " +
+                std::string(res.name, strnlen(res.name, 4)) + " " + std::to_string(res.seq_num) +
+                std::string(res.chain_id, strnlen(res.chain_id, 4)) + " (" + label + ")";
+    }
+    return label.c_str();
+}
+
+// Times BVH rebuild, refit, culling for the current view and 1000 picks spread over the
+// canvas against brute-force scans of the current molecule. Returns the average pick time.
+EMSCRIPTEN_KEEPALIVE
+double benchmark_bvh() {
+    const AtomArrays& atoms = current_molecule.atoms;
+    if (atoms.empty() || atom_bvh.atom_count() != atoms.size()) return -1.0;
+    AtomBvh scratch;
+    double start = emscripten_get_now();
+    scratch.build(atoms, atom_display_radii);
+    double build_ms = emscripten_get_now() - start;
+    start = emscripten_get_now();
+    scratch.refit(atoms, atom_display_radii);
+    double refit_ms = emscripten_get_now() - start;
+
+    Frustum frustum = Frustum::from_matrix(projection_matrix * view_matrix);
+    std::vector<uint32_t> visible;
+    start = emscripten_get_now();
+    scratch.cull(frustum, atoms, atom_display_radii, visible);
+    double cull_ms = emscripten_get_now() - start;
+    size_t brute_visible = 0;
+    start = emscripten_get_now();
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        if (!frustum.sphere_outside(atoms.x[i], atoms.y[i], atoms.z[i], atom_display_radii[i])) brute_visible++;
+    }
+    double brute_cull_ms = emscripten_get_now() - start;
+
+    const int picks = 1000;
+    int hits = 0;
+    start = emscripten_get_now();
+    for (int k = 0; k < picks; ++k) {
+        Vec3 origin, direction;
+        camera_ray(static_cast<float>((k * 37) % viewport_width), static_cast<float>((k * 53) % viewport_height), origin, direction);
+        if (scratch.pick(origin, direction, atoms, atom_display_radii) >= 0) hits++;
+    }
+    double pick_ms = (emscripten_get_now() - start) / picks;
+
+    std::cout << "C++: BVH benchmark (" << atoms.size() << " atoms, " << scratch.nodes.size() << " nodes): build "
+              << build_ms << " ms, refit " << refit_ms << " ms, cull " << cull_ms << " ms (" << visible.size()
+              << " visible; brute force " << brute_cull_ms << " ms, " << brute_visible << " visible), pick "
+              << pick_ms * 1000.0 << " us average (" << hits << "/" << picks << " hits)." << std::endl;
+    return pick_ms;
+}
+
 EMSCRIPTEN_KEEPALIVE
 const char* get_current_molecule_name() {
     // Ensure the string isn't empty to avoid issues with c_str() on a potentially null-internal buffer for some std::string impls.
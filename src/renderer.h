@@ -4,6 +4,11 @@
 #include <GLES3/gl3.h>
 #include "math.h"
 #include "molecule.h"
+#include "shader.h"
+#include "molecular_surface.h"
+#include "bvh.h"
+#include <cstdint>
+#include <vector>
 
 // Appearance Settings
 extern float g_atom_display_scale_factor; // Default atom scale factor
@@ -17,39 +22,90 @@ extern const float DOUBLE_BOND_OFFSET_FACTOR;
 extern const float TRIPLE_BOND_CYLINDER_RADIUS_SCALE;
 extern const float TRIPLE_BOND_OFFSET_FACTOR;
 
-// Global WebGL context, shader program, matrices, and uniform locations
+// Global WebGL context, shader programs and matrices
 extern EMSCRIPTEN_WEBGL_CONTEXT_HANDLE gl_context;
-extern GLuint shader_program;
-extern GLint position_attribute_location;
-extern GLint normal_attribute_location;
 
 extern Mat4 projection_matrix;
 extern Mat4 view_matrix;
 
-extern GLint u_model_matrix_loc;
-extern GLint u_view_matrix_loc;
-extern GLint u_projection_matrix_loc;
-extern GLint u_color_loc;
-extern GLint u_normal_matrix_loc;
+extern ShaderProgram sphere_instance_program;   // Instanced spheres for all atoms
+extern ShaderProgram cylinder_instance_program; // Instanced cylinders for all bonds
+extern ShaderProgram sphere_impostor_program;   // Ray-cast impostors (RenderMode::Impostor)
+extern ShaderProgram cylinder_impostor_program;
+extern ShaderProgram surface_program;           // Molecular surface mesh (Representation::Surface)
+
+// Uniform buffers behind the FrameUniforms and MaterialUniforms blocks
+extern GLuint frame_uniform_buffer;
+extern GLuint material_uniform_buffer;
 
 // VAO/VBO for the sphere mesh
 extern GLuint sphere_vao;
 extern GLuint sphere_vbo_vertices;
 extern GLuint sphere_vbo_indices;
+extern GLuint sphere_vbo_instances; // Per-atom center, radius and color
+extern GLsizei atom_instance_count;
 
 // VAO/VBO for the cylinder mesh
 extern GLuint cylinder_vao;
 extern GLuint cylinder_vbo_vertices;
 extern GLuint cylinder_vbo_indices;
+extern GLuint cylinder_vbo_instances; // Per-cylinder endpoints, radius and color
+extern GLsizei bond_instance_count;
+
+// Quad VAOs for impostors, reading the sphere and cylinder instance buffers
+extern GLuint impostor_quad_vbo;
+extern GLuint sphere_impostor_vao;
+extern GLuint cylinder_impostor_vao;
+
+// VAO/VBO for the molecular surface mesh, rebuilt when the atoms or the surface settings change
+extern GLuint surface_vao;
+extern GLuint surface_vbo_vertices;
+extern GLuint surface_vbo_indices;
+extern GLsizei surface_index_count;
+extern SurfaceParameters surface_parameters;
 
 extern Molecule current_molecule; // Store the molecule globally for rendering
 extern Representation current_representation;
 
+// How spheres and cylinders are rasterized: tessellated meshes or ray-cast quads
+enum class RenderMode { Mesh, Impostor };
+extern RenderMode current_render_mode;
+
+// Instance data for a molecule that is not displayed yet, built off the main thread by the
+// background loader with the settings copied from current_instance_settings()
+struct PreparedInstances {
+    Representation representation = Representation::BallAndStick;
+    float atom_scale = 1.0f;
+    float bond_radius = 0.1f;
+    std::vector<float> atom_data;  // As atom_instance_data
+    std::vector<float> atom_radii;
+    std::vector<float> bond_data;  // As bond_instance_data
+    AtomBvh bvh;
+    std::vector<uint8_t> buried;   // SpaceFill only
+    size_t buried_count = 0;
+};
+
 // Functions
 void setup_sphere_geometry();
+float atom_display_radius(const ElementProperties& element, Representation representation, float scale);
+float atom_display_radius(const ElementProperties& element, Representation representation); // Current scale
+void request_redraw();              // Call after anything that changes the image but not the instances
+void mark_instances_dirty();        // Call after the atom set or bonds change (rebuilds the BVH)
+void mark_atom_coordinates_dirty(); // Call after atoms move or display sizes change (refits the BVH)
+void mark_atom_coordinates_streamed(); // As above, for per-frame updates from a live simulation
+void build_atom_instances(); // CPU instance arrays, BVH and buried-atom mask
+void build_bond_instances();
+PreparedInstances current_instance_settings(); // Empty, with the current display settings
+void prepare_instances(const Molecule& mol, PreparedInstances& out); // Thread-safe; reads no globals
+// Takes over prepared instances for the molecule just placed in current_molecule (main thread).
+// Falls back to a rebuild in the next frame if the settings changed after they were prepared.
+void adopt_prepared_instances(PreparedInstances& prepared);
 void setup_cylinder_geometry();
-Mat4 align_yaxis_to_vector(const Vec3& target_dir_normalized);
-void draw_one_cylinder_internal(const Mat4& model_matrix_bond);
+void setup_impostor_geometry();
+void setup_uniform_buffers();
+void setup_surface_geometry();
+long pick_atom_at(float css_x, float css_y); // Atom under a canvas point, or -1
+void update_hovered_atom(float css_x, float css_y);
 void render_frame();
 
 // Emscripten exported functions
@@ -69,9 +125,66 @@ extern "C" {
     EMSCRIPTEN_KEEPALIVE
     void set_representation(int rep_value);
 
+    EMSCRIPTEN_KEEPALIVE
+    void set_render_mode(int mode_value);
+
     EMSCRIPTEN_KEEPALIVE
     void update_projection_matrix_aspect(int width, int height);
 
+    // Triangles submitted last frame, and what the same instances would cost at the finest LOD
+    EMSCRIPTEN_KEEPALIVE
+    double get_frame_triangle_count();
+
+    EMSCRIPTEN_KEEPALIVE
+    double get_full_detail_triangle_count();
+
+    // Shows na x nb x nc images of a periodic unit cell (1..10 each; axes without periodicity
+    // stay at one image). Images are drawn by instancing, without copying the atoms.
+    EMSCRIPTEN_KEEPALIVE
+    void set_cell_replication(int na, int nb, int nc);
+
+    // Bit k set if the current molecule is periodic along lattice vector k (0 = not periodic)
+    EMSCRIPTEN_KEEPALIVE
+    int get_cell_periodic_axes();
+
+    // GL calls issued while drawing the last frame
+    EMSCRIPTEN_KEEPALIVE
+    int get_frame_gl_call_count();
+
+    // Main-loop iterations that drew a frame, and those skipped because nothing had changed
+    EMSCRIPTEN_KEEPALIVE
+    double get_rendered_frame_count();
+
+    EMSCRIPTEN_KEEPALIVE
+    double get_skipped_frame_count();
+
+    // Atoms hidden inside the SpaceFill surface and therefore skipped (0 in other representations)
+    EMSCRIPTEN_KEEPALIVE
+    int get_buried_atom_count();
+
+    // Molecular surface settings: 0 = solvent-excluded, 1 = solvent-accessible; probe radius
+    // (0 gives the van der Waals surface) and grid spacing in Angstrom
+    EMSCRIPTEN_KEEPALIVE
+    void set_surface_type(int type_value);
+
+    EMSCRIPTEN_KEEPALIVE
+    void set_surface_probe_radius(float radius);
+
+    EMSCRIPTEN_KEEPALIVE
+    void set_surface_resolution(float spacing);
+
+    EMSCRIPTEN_KEEPALIVE
+    double get_surface_triangle_count();
+
+    EMSCRIPTEN_KEEPALIVE
+    int get_hovered_atom_index();
+
+    EMSCRIPTEN_KEEPALIVE
+    const char* get_hovered_atom_label();
+
+    EMSCRIPTEN_KEEPALIVE
+    double benchmark_bvh();
+
     EMSCRIPTEN_KEEPALIVE
     const char* get_current_molecule_name();
 
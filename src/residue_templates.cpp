@@ -0,0 +1,238 @@
+#include "residue_templates.h"
+#include "neighbor.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+typedef std::array<char, 4> AtomName;
+
+struct TemplateBond {
+    AtomName a, b;
+    int order;
+};
+
+struct ResidueTemplate {
+    char name[4];
+    std::vector<TemplateBond> bonds;
+};
+
+// Intra-residue connectivity, written as "A-B" (single) or "A=B" (double).
+// Carbonyl/carboxyl C=O bonds are double; ring bonds are left single.
+const char* const AMINO_BACKBONE = "N-CA CA-C C=O C-OXT ";
+const char* const DNA_BACKBONE = "P=OP1 P-OP2 P-O5' O5'-C5' C5'-C4' C4'-O4' C4'-C3' C3'-O3' C3'-C2' C2'-C1' C1'-O4' ";
+const char* const RNA_BACKBONE = "P=OP1 P-OP2 P-O5' O5'-C5' C5'-C4' C4'-O4' C4'-C3' C3'-O3' C3'-C2' C2'-C1' C1'-O4' C2'-O2' ";
+const char* const ADENINE = "C1'-N9 N9-C8 C8-N7 N7-C5 C5-C6 C6-N6 C6-N1 N1-C2 C2-N3 N3-C4 C4-C5 C4-N9";
+const char* const GUANINE = "C1'-N9 N9-C8 C8-N7 N7-C5 C5-C6 C6=O6 C6-N1 N1-C2 C2-N2 C2-N3 N3-C4 C4-C5 C4-N9";
+const char* const CYTOSINE = "C1'-N1 N1-C2 C2=O2 C2-N3 N3-C4 C4-N4 C4-C5 C5-C6 C6-N1";
+const char* const URACIL = "C1'-N1 N1-C2 C2=O2 C2-N3 N3-C4 C4=O4 C4-C5 C5-C6 C6-N1";
+const char* const THYMINE = "C1'-N1 N1-C2 C2=O2 C2-N3 N3-C4 C4=O4 C4-C5 C5-C6 C6-N1 C5-C7";
+
+struct TemplateSource {
+    const char* name;
+    const char* backbone;
+    const char* bonds;
+};
+
+const TemplateSource TEMPLATE_SOURCES[] = {
+    { "ALA", AMINO_BACKBONE, "CA-CB" },
+    { "ARG", AMINO_BACKBONE, "CA-CB CB-CG CG-CD CD-NE NE-CZ CZ-NH1 CZ-NH2" },
+    { "ASN", AMINO_BACKBONE, "CA-CB CB-CG CG=OD1 CG-ND2" },
+    { "ASP", AMINO_BACKBONE, "CA-CB CB-CG CG=OD1 CG-OD2" },
+    { "CYS", AMINO_BACKBONE, "CA-CB CB-SG" },
+    { "GLN", AMINO_BACKBONE, "CA-CB CB-CG CG-CD CD=OE1 CD-NE2" },
+    { "GLU", AMINO_BACKBONE, "CA-CB CB-CG CG-CD CD=OE1 CD-OE2" },
+    { "GLY", AMINO_BACKBONE, "" },
+    { "HIS", AMINO_BACKBONE, "CA-CB CB-CG CG-ND1 CG-CD2 ND1-CE1 CE1-NE2 NE2-CD2" },
+    { "ILE", AMINO_BACKBONE, "CA-CB CB-CG1 CB-CG2 CG1-CD1" },
+    { "LEU", AMINO_BACKBONE, "CA-CB CB-CG CG-CD1 CG-CD2" },
+    { "LYS", AMINO_BACKBONE, "CA-CB CB-CG CG-CD CD-CE CE-NZ" },
+    { "MET", AMINO_BACKBONE, "CA-CB CB-CG CG-SD SD-CE" },
+    { "MSE", AMINO_BACKBONE, "CA-CB CB-CG CG-SE SE-CE" },
+    { "PHE", AMINO_BACKBONE, "CA-CB CB-CG CG-CD1 CG-CD2 CD1-CE1 CD2-CE2 CE1-CZ CE2-CZ" },
+    { "PRO", AMINO_BACKBONE, "CA-CB CB-CG CG-CD CD-N" },
+    { "SER", AMINO_BACKBONE, "CA-CB CB-OG" },
+    { "THR", AMINO_BACKBONE, "CA-CB CB-OG1 CB-CG2" },
+    { "TRP", AMINO_BACKBONE, "CA-CB CB-CG CG-CD1 CG-CD2 CD1-NE1 NE1-CE2 CD2-CE2 CD2-CE3 CE2-CZ2 CE3-CZ3 CZ2-CH2 CZ3-CH2" },
+    { "TYR", AMINO_BACKBONE, "CA-CB CB-CG CG-CD1 CG-CD2 CD1-CE1 CD2-CE2 CE1-CZ CE2-CZ CZ-OH" },
+    { "VAL", AMINO_BACKBONE, "CA-CB CB-CG1 CB-CG2" },
+    { "DA", DNA_BACKBONE, ADENINE },
+    { "DG", DNA_BACKBONE, GUANINE },
+    { "DC", DNA_BACKBONE, CYTOSINE },
+    { "DT", DNA_BACKBONE, THYMINE },
+    { "A", RNA_BACKBONE, ADENINE },
+    { "G", RNA_BACKBONE, GUANINE },
+    { "C", RNA_BACKBONE, CYTOSINE },
+    { "U", RNA_BACKBONE, URACIL },
+};
+
+AtomName make_atom_name(const char* begin, const char* end) {
+    AtomName name = {{0, 0, 0, 0}};
+    for (size_t i = 0; i < 4 && begin + i < end; ++i) name[i] = begin[i];
+    return name;
+}
+
+void parse_template_bonds(const char* spec, std::vector<TemplateBond>& out) {
+    const char* p = spec;
+    while (*p) {
+        while (*p == ' ') ++p;
+        if (!*p) break;
+        const char* token_end = p;
+        while (*token_end && *token_end != ' ') ++token_end;
+        const char* sep = p;
+        while (sep < token_end && *sep != '-' && *sep != '=') ++sep;
+        if (sep < token_end) {
+            out.push_back({ make_atom_name(p, sep), make_atom_name(sep + 1, token_end), *sep == '=' ? 2 : 1 });
+        }
+        p = token_end;
+    }
+}
+
+std::vector<ResidueTemplate> build_residue_templates() {
+    std::vector<ResidueTemplate> templates;
+    for (const auto& source : TEMPLATE_SOURCES) {
+        ResidueTemplate t;
+        std::memset(t.name, 0, sizeof(t.name));
+        std::strncpy(t.name, source.name, sizeof(t.name) - 1);
+        parse_template_bonds(source.backbone, t.bonds);
+        parse_template_bonds(source.bonds, t.bonds);
+        templates.push_back(t);
+    }
+    return templates;
+}
+
+const std::vector<ResidueTemplate>& residue_templates() {
+    static const std::vector<ResidueTemplate> templates = build_residue_templates();
+    return templates;
+}
+
+const ResidueTemplate* find_template(const char* residue_name) {
+    for (const auto& t : residue_templates()) {
+        if (std::strncmp(t.name, residue_name, 4) == 0) return &t;
+    }
+    return nullptr;
+}
+
+long find_atom(const Molecule& mol, const Residue& res, const AtomName& name) {
+    for (uint32_t k = 0; k < res.atom_count; ++k) {
+        uint32_t idx = res.first_atom + k;
+        if (mol.structure.atom_names[idx] == name) return idx;
+    }
+    return -1;
+}
+
+bool within_bond_distance(const AtomArrays& atoms, size_t i, size_t j) {
+    float dx = atoms.x[j] - atoms.x[i], dy = atoms.y[j] - atoms.y[i], dz = atoms.z[j] - atoms.z[i];
+    float distance_sq = dx * dx + dy * dy + dz * dz;
+    float max_bond_dist = (atoms.properties(i).covalent_radius + atoms.properties(j).covalent_radius) * BOND_DISTANCE_TOLERANCE_FACTOR;
+    return distance_sq <= max_bond_dist * max_bond_dist && distance_sq > 0.0001f;
+}
+
+// Distance-based perception inside one residue. If only_unbonded is set, only pairs involving
+// an atom that has no bond yet are considered (atoms the template did not cover).
+void perceive_residue_bonds(const Molecule& mol, const Residue& res, const std::vector<uint8_t>& has_bond,
+                            bool only_unbonded, std::vector<Bond>& bonds) {
+    const size_t LARGE_RESIDUE = 256;
+    if (res.atom_count > LARGE_RESIDUE) {
+        // Unusually large residue (e.g. a whole system written as one residue): use a cell list
+        Molecule local;
+        const AtomArrays& atoms = mol.atoms;
+        const size_t first = res.first_atom, last = first + res.atom_count;
+        local.atoms.x.assign(atoms.x.begin() + first, atoms.x.begin() + last);
+        local.atoms.y.assign(atoms.y.begin() + first, atoms.y.begin() + last);
+        local.atoms.z.assign(atoms.z.begin() + first, atoms.z.begin() + last);
+        local.atoms.atomic_number.assign(atoms.atomic_number.begin() + first, atoms.atomic_number.begin() + last);
+        generate_bonds(local);
+        for (const auto& bond : local.bonds) {
+            size_t i = res.first_atom + bond.atom1_idx, j = res.first_atom + bond.atom2_idx;
+            if (only_unbonded && has_bond[i] && has_bond[j]) continue;
+            bonds.push_back({i, j, 1});
+        }
+        return;
+    }
+    for (uint32_t a = 0; a < res.atom_count; ++a) {
+        size_t i = res.first_atom + a;
+        for (uint32_t b = a + 1; b < res.atom_count; ++b) {
+            size_t j = res.first_atom + b;
+            if (only_unbonded && has_bond[i] && has_bond[j]) continue;
+            if (within_bond_distance(mol.atoms, i, j)) bonds.push_back({i, j, 1});
+        }
+    }
+}
+
+// Bond between the named atoms of two consecutive residues if they are close enough to be linked
+void link_residues(const Molecule& mol, const Residue& r1, const char* name1, const Residue& r2, const char* name2,
+                   std::vector<Bond>& bonds) {
+    const float MAX_LINK_DISTANCE = 2.0f; // Angstroms; longer gaps are chain breaks
+    long i = find_atom(mol, r1, make_atom_name(name1, name1 + std::strlen(name1)));
+    long j = find_atom(mol, r2, make_atom_name(name2, name2 + std::strlen(name2)));
+    if (i < 0 || j < 0) return;
+    Vec3 d = mol.atoms.position(j) - mol.atoms.position(i);
+    float dx = d.x, dy = d.y, dz = d.z;
+    if (dx * dx + dy * dy + dz * dz <= MAX_LINK_DISTANCE * MAX_LINK_DISTANCE) {
+        bonds.push_back({static_cast<size_t>(i), static_cast<size_t>(j), 1});
+    }
+}
+
+} // namespace
+
+bool is_standard_residue(const char* residue_name) {
+    return find_template(residue_name) != nullptr;
+}
+
+void build_structure_bonds(Molecule& mol, std::vector<Bond>& explicit_bonds) {
+    const StructureInfo& info = mol.structure;
+    std::vector<Bond> bonds;
+    bonds.swap(explicit_bonds);
+
+    std::vector<uint8_t> has_bond(mol.atoms.size(), 0);
+    for (const auto& bond : bonds) { has_bond[bond.atom1_idx] = 1; has_bond[bond.atom2_idx] = 1; }
+
+    for (size_t r = 0; r < info.residues.size(); ++r) {
+        const Residue& res = info.residues[r];
+        const ResidueTemplate* tmpl = find_template(res.name);
+        if (tmpl) {
+            size_t first_template_bond = bonds.size();
+            for (const auto& tb : tmpl->bonds) {
+                long i = find_atom(mol, res, tb.a);
+                long j = find_atom(mol, res, tb.b);
+                if (i >= 0 && j >= 0) bonds.push_back({static_cast<size_t>(i), static_cast<size_t>(j), tb.order});
+            }
+            for (size_t k = first_template_bond; k < bonds.size(); ++k) {
+                has_bond[bonds[k].atom1_idx] = 1;
+                has_bond[bonds[k].atom2_idx] = 1;
+            }
+            // Hydrogens and non-template atom names
+            perceive_residue_bonds(mol, res, has_bond, true, bonds);
+        } else {
+            // Hetero groups: trust explicit connectivity when the file provides any for this residue
+            bool any_explicit = false;
+            for (uint32_t k = 0; k < res.atom_count && !any_explicit; ++k) any_explicit = has_bond[res.first_atom + k] != 0;
+            if (!any_explicit) perceive_residue_bonds(mol, res, has_bond, false, bonds);
+        }
+
+        if (r + 1 < info.residues.size()) {
+            const Residue& next = info.residues[r + 1];
+            if (std::strncmp(res.chain_id, next.chain_id, 4) == 0) {
+                link_residues(mol, res, "C", next, "N", bonds);    // Peptide bond
+                link_residues(mol, res, "O3'", next, "P", bonds); // Phosphodiester bond
+            }
+        }
+    }
+
+    // Normalize, sort and deduplicate (CONECT lists most bonds from both ends); keep the highest order
+    for (auto& bond : bonds) {
+        if (bond.atom1_idx > bond.atom2_idx) std::swap(bond.atom1_idx, bond.atom2_idx);
+    }
+    std::sort(bonds.begin(), bonds.end(), [](const Bond& a, const Bond& b) {
+        if (a.atom1_idx != b.atom1_idx) return a.atom1_idx < b.atom1_idx;
+        if (a.atom2_idx != b.atom2_idx) return a.atom2_idx < b.atom2_idx;
+        return a.order > b.order;
+    });
+    mol.bonds.clear();
+    for (const auto& bond : bonds) {
+        if (bond.atom1_idx == bond.atom2_idx) continue;
+        if (!mol.bonds.empty() && mol.bonds.back().atom1_idx == bond.atom1_idx && mol.bonds.back().atom2_idx == bond.atom2_idx) continue;
+        mol.bonds.push_back(bond);
+    }
+}
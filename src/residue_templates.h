@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+#include "molecule.h"
+
+// True for the standard amino acids and nucleotides covered by the built-in templates
+bool is_standard_residue(const char* residue_name);
+
+// Builds mol.bonds for a structure whose atoms are grouped into mol.structure.residues.
+// explicit_bonds come from the file (CONECT / _struct_conn) and are kept as given. Standard
+// residues get their bonds from templates plus peptide (C-N) and phosphodiester (O3'-P)
+// links to the next residue in the same chain. Remaining atoms fall back to distance-based
+// perception within their own residue, except hetero residues that already have explicit
+// bonds. The result is sorted by (atom1_idx, atom2_idx) with duplicates removed.
+void build_structure_bonds(Molecule& mol, std::vector<Bond>& explicit_bonds);
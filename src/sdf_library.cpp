@@ -0,0 +1,123 @@
+#include "sdf_library.h"
+#include "sdf_reader.h"
+#include "parser.h"
+#include "renderer.h"
+#include "trajectory.h"
+#include "loader.h"
+#include <iostream>
+#include <cstring>
+#include <utility>
+
+SdfLibrary current_sdf_library;
+
+static const char* record_end(const SdfLibrary& library, int record) {
+    return record + 1 < library.record_count() ? library.text.data() + library.record_offsets[record + 1]
+                                               : library.text.data() + library.text.size();
+}
+
+// Parses a record without touching the displayed molecule
+static bool parse_sdf_record(const SdfLibrary& library, int record, Molecule& out) {
+    const char* begin = library.text.data() + library.record_offsets[record];
+    if (!parse_mol_record(begin, record_end(library, record), out)) {
+        std::cerr << "C++: Failed to parse SDF record " << record + 1 << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Makes a parsed record of current_sdf_library the displayed molecule
+static void show_sdf_record(int record, Molecule& parsed) {
+    SdfLibrary& library = current_sdf_library;
+    cancel_background_load(); // A direct load supersedes a background one
+    current_trajectory.clear();
+    std::swap(current_molecule, parsed);
+    // Bonds come from the bond block, so there is no distance-based bond generation here
+    current_molecule.formula = generate_molecular_formula(current_molecule);
+    mark_instances_dirty();
+    library.current_record = record;
+    std::cout << "C++: Loaded SDF record " << record + 1 << " / " << library.record_count() << ": "
+              << current_molecule.name << " (" << current_molecule.formula << ", " << current_molecule.atoms.size()
+              << " atoms, " << current_molecule.bonds.size() << " bonds)" << std::endl;
+}
+
+bool load_sdf_record(int record) {
+    const SdfLibrary& library = current_sdf_library;
+    if (record < 0 || record >= library.record_count()) return false;
+    // Parse into a temporary so a bad record leaves the current one (and current_record) in place
+    Molecule parsed;
+    if (!parse_sdf_record(library, record, parsed)) return false;
+    show_sdf_record(record, parsed);
+    return true;
+}
+
+extern "C" {
+EMSCRIPTEN_KEEPALIVE
+void load_sdf_from_string(const char* sdf_data_str) {
+    // The new library is staged until its first record parses, so a bad file changes nothing
+    SdfLibrary library;
+    std::cout << "C++: Attempting to load molecules from SDF string..." << std::endl;
+
+    size_t length = std::strlen(sdf_data_str);
+    library.text.assign(sdf_data_str, length);
+    double index_start = emscripten_get_now();
+    index_sdf_records(library.text.data(), library.text.size(), library.record_offsets);
+    double index_ms = emscripten_get_now() - index_start;
+    std::cout << "C++: Indexed " << library.record_count() << " SDF records (" << length / 1.0e6 << " MB) in "
+              << index_ms << " ms." << std::endl;
+
+    Molecule first;
+    if (library.record_count() == 0 || !parse_sdf_record(library, 0, first)) {
+        std::cerr << "C++: No loadable records in SDF data." << std::endl;
+        return;
+    }
+    std::swap(current_sdf_library, library);
+    show_sdf_record(0, first);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_sdf_record_count() {
+    return current_sdf_library.record_count();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_sdf_current_record() {
+    return current_sdf_library.current_record;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_sdf_record(int record) {
+    if (record == current_sdf_library.current_record) return;
+    if (record < 0 || record >= current_sdf_library.record_count()) {
+        std::cerr << "C++: Invalid SDF record: " << record << std::endl;
+        return;
+    }
+    load_sdf_record(record);
+}
+
+EMSCRIPTEN_KEEPALIVE
+double benchmark_sdf_records() {
+    const SdfLibrary& library = current_sdf_library;
+    if (library.record_count() == 0) return -1.0;
+
+    Molecule scratch; // Reused so the timing reflects parsing, not allocation
+    size_t atoms = 0, bonds = 0;
+    int failures = 0;
+    double start = emscripten_get_now();
+    for (int record = 0; record < library.record_count(); ++record) {
+        scratch.clear();
+        const char* begin = library.text.data() + library.record_offsets[record];
+        if (!parse_mol_record(begin, record_end(library, record), scratch)) {
+            failures++;
+            continue;
+        }
+        atoms += scratch.atoms.size();
+        bonds += scratch.bonds.size();
+    }
+    double elapsed_ms = emscripten_get_now() - start;
+    std::cout << "C++: SDF benchmark: parsed " << library.record_count() << " records (" << atoms << " atoms, "
+              << bonds << " bonds, " << failures << " failed) in " << elapsed_ms << " ms ("
+              << (elapsed_ms > 0.0 ? library.record_count() / (elapsed_ms / 1000.0) : 0.0) << " records/s, "
+              << (elapsed_ms > 0.0 ? (library.text.size() / 1.0e6) / (elapsed_ms / 1000.0) : 0.0) << " MB/s)." << std::endl;
+    return elapsed_ms;
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <emscripten/emscripten.h>
+
+// Multi-record SDF compound library. The text is indexed once (byte offset per record) and a
+// record is parsed only when it is displayed, so selecting any record costs O(record size).
+struct SdfLibrary {
+    std::string text;                   // Owned copy of the file contents
+    std::vector<size_t> record_offsets; // Byte offset of each record's name line
+    int current_record = -1;
+
+    int record_count() const { return static_cast<int>(record_offsets.size()); }
+    void clear() {
+        text.clear(); text.shrink_to_fit();
+        record_offsets.clear();
+        current_record = -1;
+    }
+};
+
+extern SdfLibrary current_sdf_library;
+
+// Parses a record and makes it current_molecule (atoms, file bonds, formula)
+bool load_sdf_record(int record);
+
+extern "C" {
+    EMSCRIPTEN_KEEPALIVE
+    void load_sdf_from_string(const char* sdf_data_str);
+
+    EMSCRIPTEN_KEEPALIVE
+    int get_sdf_record_count();
+
+    EMSCRIPTEN_KEEPALIVE
+    int get_sdf_current_record();
+
+    EMSCRIPTEN_KEEPALIVE
+    void set_sdf_record(int record);
+
+    // Parses every record of the loaded library without displaying them and logs the
+    // throughput. Returns the elapsed time in milliseconds, or -1 if nothing is loaded.
+    EMSCRIPTEN_KEEPALIVE
+    double benchmark_sdf_records();
+}
@@ -0,0 +1,272 @@
+#include "sdf_reader.h"
+#include "text_scan.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace {
+
+bool line_starts_with(const char* line_begin, const char* line_end, const char* tag) {
+    size_t n = std::strlen(tag);
+    return static_cast<size_t>(line_end - line_begin) >= n && std::memcmp(line_begin, tag, n) == 0;
+}
+
+bool token_is(const char* b, const char* e, const char* word) {
+    size_t n = std::strlen(word);
+    return static_cast<size_t>(e - b) == n && std::memcmp(b, word, n) == 0;
+}
+
+int mdl_atomic_number(const char* b, const char* e) {
+    b = skip_blanks(b, e);
+    if (b < e && *b == '"') ++b; // V3000 may quote the type
+    while (e > b && (is_blank(e[-1]) || e[-1] == '"')) --e;
+    if (e - b == 1 && (*b == 'D' || *b == 'T')) return 1; // Isotope shorthands
+    return atomic_number_from_symbol(b, e);
+}
+
+bool add_bond(Molecule& out, int a1, int a2, int type, int line_number) {
+    int atom_count = static_cast<int>(out.atoms.size());
+    if (a1 < 1 || a2 < 1 || a1 > atom_count || a2 > atom_count || a1 == a2) {
+        std::cerr << "SDF Parse Error (Record Line " << line_number << "): Bond references invalid atoms "
+                  << a1 << " and " << a2 << "." << std::endl;
+        return false;
+    }
+    out.bonds.push_back({static_cast<size_t>(a1 - 1), static_cast<size_t>(a2 - 1), type});
+    return true;
+}
+
+bool parse_v2000(LineReader& reader, const char* counts_begin, const char* counts_end, Molecule& out) {
+    int atom_count = 0;
+    int bond_count = 0;
+    if (!parse_column_int(counts_begin, counts_end, 1, 3, atom_count) ||
+        !parse_column_int(counts_begin, counts_end, 4, 6, bond_count) || atom_count < 0 || bond_count < 0) {
+        std::cerr << "SDF Parse Error (Record Line " << reader.line_number << "): Invalid counts line: "
+                  << std::string(counts_begin, counts_end) << std::endl;
+        return false;
+    }
+    out.atoms.reserve(atom_count);
+    out.bonds.reserve(bond_count);
+
+    const char* line_begin;
+    const char* line_end;
+    for (int i = 0; i < atom_count; ++i) {
+        if (!reader.next(line_begin, line_end)) {
+            std::cerr << "SDF Parse Error: Atom block ended after " << i << " of " << atom_count << " atoms." << std::endl;
+            return false;
+        }
+        float x, y, z;
+        if (!parse_column_float(line_begin, line_end, 1, 10, x) ||
+            !parse_column_float(line_begin, line_end, 11, 20, y) ||
+            !parse_column_float(line_begin, line_end, 21, 30, z)) {
+            std::cerr << "SDF Parse Error (Record Line " << reader.line_number << "): Could not parse coordinates: "
+                      << std::string(line_begin, line_end) << std::endl;
+            return false;
+        }
+        const char* b;
+        const char* e;
+        column_field(line_begin, line_end, 32, 34, b, e);
+        out.atoms.push_back(x, y, z, mdl_atomic_number(b, e));
+    }
+
+    for (int i = 0; i < bond_count; ++i) {
+        if (!reader.next(line_begin, line_end)) {
+            std::cerr << "SDF Parse Error: Bond block ended after " << i << " of " << bond_count << " bonds." << std::endl;
+            return false;
+        }
+        int a1 = 0, a2 = 0, type = 1;
+        if (!parse_column_int(line_begin, line_end, 1, 3, a1) || !parse_column_int(line_begin, line_end, 4, 6, a2) ||
+            !parse_column_int(line_begin, line_end, 7, 9, type)) {
+            std::cerr << "SDF Parse Error (Record Line " << reader.line_number << "): Invalid bond line: "
+                      << std::string(line_begin, line_end) << std::endl;
+            return false;
+        }
+        if (!add_bond(out, a1, a2, type, reader.line_number)) return false;
+    }
+    return true; // The property block (charges, isotopes) is not needed for display
+}
+
+// Returns the next "M  V30" logical line with the prefix stripped, joining '-' continuation
+// lines into scratch. Returns false at "M  END" or the end of the record.
+bool next_v30_line(LineReader& reader, std::string& scratch, const char*& b, const char*& e) {
+    static const char PREFIX[] = "M  V30 ";
+    const size_t prefix_length = sizeof(PREFIX) - 1;
+    const char* line_begin;
+    const char* line_end;
+    bool continued = false;
+    scratch.clear();
+    while (reader.next(line_begin, line_end)) {
+        if (!line_starts_with(line_begin, line_end, PREFIX)) {
+            if (line_starts_with(line_begin, line_end, "M  END")) return false;
+            continue; // Other property lines are skipped
+        }
+        const char* text_begin = line_begin + prefix_length;
+        const char* text_end = line_end;
+        while (text_end > text_begin && is_blank(text_end[-1])) --text_end;
+        bool continues = text_end > text_begin && text_end[-1] == '-';
+        if (!continued && !continues) { // Common case: no copy
+            b = text_begin;
+            e = text_end;
+            return true;
+        }
+        scratch.append(text_begin, continues ? text_end - 1 : text_end);
+        continued = true;
+        if (!continues) {
+            b = scratch.data();
+            e = scratch.data() + scratch.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+// "index type x y z ..." from the V3000 atom block
+bool parse_v3000_atom(const char* p, const char* e, int& id, int& atomic_number, float& x, float& y, float& z) {
+    if (!parse_int(p, e, id)) return false;
+    p = skip_blanks(p, e);
+    const char* type_end = skip_token(p, e);
+    atomic_number = mdl_atomic_number(p, type_end);
+    p = skip_blanks(type_end, e);
+    if (!parse_float(p, e, x)) return false;
+    p = skip_blanks(p, e);
+    if (!parse_float(p, e, y)) return false;
+    p = skip_blanks(p, e);
+    return parse_float(p, e, z);
+}
+
+// "index type atom1 atom2 ..." from the V3000 bond block
+bool parse_v3000_bond(const char* p, const char* e, int& type, int& a1, int& a2) {
+    int id = 0;
+    if (!parse_int(p, e, id)) return false;
+    p = skip_blanks(p, e);
+    if (!parse_int(p, e, type)) return false;
+    p = skip_blanks(p, e);
+    if (!parse_int(p, e, a1)) return false;
+    p = skip_blanks(p, e);
+    return parse_int(p, e, a2);
+}
+
+const size_t V30_MIN_LINE_BYTES = 14; // "M  V30 1 1 1 2"
+
+bool parse_v3000(LineReader& reader, Molecule& out) {
+    enum class Block { None, Atom, Bond };
+    Block block = Block::None;
+    std::string scratch;
+    std::vector<std::pair<int, uint32_t>> atom_ids; // (V3000 atom index, position)
+    bool sequential_ids = true; // Indices are 1..N in order, so no lookup is needed
+    bool ids_sorted = false;
+    const char* b;
+    const char* e;
+
+    while (next_v30_line(reader, scratch, b, e)) {
+        const char* p = skip_blanks(b, e);
+        const char* word_end = skip_token(p, e);
+        if (token_is(p, word_end, "BEGIN") || token_is(p, word_end, "END")) {
+            bool begin = token_is(p, word_end, "BEGIN");
+            const char* what = skip_blanks(word_end, e);
+            const char* what_end = skip_token(what, e);
+            if (token_is(what, what_end, "ATOM")) block = begin ? Block::Atom : Block::None;
+            else if (token_is(what, what_end, "BOND")) block = begin ? Block::Bond : Block::None;
+            else if (token_is(what, what_end, "CTAB") && !begin) break;
+            else block = Block::None; // SGROUP, COLLECTION, ...
+            continue;
+        }
+        if (token_is(p, word_end, "COUNTS")) {
+            // Reserve no more than the rest of the record can hold (an "M  V30" atom or bond line
+            // takes at least V30_MIN_LINE_BYTES), so bogus counts fail the record instead of the allocation
+            const size_t line_capacity = static_cast<size_t>(reader.end - reader.cur) / V30_MIN_LINE_BYTES;
+            int atom_count = 0, bond_count = 0;
+            p = skip_blanks(word_end, e);
+            if (parse_int(p, e, atom_count) && atom_count > 0) out.atoms.reserve(std::min<size_t>(atom_count, line_capacity));
+            p = skip_blanks(p, e);
+            if (parse_int(p, e, bond_count) && bond_count > 0) out.bonds.reserve(std::min<size_t>(bond_count, line_capacity));
+            continue;
+        }
+
+        bool ok = true;
+        if (block == Block::Atom) {
+            int id = 0, atomic_number = 0;
+            float x, y, z;
+            ok = parse_v3000_atom(p, e, id, atomic_number, x, y, z);
+            if (ok) {
+                uint32_t position = static_cast<uint32_t>(out.atoms.size());
+                if (id != static_cast<int>(position) + 1) sequential_ids = false;
+                atom_ids.push_back({id, position});
+                out.atoms.push_back(x, y, z, atomic_number);
+            }
+        } else if (block == Block::Bond) {
+            int type = 1, a1 = 0, a2 = 0;
+            ok = parse_v3000_bond(p, e, type, a1, a2);
+            if (ok && !sequential_ids) { // Map arbitrary atom indices to 1-based positions
+                if (!ids_sorted) {
+                    std::sort(atom_ids.begin(), atom_ids.end());
+                    ids_sorted = true;
+                }
+                auto lookup = [&](int atom_id) {
+                    auto it = std::lower_bound(atom_ids.begin(), atom_ids.end(), std::make_pair(atom_id, 0u));
+                    return (it != atom_ids.end() && it->first == atom_id) ? static_cast<int>(it->second) + 1 : 0;
+                };
+                a1 = lookup(a1);
+                a2 = lookup(a2);
+            }
+            if (ok && !add_bond(out, a1, a2, type, reader.line_number)) return false;
+        }
+        if (!ok) {
+            std::cerr << "SDF Parse Error (Record Line " << reader.line_number << "): Invalid V3000 line: "
+                      << std::string(b, e) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+size_t index_sdf_records(const char* data, size_t length, std::vector<size_t>& offsets) {
+    offsets.clear();
+    LineReader reader(data, data + length);
+    const char* line_begin;
+    const char* line_end;
+    size_t record_start = 0;
+    bool has_content = false; // Skips the empty "record" after the final "$$$$"
+    while (reader.next(line_begin, line_end)) {
+        if (line_starts_with(line_begin, line_end, "$$$$")) {
+            if (has_content) offsets.push_back(record_start);
+            record_start = static_cast<size_t>(reader.cur - data);
+            has_content = false;
+        } else if (!has_content && skip_blanks(line_begin, line_end) != line_end) {
+            has_content = true;
+        }
+    }
+    if (has_content) offsets.push_back(record_start);
+    return offsets.size();
+}
+
+bool parse_mol_record(const char* begin, const char* end, Molecule& out) {
+    LineReader reader(begin, end);
+    const char* header[4][2];
+    for (int i = 0; i < 4; ++i) { // Name, program/timestamp, comment, counts
+        if (!reader.next(header[i][0], header[i][1])) {
+            std::cerr << "SDF Parse Error: Record ended inside the molfile header." << std::endl;
+            return false;
+        }
+    }
+    const char* name_begin = skip_blanks(header[0][0], header[0][1]);
+    const char* name_end = header[0][1];
+    while (name_end > name_begin && is_blank(name_end[-1])) --name_end;
+    out.name = name_begin < name_end ? std::string(name_begin, name_end) : "Untitled Compound";
+
+    const char* counts_begin = header[3][0];
+    const char* counts_end = header[3][1];
+    bool v3000 = false;
+    for (const char* p = counts_begin; p + 5 <= counts_end; ++p) {
+        if (std::memcmp(p, "V3000", 5) == 0) { v3000 = true; break; }
+    }
+    bool ok = v3000 ? parse_v3000(reader, out) : parse_v2000(reader, counts_begin, counts_end, out);
+    if (ok && out.atoms.empty()) {
+        std::cerr << "SDF Parse Error: Record contains no atoms." << std::endl;
+        return false;
+    }
+    return ok;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "molecule.h"
+
+// Records one byte offset per molecule in an SDF (records separated by "$$$$" lines) in a
+// single pass. A plain MOL file yields one record. Returns the number of records.
+size_t index_sdf_records(const char* data, size_t length, std::vector<size_t>& offsets);
+
+// Parses one MDL molfile (V2000 or V3000 connection table) starting at begin into out.
+// Bonds and their orders come straight from the bond block; no distance inference is
+// done. MDL bond types are kept as Bond::order (1-3; 4 = aromatic, drawn as single).
+// Error messages give line numbers relative to the start of the record.
+bool parse_mol_record(const char* begin, const char* end, Molecule& out);
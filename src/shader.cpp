@@ -2,45 +2,270 @@
 #include <iostream>
 #include <vector>
 
-// Updated Vertex Shader
-const char* vertex_shader_source = R"glsl(#version 300 es
-    uniform mat4 uModelMatrix;
-    uniform mat4 uViewMatrix;
-    uniform mat4 uProjectionMatrix;
-    uniform mat3 uNormalMatrix; // transpose(inverse(uModelMatrix)) for normals
+// Declarations of the shared uniform blocks, placed after the #version line of every shader.
+// Members carry explicit precision so the vertex and fragment stages agree when linking.
+#define GLSL_UNIFORM_BLOCKS \
+    "layout(std140) uniform FrameUniforms {\n" \
+    "    highp mat4 uViewMatrix;\n" \
+    "    highp mat4 uProjectionMatrix;\n" \
+    "    highp mat4 uViewProjectionMatrix;\n" \
+    "    highp vec4 uLightDir_world;\n" \
+    "    highp vec4 uLightDir_view;\n" \
+    "    highp vec4 uCellA; // Supercell: xyz = lattice vector, w = images along it\n" \
+    "    highp vec4 uCellB;\n" \
+    "    highp vec4 uCellC;\n" \
+    "};\n" \
+    "layout(std140) uniform MaterialUniforms {\n" \
+    "    highp vec4 uMaterial; // x = ambient, y = diffuse\n" \
+    "};\n"
 
-    in vec3 aPosition;
-    in vec3 aNormal;
+// Translation of the cell image an instanced vertex is drawn for. Instance attributes advance
+// once per image, so consecutive gl_InstanceIDs are the images of one atom or bond, numbered
+// with a fastest and centered on the original cell (vertex shaders only).
+#define GLSL_CELL_IMAGE \
+    "vec3 cell_image_offset() {\n" \
+    "    ivec3 n = ivec3(vec3(uCellA.w, uCellB.w, uCellC.w) + 0.5);\n" \
+    "    int image = gl_InstanceID % (n.x * n.y * n.z);\n" \
+    "    ivec3 i = ivec3(image % n.x, (image / n.x) % n.y, image / (n.x * n.y)) - (n - 1) / 2;\n" \
+    "    return uCellA.xyz * float(i.x) + uCellB.xyz * float(i.y) + uCellC.xyz * float(i.z);\n" \
+    "}\n"
+
+// Instanced sphere vertex shader: one draw call for all atoms. The unit sphere is scaled and
+// translated per instance, and since the scale is uniform the mesh normal is already the
+// world-space normal (no normal matrix needed).
+const char* sphere_instance_vertex_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS GLSL_CELL_IMAGE R"glsl(
+
+    layout(location = 0) in vec3 aPosition;
+    layout(location = 1) in vec3 aNormal;
+    layout(location = 2) in vec4 aCenterRadius; // Per instance: xyz = center, w = radius
+    layout(location = 3) in vec3 aColor;        // Per instance
 
     out vec3 vNormal_world;
-    out vec3 vPosition_world; // For specular or other effects later
+    out vec3 vColor;
 
     void main() {
-        vec4 worldPos = uModelMatrix * vec4(aPosition, 1.0);
-        vPosition_world = worldPos.xyz;
-        gl_Position = uProjectionMatrix * uViewMatrix * worldPos;
-        vNormal_world = normalize(uNormalMatrix * aNormal);
+        vec3 worldPos = aCenterRadius.xyz + cell_image_offset() + aPosition * aCenterRadius.w;
+        gl_Position = uViewProjectionMatrix * vec4(worldPos, 1.0);
+        vNormal_world = aNormal;
+        vColor = aColor;
     }
 )glsl";
 
-// Updated Fragment Shader
-const char* fragment_shader_source = R"glsl(#version 300 es
+// Instanced cylinder vertex shader: one draw call for all bonds. The unit cylinder (radius 1,
+// y in [-0.5, 0.5]) is stretched between the two instance endpoints using an orthonormal
+// frame built from the axis, so normals need no matrix either.
+const char* cylinder_instance_vertex_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS GLSL_CELL_IMAGE R"glsl(
+
+    layout(location = 0) in vec3 aPosition;
+    layout(location = 1) in vec3 aNormal;
+    layout(location = 2) in vec4 aStartRadius; // Per instance: xyz = start, w = radius
+    layout(location = 3) in vec3 aColor;       // Per instance
+    layout(location = 4) in vec3 aEnd;         // Per instance
+
+    out vec3 vNormal_world;
+    out vec3 vColor;
+
+    void main() {
+        vec3 start = aStartRadius.xyz + cell_image_offset();
+        vec3 axis = aEnd - aStartRadius.xyz;
+        vec3 dir = normalize(axis);
+        vec3 ref = abs(dir.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+        vec3 u = normalize(cross(dir, ref));
+        vec3 w = cross(u, dir); // (u, dir, w) is right-handed like the mesh's (x, y, z)
+        vec3 worldPos = start + axis * (aPosition.y + 0.5)
+                      + (u * aPosition.x + w * aPosition.z) * aStartRadius.w;
+        gl_Position = uViewProjectionMatrix * vec4(worldPos, 1.0);
+        vNormal_world = u * aNormal.x + dir * aNormal.y + w * aNormal.z;
+        vColor = aColor;
+    }
+)glsl";
+
+// Shared by the instanced sphere and cylinder programs
+const char* instance_fragment_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS R"glsl(
     precision mediump float;
-    
-    uniform vec4 uColor;
 
     in vec3 vNormal_world;
-    in vec3 vPosition_world; // For specular or other effects later
+    in vec3 vColor;
 
     out vec4 fragColor;
 
     void main() {
-        vec3 lightDir_world = normalize(vec3(0.5, 0.8, 1.0)); // Light direction in world space
-        vec3 normal_world_normalized = normalize(vNormal_world);
-        float diffuse_intensity = max(dot(normal_world_normalized, lightDir_world), 0.0);
-        float ambient_intensity = 0.25;
-        vec3 litColor = uColor.rgb * (ambient_intensity + diffuse_intensity);
-        fragColor = vec4(litColor, uColor.a);
+        float diffuse_intensity = max(dot(normalize(vNormal_world), uLightDir_world.xyz), 0.0) * uMaterial.y;
+        fragColor = vec4(vColor * (uMaterial.x + diffuse_intensity), 1.0);
+    }
+)glsl";
+
+// Ray-cast impostors: each sphere or cylinder is drawn as one camera-facing quad that bounds
+// its projection. The fragment shader intersects the view ray with the exact surface, so the
+// silhouette is smooth at any zoom, and writes the true depth so impostors intersect correctly.
+// Everything is done in view space, where the eye sits at the origin.
+const char* sphere_impostor_vertex_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS GLSL_CELL_IMAGE R"glsl(
+
+    layout(location = 0) in vec2 aCorner;       // Quad corner in [-1, 1]^2
+    layout(location = 2) in vec4 aCenterRadius; // Per instance: xyz = center, w = radius
+    layout(location = 3) in vec3 aColor;        // Per instance
+
+    out vec3 vViewPos;
+    flat out vec4 vCenterRadius_view;
+    flat out vec3 vColor;
+
+    void main() {
+        vec3 center = (uViewMatrix * vec4(aCenterRadius.xyz + cell_image_offset(), 1.0)).xyz;
+        float radius = aCenterRadius.w;
+        // Quad through the center, facing the eye, sized to the sphere's tangent cone
+        vec3 toward = normalize(center);
+        vec3 right = normalize(cross(toward, abs(toward.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+        vec3 up = cross(right, toward);
+        float d = length(center);
+        float extent = radius * d / sqrt(max(d * d - radius * radius, 1e-6));
+        vViewPos = center + (right * aCorner.x + up * aCorner.y) * extent;
+        gl_Position = uProjectionMatrix * vec4(vViewPos, 1.0);
+        vCenterRadius_view = vec4(center, radius);
+        vColor = aColor;
+    }
+)glsl";
+
+const char* sphere_impostor_fragment_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS R"glsl(
+    precision highp float;
+
+    in vec3 vViewPos;
+    flat in vec4 vCenterRadius_view;
+    flat in vec3 vColor;
+
+    out vec4 fragColor;
+
+    void main() {
+        vec3 rd = normalize(vViewPos);
+        vec3 center = vCenterRadius_view.xyz;
+        float radius = vCenterRadius_view.w;
+        float b = dot(rd, center);
+        float disc = b * b - (dot(center, center) - radius * radius);
+        if (disc < 0.0) discard;
+        float t = b - sqrt(disc);
+        if (t <= 0.0) discard; // Eye inside or in front of the sphere
+        vec3 hit = rd * t;
+        vec3 normal_view = (hit - center) / radius;
+
+        vec4 clip = uProjectionMatrix * vec4(hit, 1.0);
+        gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+
+        float diffuse_intensity = max(dot(normal_view, uLightDir_view.xyz), 0.0) * uMaterial.y;
+        fragColor = vec4(vColor * (uMaterial.x + diffuse_intensity), 1.0);
+    }
+)glsl";
+
+const char* cylinder_impostor_vertex_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS GLSL_CELL_IMAGE R"glsl(
+
+    layout(location = 0) in vec2 aCorner;      // x across the bond, y from start (-1) to end (+1)
+    layout(location = 2) in vec4 aStartRadius; // Per instance: xyz = start, w = radius
+    layout(location = 3) in vec3 aColor;       // Per instance
+    layout(location = 4) in vec3 aEnd;         // Per instance
+
+    out vec3 vViewPos;
+    flat out vec4 vStartRadius_view;
+    flat out vec3 vEnd_view;
+    flat out vec3 vColor;
+
+    void main() {
+        vec3 offset = cell_image_offset();
+        vec3 a = (uViewMatrix * vec4(aStartRadius.xyz + offset, 1.0)).xyz;
+        vec3 b = (uViewMatrix * vec4(aEnd + offset, 1.0)).xyz;
+        float radius = aStartRadius.w;
+
+        // The quad lies in the plane through the midpoint facing the eye. Both end caps are
+        // projected onto it through the eye; each is bounded by a disc whose radius grows by
+        // the same depth ratio, so the quad covers the cylinder on screen even end-on.
+        vec3 mid = 0.5 * (a + b);
+        vec3 toward = normalize(mid);
+        float plane = dot(mid, toward);
+        float depth_a = max(dot(a, toward) - radius, 1e-3);
+        float depth_b = max(dot(b, toward) - radius, 1e-3);
+        vec3 pa = a * (plane / max(dot(a, toward), 1e-3));
+        vec3 pb = b * (plane / max(dot(b, toward), 1e-3));
+        float ra = radius * plane / depth_a;
+        float rb = radius * plane / depth_b;
+
+        vec3 along = pb - pa;
+        along -= toward * dot(along, toward);
+        float along_length = length(along);
+        along = along_length > 1e-5 ? along / along_length
+                                    : normalize(cross(toward, abs(toward.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+        vec3 across = cross(toward, along);
+
+        float y_lo = min(dot(pa - mid, along) - ra, dot(pb - mid, along) - rb);
+        float y_hi = max(dot(pa - mid, along) + ra, dot(pb - mid, along) + rb);
+        float x_extent = max(ra, rb);
+        float y = aCorner.y < 0.0 ? y_lo : y_hi;
+        vViewPos = mid + along * y + across * (aCorner.x * x_extent);
+        gl_Position = uProjectionMatrix * vec4(vViewPos, 1.0);
+        vStartRadius_view = vec4(a, radius);
+        vEnd_view = b;
+        vColor = aColor;
+    }
+)glsl";
+
+const char* cylinder_impostor_fragment_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS R"glsl(
+    precision highp float;
+
+    in vec3 vViewPos;
+    flat in vec4 vStartRadius_view;
+    flat in vec3 vEnd_view;
+    flat in vec3 vColor;
+
+    out vec4 fragColor;
+
+    void main() {
+        // Capped cylinder intersection with the ray from the eye (origin)
+        vec3 rd = normalize(vViewPos);
+        vec3 a = vStartRadius_view.xyz;
+        float radius = vStartRadius_view.w;
+        vec3 ba = vEnd_view - a;
+        vec3 oc = -a;
+        float baba = dot(ba, ba);
+        float bard = dot(ba, rd);
+        float baoc = dot(ba, oc);
+        float k2 = baba - bard * bard;
+        float k1 = baba * dot(oc, rd) - baoc * bard;
+        float k0 = baba * dot(oc, oc) - baoc * baoc - radius * radius * baba;
+        float h = k1 * k1 - k2 * k0;
+        if (h < 0.0) discard;
+        h = sqrt(h);
+        float t = (-k1 - h) / k2;
+        float y = baoc + t * bard;
+        vec3 normal_view;
+        if (y > 0.0 && y < baba) {
+            normal_view = (oc + t * rd - ba * y / baba) / radius;
+        } else {
+            t = ((y < 0.0 ? 0.0 : baba) - baoc) / bard;
+            if (abs(k1 + k2 * t) >= h) discard;
+            normal_view = ba * sign(y) / sqrt(baba);
+        }
+        if (t <= 0.0) discard;
+        vec3 hit = rd * t;
+
+        vec4 clip = uProjectionMatrix * vec4(hit, 1.0);
+        gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+
+        float diffuse_intensity = max(dot(normal_view, uLightDir_view.xyz), 0.0) * uMaterial.y;
+        fragColor = vec4(vColor * (uMaterial.x + diffuse_intensity), 1.0);
+    }
+)glsl";
+
+// Molecular surface: world-space vertices carrying their own normal and color, shaded with
+// instance_fragment_shader_source like the atoms
+const char* surface_vertex_shader_source = "#version 300 es\n" GLSL_UNIFORM_BLOCKS R"glsl(
+
+    layout(location = 0) in vec3 aPosition;
+    layout(location = 1) in vec3 aNormal;
+    layout(location = 3) in vec3 aColor; // Per vertex, normalized RGBA8
+
+    out vec3 vNormal_world;
+    out vec3 vColor;
+
+    void main() {
+        gl_Position = uViewProjectionMatrix * vec4(aPosition, 1.0);
+        vNormal_world = aNormal;
+        vColor = aColor;
     }
 )glsl";
 
@@ -90,4 +315,16 @@ GLuint create_shader_program(const char* vs_source, const char* fs_source) {
     glDeleteShader(vs);
     glDeleteShader(fs);
     return program;
-} 
\ No newline at end of file
+} 
+
+ShaderProgram create_program(const char* vs_source, const char* fs_source) {
+    ShaderProgram result;
+    result.program = create_shader_program(vs_source, fs_source);
+    if (!result.program) return result;
+    // Blocks a program never reads are optimized out and report GL_INVALID_INDEX
+    GLuint frame_block = glGetUniformBlockIndex(result.program, "FrameUniforms");
+    if (frame_block != GL_INVALID_INDEX) glUniformBlockBinding(result.program, frame_block, FRAME_UNIFORM_BINDING);
+    GLuint material_block = glGetUniformBlockIndex(result.program, "MaterialUniforms");
+    if (material_block != GL_INVALID_INDEX) glUniformBlockBinding(result.program, material_block, MATERIAL_UNIFORM_BINDING);
+    return result;
+}
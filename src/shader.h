@@ -2,9 +2,54 @@
 #include <GLES3/gl3.h>
 
 // Shader source code
-extern const char* vertex_shader_source;
-extern const char* fragment_shader_source;
+extern const char* sphere_instance_vertex_shader_source;
+extern const char* cylinder_instance_vertex_shader_source;
+extern const char* instance_fragment_shader_source;
+extern const char* sphere_impostor_vertex_shader_source;
+extern const char* sphere_impostor_fragment_shader_source;
+extern const char* cylinder_impostor_vertex_shader_source;
+extern const char* cylinder_impostor_fragment_shader_source;
+extern const char* surface_vertex_shader_source;
+
+// Fixed vertex attribute locations shared by every program
+const GLuint ATTRIB_POSITION = 0; // Mesh position, or quad corner for impostors
+const GLuint ATTRIB_NORMAL = 1;
+const GLuint ATTRIB_INSTANCE_CENTER_RADIUS = 2; // Sphere center or cylinder start, plus radius
+const GLuint ATTRIB_INSTANCE_COLOR = 3;
+const GLuint ATTRIB_INSTANCE_END = 4;           // Cylinder end
+const GLuint ATTRIB_VERTEX_COLOR = 3;           // Per-vertex color of the surface mesh, in the instance color slot
+
+// std140 uniform blocks shared by every program, each attached once to a fixed binding point
+const GLuint FRAME_UNIFORM_BINDING = 0;    // FrameUniforms: camera and light, uploaded once per frame
+const GLuint MATERIAL_UNIFORM_BINDING = 1; // MaterialUniforms: shading parameters of the representation
+
+// CPU mirror of the FrameUniforms block (std140: mat4 = 64 bytes, vec4 = 16 bytes)
+struct FrameUniforms {
+    float view[16];
+    float projection[16];
+    float view_projection[16];
+    float light_dir_world[4]; // xyz normalized, w unused
+    float light_dir_view[4];  // The same light in view space, for the impostors
+    float cell[3][4];         // Lattice vectors a, b, c in xyz; images drawn along each in w
+};
+
+// CPU mirror of the MaterialUniforms block
+struct MaterialUniforms {
+    float ambient;
+    float diffuse;
+    float padding[2];
+};
+
+// A linked program. All of its uniforms live in the shared blocks, so there are no per-program
+// uniform locations to keep.
+struct ShaderProgram {
+    GLuint program = 0;
+
+    explicit operator bool() const { return program != 0; }
+};
 
 // Functions
 GLuint compile_shader(GLenum type, const char* source);
-GLuint create_shader_program(const char* vs_source, const char* fs_source); 
\ No newline at end of file
+GLuint create_shader_program(const char* vs_source, const char* fs_source);
+// Links the program and attaches the shared uniform blocks
+ShaderProgram create_program(const char* vs_source, const char* fs_source); 
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+
+// Compile-time SIMD backends for the math kernels. Each backend is a struct of static functions
+// over its vector type V holding WIDTH floats; kernels are templates over the backend, so the
+// choice costs nothing at run time and the scalar backend stays available for comparison.
+//  - SimdWasm: WebAssembly SIMD128 (emcc -msimd128, on by default in the Makefile)
+//  - SimdSse:  SSE2, the x86-64 baseline
+//  - SimdAvx:  AVX2 (+FMA), 8 lanes, native builds with -mavx2
+//  - SimdScalar: plain floats in groups of 4, used when none of the above is available
+// Loads and stores are unaligned, so kernels can start anywhere in a std::vector<float>.
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+struct SimdScalar {
+    static const int WIDTH = 4;
+    struct V { float v[4]; };
+    static V load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    static void store(float* p, V a) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+    static V splat(float s) { return {{s, s, s, s}}; }
+    static V add(V a, V b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+    static V sub(V a, V b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+    static V mul(V a, V b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+    static V madd(V a, V b, V c) { return add(mul(a, b), c); } // a * b + c
+    static V min(V a, V b) {
+        return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}};
+    }
+    static V max(V a, V b) {
+        return {{std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])}};
+    }
+    static float reduce_min(V a) { return std::min(std::min(a.v[0], a.v[1]), std::min(a.v[2], a.v[3])); }
+    static float reduce_max(V a) { return std::max(std::max(a.v[0], a.v[1]), std::max(a.v[2], a.v[3])); }
+};
+
+#if defined(__wasm_simd128__)
+struct SimdWasm {
+    static const int WIDTH = 4;
+    typedef v128_t V;
+    static V load(const float* p) { return wasm_v128_load(p); }
+    static void store(float* p, V a) { wasm_v128_store(p, a); }
+    static V splat(float s) { return wasm_f32x4_splat(s); }
+    static V add(V a, V b) { return wasm_f32x4_add(a, b); }
+    static V sub(V a, V b) { return wasm_f32x4_sub(a, b); }
+    static V mul(V a, V b) { return wasm_f32x4_mul(a, b); }
+    static V madd(V a, V b, V c) { return wasm_f32x4_add(wasm_f32x4_mul(a, b), c); }
+    // pmin/pmax are single instructions; min/max add NaN and signed-zero handling we never need
+    static V min(V a, V b) { return wasm_f32x4_pmin(a, b); }
+    static V max(V a, V b) { return wasm_f32x4_pmax(a, b); }
+    static float reduce_min(V a) {
+        V m = wasm_f32x4_pmin(a, wasm_i32x4_shuffle(a, a, 2, 3, 0, 1));
+        m = wasm_f32x4_pmin(m, wasm_i32x4_shuffle(m, m, 1, 0, 3, 2));
+        return wasm_f32x4_extract_lane(m, 0);
+    }
+    static float reduce_max(V a) {
+        V m = wasm_f32x4_pmax(a, wasm_i32x4_shuffle(a, a, 2, 3, 0, 1));
+        m = wasm_f32x4_pmax(m, wasm_i32x4_shuffle(m, m, 1, 0, 3, 2));
+        return wasm_f32x4_extract_lane(m, 0);
+    }
+};
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+struct SimdSse {
+    static const int WIDTH = 4;
+    typedef __m128 V;
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V a) { _mm_storeu_ps(p, a); }
+    static V splat(float s) { return _mm_set1_ps(s); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V madd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static float reduce_min(V a) {
+        V m = _mm_min_ps(a, _mm_movehl_ps(a, a));
+        m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+        return _mm_cvtss_f32(m);
+    }
+    static float reduce_max(V a) {
+        V m = _mm_max_ps(a, _mm_movehl_ps(a, a));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        return _mm_cvtss_f32(m);
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+struct SimdAvx {
+    static const int WIDTH = 8;
+    typedef __m256 V;
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V a) { _mm256_storeu_ps(p, a); }
+    static V splat(float s) { return _mm256_set1_ps(s); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+    static V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+    static V madd(V a, V b, V c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static float reduce_min(V a) {
+        return SimdSse::reduce_min(_mm_min_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+    }
+    static float reduce_max(V a) {
+        return SimdSse::reduce_max(_mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+    }
+};
+#endif
+
+// Simd4 is the best 4-lane backend (for Mat4 columns); SimdNative the widest, for batched kernels
+#if defined(__wasm_simd128__)
+typedef SimdWasm Simd4;
+#elif defined(__SSE2__) || defined(_M_X64)
+typedef SimdSse Simd4;
+#else
+typedef SimdScalar Simd4;
+#endif
+
+#if defined(__AVX2__)
+typedef SimdAvx SimdNative;
+#else
+typedef Simd4 SimdNative;
+#endif
@@ -0,0 +1,109 @@
+#include "surface_atoms.h"
+#include "neighbor.h"
+#include "parallel.h"
+#include "math.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+const int SURFACE_SAMPLE_COUNT = 256;
+
+// The sampled lattice leaves no surface point further than 0.77 * sqrt(4 pi / N) * r (measured)
+// from a sample; the margin rounds that factor up to 1
+const float SURFACE_SAMPLE_MARGIN = 0.2216f; // sqrt(4 * pi / 256)
+
+struct SampleSphere {
+    float x[SURFACE_SAMPLE_COUNT], y[SURFACE_SAMPLE_COUNT], z[SURFACE_SAMPLE_COUNT];
+
+    SampleSphere() {
+        // Stored in a strided order so the first few tests are spread over the whole sphere and
+        // exposed atoms are rejected early
+        const float golden_angle = PI * (3.0f - std::sqrt(5.0f));
+        for (int k = 0; k < SURFACE_SAMPLE_COUNT; ++k) {
+            int i = (k * 97) % SURFACE_SAMPLE_COUNT;
+            float zi = 1.0f - (i + 0.5f) * 2.0f / SURFACE_SAMPLE_COUNT;
+            float ring = std::sqrt(1.0f - zi * zi);
+            x[k] = ring * std::cos(golden_angle * i);
+            y[k] = ring * std::sin(golden_angle * i);
+            z[k] = zi;
+        }
+    }
+};
+
+struct Neighbor {
+    float x, y, z;
+    float covered_radius_sq; // (r_j - margin)^2
+    float overlap;           // Depth of the shrunken neighbor's reach into sphere i
+};
+
+inline bool in_sphere(float px, float py, float pz, const Neighbor& nb) {
+    float dx = px - nb.x, dy = py - nb.y, dz = pz - nb.z;
+    return dx * dx + dy * dy + dz * dz <= nb.covered_radius_sq;
+}
+
+bool sphere_buried(float cx, float cy, float cz, float radius, const std::vector<Neighbor>& neighbors, const SampleSphere& samples) {
+    size_t last_cover = 0; // Consecutive samples are often covered by the same neighbor
+    for (int k = 0; k < SURFACE_SAMPLE_COUNT; ++k) {
+        float px = cx + samples.x[k] * radius;
+        float py = cy + samples.y[k] * radius;
+        float pz = cz + samples.z[k] * radius;
+        if (in_sphere(px, py, pz, neighbors[last_cover])) continue;
+        bool covered = false;
+        for (size_t j = 0; j < neighbors.size() && !covered; ++j) {
+            if (in_sphere(px, py, pz, neighbors[j])) {
+                covered = true;
+                last_cover = j;
+            }
+        }
+        if (!covered) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+size_t find_buried_atoms(const AtomArrays& atoms, const std::vector<float>& radii, std::vector<uint8_t>& buried) {
+    const size_t n = atoms.size();
+    buried.assign(n, 0);
+    if (n < 2) return 0;
+    static const SampleSphere samples;
+    float max_radius = *std::max_element(radii.begin(), radii.end());
+    if (max_radius <= 0.0f) return 0;
+
+    CellGrid grid;
+    grid.build(atoms, 2.0f * max_radius); // Spheres can only overlap within r_i + r_j
+    std::atomic<size_t> buried_count(0);
+
+    parallel_for(n, 2048, [&](size_t begin, size_t end) {
+        std::vector<Neighbor> neighbors;
+        size_t local_count = 0;
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t i = grid.cell_atoms[k]; // Cell order keeps consecutive atoms' neighbors in cache
+            const float xi = atoms.x[i], yi = atoms.y[i], zi = atoms.z[i];
+            const float ri = radii[i];
+            const float margin = SURFACE_SAMPLE_MARGIN * ri;
+            neighbors.clear();
+            grid.for_each_candidate(xi, yi, zi, [&](uint32_t j) {
+                if (j == i) return;
+                float rj_inner = radii[j] - margin;
+                if (rj_inner <= 0.0f) return;
+                float dx = atoms.x[j] - xi, dy = atoms.y[j] - yi, dz = atoms.z[j] - zi;
+                float reach = ri + rj_inner; // Neighbor must reach past the sphere to cover any of it
+                float d2 = dx * dx + dy * dy + dz * dz;
+                if (d2 < reach * reach) {
+                    neighbors.push_back({atoms.x[j], atoms.y[j], atoms.z[j], rj_inner * rj_inner, reach - std::sqrt(d2)});
+                }
+            });
+            // Deeply overlapping neighbors cover the most samples, so try them first
+            std::sort(neighbors.begin(), neighbors.end(), [](const Neighbor& a, const Neighbor& b) { return a.overlap > b.overlap; });
+            if (!neighbors.empty() && sphere_buried(xi, yi, zi, ri, neighbors, samples)) {
+                buried[i] = 1;
+                local_count++;
+            }
+        }
+        buried_count += local_count;
+    });
+    return buried_count;
+}
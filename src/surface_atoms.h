@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "molecule.h"
+
+// Flags atoms (buried[i] = 1) whose display sphere lies entirely inside the union of other
+// atoms' spheres, so they can never be seen from a camera outside the molecule.
+//
+// Each sphere is tested at points of a Fibonacci lattice. A point counts as covered only when
+// it is at least `margin` inside a neighbor, where margin exceeds the largest distance from
+// any surface point to its nearest sample. That makes a sampled "buried" result exact for the
+// whole sphere, so removing buried atoms never changes the rendered image. Neighbors come from
+// a CellGrid and atoms are processed with parallel_for. Returns the number of buried atoms.
+size_t find_buried_atoms(const AtomArrays& atoms, const std::vector<float>& radii, std::vector<uint8_t>& buried);
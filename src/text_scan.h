@@ -0,0 +1,153 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+
+// Allocation-free helpers for walking a text buffer (const char* range, not NUL-terminated).
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p)) ++p;
+    return p;
+}
+
+inline const char* skip_token(const char* p, const char* end) {
+    while (p < end && !is_blank(*p)) ++p;
+    return p;
+}
+
+// Iterates over the lines of a buffer. Line ends exclude '\n' and a trailing '\r'.
+struct LineReader {
+    const char* cur;
+    const char* end;
+    int line_number = 0; // 1-based number of the line most recently returned
+
+    LineReader(const char* begin, const char* end) : cur(begin), end(end) {}
+
+    bool next(const char*& line_begin, const char*& line_end) {
+        if (cur >= end) return false;
+        line_begin = cur;
+        const char* nl = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+        line_end = nl ? nl : end;
+        cur = nl ? nl + 1 : end;
+        if (line_end > line_begin && line_end[-1] == '\r') --line_end;
+        line_number++;
+        return true;
+    }
+    bool at_end() const { return cur >= end; }
+};
+
+// Parses a signed decimal integer at p, advancing p past it.
+inline bool parse_int(const char*& p, const char* end, int& out) {
+    if (p < end && *p == '+') ++p; // from_chars rejects a leading '+'
+    auto result = std::from_chars(p, end, out);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// Slow path for parse_float: exact conversion of one whitespace-delimited token. Both
+// from_chars and strtof accept "nan", "inf" and "infinity" (and strtof overflows to inf);
+// those are rejected, as no coordinate or field read through here may be non-finite.
+inline bool parse_float_slow(const char*& p, const char* end, float& out) {
+    const char* token_end = skip_token(p, end);
+    const char* s = (p < token_end && *p == '+') ? p + 1 : p;
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(s, token_end, out);
+    if (result.ec != std::errc() || result.ptr != token_end) return false;
+#else
+    char buffer[64];
+    size_t len = static_cast<size_t>(token_end - s);
+    if (len == 0 || len >= sizeof(buffer)) return false;
+    std::memcpy(buffer, s, len);
+    buffer[len] = '\0';
+    char* parse_end = nullptr;
+    out = std::strtof(buffer, &parse_end);
+    if (parse_end != buffer + len) return false;
+#endif
+    if (!std::isfinite(out)) return false;
+    p = token_end;
+    return true;
+}
+
+// Parses a decimal float token at p, advancing p past it. Plain decimals whose digits fit
+// in 24 bits (the common XYZ/PDB case) are converted exactly with one float multiply or
+// divide (Clinger's fast path); everything else goes through parse_float_slow.
+inline bool parse_float(const char*& p, const char* end, float& out) {
+    static const float POW10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+')) { negative = (*s == '-'); ++s; }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digit_count = 0;
+    bool overflow = false;
+    for (; s < end && is_digit(*s); ++s, ++digit_count) {
+        if (mantissa > (UINT64_MAX - 9) / 10) { overflow = true; exponent++; continue; }
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+    }
+    if (s < end && *s == '.') {
+        for (++s; s < end && is_digit(*s); ++s, ++digit_count) {
+            if (mantissa > (UINT64_MAX - 9) / 10) { overflow = true; continue; }
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+            exponent--;
+        }
+    }
+    if (digit_count == 0) return parse_float_slow(p, end, out); // "nan", "inf", or garbage
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool exp_negative = false;
+        if (e < end && (*e == '-' || *e == '+')) { exp_negative = (*e == '-'); ++e; }
+        if (e >= end || !is_digit(*e)) return parse_float_slow(p, end, out);
+        int exp_value = 0;
+        for (; e < end && is_digit(*e); ++e) {
+            if (exp_value < 10000) exp_value = exp_value * 10 + (*e - '0');
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+        s = e;
+    }
+    if (s < end && !is_blank(*s)) return parse_float_slow(p, end, out); // e.g. Fortran "1.0d0"
+    if (overflow || mantissa > (1u << 24) || exponent < -10 || exponent > 10) {
+        return parse_float_slow(p, end, out);
+    }
+
+    float value = static_cast<float>(mantissa); // Exact: mantissa <= 2^24
+    value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+    out = negative ? -value : value;
+    p = s;
+    return true;
+}
+
+// Fixed-column field [first_col, last_col] (1-based, inclusive, as in the PDB and MDL
+// specifications), clipped to the line length
+inline void column_field(const char* line_begin, const char* line_end, int first_col, int last_col,
+                         const char*& field_begin, const char*& field_end) {
+    size_t line_length = static_cast<size_t>(line_end - line_begin);
+    size_t b = static_cast<size_t>(first_col - 1) < line_length ? static_cast<size_t>(first_col - 1) : line_length;
+    size_t e = static_cast<size_t>(last_col) < line_length ? static_cast<size_t>(last_col) : line_length;
+    field_begin = line_begin + b;
+    field_end = line_begin + e;
+}
+
+inline bool parse_column_float(const char* line_begin, const char* line_end, int first_col, int last_col, float& out) {
+    const char* b;
+    const char* e;
+    column_field(line_begin, line_end, first_col, last_col, b, e);
+    b = skip_blanks(b, e);
+    while (e > b && is_blank(e[-1])) --e;
+    return b < e && parse_float(b, e, out) && b == e;
+}
+
+inline bool parse_column_int(const char* line_begin, const char* line_end, int first_col, int last_col, int& out) {
+    const char* b;
+    const char* e;
+    column_field(line_begin, line_end, first_col, last_col, b, e);
+    b = skip_blanks(b, e);
+    return b < e && parse_int(b, e, out);
+}
@@ -0,0 +1,255 @@
+#include "trajectory.h"
+#include "parser.h"
+#include "renderer.h"
+#include "xyz_reader.h"
+#include "neighbor.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+Trajectory current_trajectory;
+static std::vector<float> position_staging; // Backs acquire_position_buffer; only ever grows
+
+void XyzFrameIndexer::begin(size_t atoms, Trajectory& target, int first_line) {
+    traj = &target;
+    traj->frame_offsets.clear();
+    traj->frame_first_line.clear();
+    traj->atom_count = atoms;
+    atom_count = atoms;
+    scanned = 0;
+    lines_left = 0;
+    line_number = first_line - 1;
+    done = false;
+}
+
+void XyzFrameIndexer::scan(const char* data, size_t length, bool at_end) {
+    if (done) return;
+    const char* end = data + length;
+    if (!at_end) { // Leave a partial last line for the next call
+        while (end > data + scanned && end[-1] != '\n') --end;
+    }
+    LineReader reader(data + scanned, end);
+    reader.line_number = line_number;
+    const char* line_begin;
+    const char* line_end;
+    while (reader.next(line_begin, line_end)) {
+        if (lines_left > 0) { // Skip the comment line and the atom lines without parsing them
+            if (--lines_left == 0) {
+                traj->frame_offsets.push_back(frame_offset);
+                traj->frame_first_line.push_back(frame_line);
+            }
+            continue;
+        }
+        const char* p = skip_blanks(line_begin, line_end);
+        if (p == line_end) continue; // Blank separator lines between frames
+
+        int num_atoms = 0;
+        if (!parse_int(p, line_end, num_atoms) || static_cast<size_t>(num_atoms) != atom_count) {
+            std::cerr << "XYZ Trajectory Warning (Line " << reader.line_number << "): Expected a frame of " << atom_count
+                      << " atoms; stopping after " << traj->frame_offsets.size() << " frames." << std::endl;
+            done = true;
+            break;
+        }
+        frame_offset = static_cast<size_t>(line_begin - data);
+        frame_line = reader.line_number;
+        lines_left = atom_count + 1;
+    }
+    scanned = static_cast<size_t>(reader.cur - data);
+    line_number = reader.line_number;
+    if (at_end && lines_left > 0 && !done) {
+        std::cerr << "XYZ Trajectory Warning: Truncated final frame ignored." << std::endl;
+        done = true;
+    }
+}
+
+void index_xyz_frames(const char* data, size_t length, size_t atom_count, Trajectory& traj) {
+    XyzFrameIndexer indexer;
+    indexer.begin(atom_count, traj);
+    indexer.scan(data, length, true);
+}
+
+void begin_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer, const Molecule& first_frame, int next_line) {
+    traj.clear();
+    indexer.begin(first_frame.atoms.size(), traj, next_line);
+    const AtomArrays& atoms = first_frame.atoms;
+    traj.first_frame.reserve(3 * atoms.size());
+    traj.first_frame.insert(traj.first_frame.end(), atoms.x.begin(), atoms.x.end());
+    traj.first_frame.insert(traj.first_frame.end(), atoms.y.begin(), atoms.y.end());
+    traj.first_frame.insert(traj.first_frame.end(), atoms.z.begin(), atoms.z.end());
+    traj.frame_offsets.push_back(0); // Frame 0 comes from first_frame, not from the text
+    traj.frame_first_line.push_back(1);
+}
+
+bool append_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer, const char* data, size_t length) {
+    if (indexer.stopped()) return false;
+    traj.text.append(data, length);
+    indexer.scan(traj.text.data(), traj.text.size(), false);
+    return !indexer.stopped();
+}
+
+void finish_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer) {
+    indexer.scan(traj.text.data(), traj.text.size(), true);
+    if (traj.frame_count() <= 1) traj.clear(); // Single structure: drop the trailing text
+}
+
+// Returns the coordinates of a frame, decoding it into the least recently used cache slot on a miss
+static const std::vector<float>* get_frame_positions(Trajectory& traj, int frame) {
+    if (frame == 0 && !traj.first_frame.empty()) return &traj.first_frame;
+    for (auto& cached : traj.cache) {
+        if (cached.frame == frame) {
+            cached.last_used = ++traj.use_counter;
+            return &cached.positions;
+        }
+    }
+
+    Trajectory::CachedFrame* slot = nullptr;
+    if (traj.cache.size() < TRAJECTORY_CACHE_FRAMES) {
+        traj.cache.emplace_back();
+        slot = &traj.cache.back();
+    } else {
+        slot = &traj.cache[0];
+        for (auto& cached : traj.cache) {
+            if (cached.last_used < slot->last_used) slot = &cached;
+        }
+    }
+
+    slot->positions.resize(traj.atom_count * 3); // Reuses the evicted frame's storage
+    LineReader reader(traj.text.data() + traj.frame_offsets[frame], traj.text.data() + traj.text.size());
+    reader.line_number = traj.frame_first_line[frame] - 1;
+    float* x = slot->positions.data();
+    if (!parse_xyz_frame_positions(reader, traj.atom_count, x, x + traj.atom_count, x + 2 * traj.atom_count)) {
+        slot->frame = -1;
+        return nullptr;
+    }
+    slot->frame = frame;
+    slot->last_used = ++traj.use_counter;
+    return &slot->positions;
+}
+
+bool apply_trajectory_frame(int frame) {
+    Trajectory& traj = current_trajectory;
+    if (frame < 0 || frame >= traj.frame_count()) return false;
+    if (current_molecule.atoms.size() != traj.atom_count) return false;
+
+    const std::vector<float>* positions = get_frame_positions(traj, frame);
+    if (!positions) return false;
+    const float* x = positions->data();
+    const size_t n = traj.atom_count;
+    std::copy(x, x + n, current_molecule.atoms.x.begin());
+    std::copy(x + n, x + 2 * n, current_molecule.atoms.y.begin());
+    std::copy(x + 2 * n, x + 3 * n, current_molecule.atoms.z.begin());
+    // Bonds form and break with the coordinates; between list rebuilds this costs O(N)
+    traj.bond_list.update_bonds(current_molecule);
+    mark_atom_coordinates_dirty();
+    traj.current_frame = frame;
+    return true;
+}
+
+void update_trajectory_playback(double delta_time) {
+    Trajectory& traj = current_trajectory;
+    if (!traj.playing || traj.frame_count() < 2) return;
+
+    traj.frame_accumulator += delta_time * traj.playback_fps;
+    int steps = static_cast<int>(traj.frame_accumulator);
+    if (steps <= 0) return;
+    traj.frame_accumulator -= steps;
+    int next_frame = (traj.current_frame + steps) % traj.frame_count(); // Loop at the end
+    if (!apply_trajectory_frame(next_frame)) {
+        traj.playing = false;
+        std::cerr << "C++: Trajectory playback stopped at frame " << next_frame << "." << std::endl;
+    }
+}
+
+extern "C" {
+EMSCRIPTEN_KEEPALIVE
+void load_trajectory_from_xyz_string(const char* xyz_data_str) {
+    // Frame 0 goes through the regular loader (atoms, bonds, formula); this also clears any previous trajectory
+    load_molecule_from_xyz_string(xyz_data_str);
+    if (current_molecule.atoms.empty()) return;
+
+    Trajectory& traj = current_trajectory;
+    size_t length = std::strlen(xyz_data_str);
+    index_xyz_frames(xyz_data_str, length, current_molecule.atoms.size(), traj);
+    if (traj.frame_count() <= 1) {
+        traj.clear(); // Single structure: no need to keep the text around
+        return;
+    }
+    traj.text.assign(xyz_data_str, length);
+    std::cout << "C++: Indexed trajectory with " << traj.frame_count() << " frames of " << traj.atom_count << " atoms." << std::endl;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_trajectory_frame_count() {
+    return current_trajectory.frame_count();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int get_trajectory_current_frame() {
+    return current_trajectory.current_frame;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_trajectory_frame(int frame) {
+    if (!apply_trajectory_frame(frame)) {
+        std::cerr << "C++: Invalid trajectory frame: " << frame << std::endl;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void play_trajectory(float fps) {
+    if (fps <= 0.0f || current_trajectory.frame_count() < 2) {
+        std::cerr << "C++: Cannot play trajectory (fps " << fps << ", " << current_trajectory.frame_count() << " frames)." << std::endl;
+        return;
+    }
+    current_trajectory.playback_fps = fps;
+    current_trajectory.playing = true;
+    current_trajectory.frame_accumulator = 0.0;
+    std::cout << "C++: Trajectory playing at " << fps << " fps" << std::endl;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void pause_trajectory() {
+    current_trajectory.playing = false;
+    std::cout << "C++: Trajectory paused at frame " << current_trajectory.current_frame << std::endl;
+}
+
+EMSCRIPTEN_KEEPALIVE
+float* acquire_position_buffer(int atom_count) {
+    if (atom_count <= 0) return nullptr;
+    size_t needed = static_cast<size_t>(atom_count) * 3;
+    if (position_staging.size() < needed) position_staging.resize(needed);
+    return position_staging.data();
+}
+
+// Returns 1 on success, 0 if the count does not match the loaded molecule
+EMSCRIPTEN_KEEPALIVE
+int update_atom_positions(const float* xyz, int atom_count) {
+    AtomArrays& atoms = current_molecule.atoms;
+    if (!xyz || atom_count <= 0 || static_cast<size_t>(atom_count) != atoms.size()) {
+        std::cerr << "C++: update_atom_positions: expected " << atoms.size() << " atoms, got " << atom_count << std::endl;
+        return 0;
+    }
+    // Streamed frames take over from any trajectory being played back
+    current_trajectory.playing = false;
+    float* x = atoms.x.data();
+    float* y = atoms.y.data();
+    float* z = atoms.z.data();
+    for (int i = 0; i < atom_count; ++i) {
+        x[i] = xyz[3 * i];
+        y[i] = xyz[3 * i + 1];
+        z[i] = xyz[3 * i + 2];
+    }
+    mark_atom_coordinates_streamed();
+    return 1;
+}
+
+// Replaces the bonds with ones perceived from the current coordinates, for when streamed
+// frames have moved atoms far enough to make or break bonds
+EMSCRIPTEN_KEEPALIVE
+void invalidate_topology() {
+    current_molecule.bonds.clear();
+    generate_bonds(current_molecule);
+    mark_instances_dirty();
+    std::cout << "C++: Re-perceived " << current_molecule.bonds.size() << " bonds." << std::endl;
+}
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <emscripten/emscripten.h>
+#include "neighbor.h"
+
+// Maximum number of decoded frames kept in memory, independent of trajectory length
+const size_t TRAJECTORY_CACHE_FRAMES = 4;
+
+// Multi-frame XYZ trajectory. The text is indexed once (byte offset per frame) and frames
+// are decoded lazily into a small LRU cache of coordinate arrays.
+struct Trajectory {
+    std::string text;                  // Owned copy of the file contents
+    std::vector<size_t> frame_offsets; // Byte offset of each frame's atom count line
+    std::vector<int> frame_first_line; // Line number of each frame's count line, for error messages
+    size_t atom_count = 0;
+    int current_frame = 0;
+
+    // Playback state, advanced from render_frame
+    bool playing = false;
+    float playback_fps = 10.0f;
+    double frame_accumulator = 0.0;
+
+    struct CachedFrame {
+        int frame = -1;
+        uint64_t last_used = 0;
+        std::vector<float> positions; // All x, then all y, then all z (matching AtomArrays)
+    };
+    std::vector<CachedFrame> cache;
+    uint64_t use_counter = 0;
+
+    // Frame 0 coordinates (same layout as CachedFrame) when text starts at frame 1, as it does
+    // for streamed files whose first frame was parsed before the rest arrived
+    std::vector<float> first_frame;
+
+    // Bonds are re-perceived per frame against this list, rebuilt only when atoms moved far
+    BondNeighborList bond_list;
+
+    int frame_count() const { return static_cast<int>(frame_offsets.size()); }
+    void clear() {
+        text.clear(); text.shrink_to_fit();
+        frame_offsets.clear();
+        frame_first_line.clear();
+        cache.clear();
+        first_frame.clear(); first_frame.shrink_to_fit();
+        bond_list.clear();
+        atom_count = 0;
+        current_frame = 0;
+        playing = false;
+        frame_accumulator = 0.0;
+    }
+};
+
+extern Trajectory current_trajectory;
+
+// Scans an XYZ buffer for consecutive frames of atom_count atoms, recording their offsets
+void index_xyz_frames(const char* data, size_t length, size_t atom_count, Trajectory& traj);
+
+// Resumable form of index_xyz_frames for text that arrives in chunks. Each scan() is given the
+// whole text so far and indexes the complete lines added since the previous call; the final
+// call passes at_end so a last line without a newline counts too.
+class XyzFrameIndexer {
+public:
+    void begin(size_t atom_count, Trajectory& traj, int first_line = 1);
+    void scan(const char* data, size_t length, bool at_end);
+    bool stopped() const { return done; } // A frame of the wrong size or a truncated frame ended the trajectory
+
+private:
+    Trajectory* traj = nullptr;
+    size_t atom_count = 0;
+    size_t scanned = 0;      // Text before this offset has been indexed
+    size_t lines_left = 0;   // Comment and atom lines still to come in the current frame
+    size_t frame_offset = 0;
+    int frame_line = 0;
+    int line_number = 0;
+    bool done = false;
+};
+
+// Streamed XYZ loads: frame 0 has been parsed into first_frame (its text is not kept) and the
+// rest of the file is appended to traj.text and indexed as it arrives
+void begin_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer, const Molecule& first_frame, int next_line);
+bool append_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer, const char* data, size_t length); // False once indexing stopped
+void finish_streamed_trajectory(Trajectory& traj, XyzFrameIndexer& indexer);
+
+// Decodes (or fetches from cache) a frame and copies its coordinates into current_molecule
+bool apply_trajectory_frame(int frame);
+
+// Advances playback by the elapsed time; called once per rendered frame
+void update_trajectory_playback(double delta_time);
+
+// Streaming coordinate updates for live simulations. JS fills the staging buffer in place and
+// then commits it, so a frame costs one copy into the heap and no allocation:
+//
+//   const ptr = Module._acquire_position_buffer(n);            // Once, or after n changes
+//   const xyz = new Float32Array(Module.HEAPF32.buffer, ptr, 3 * n);
+//   // per step: xyz.set(frame); Module._update_atom_positions(ptr, n);
+//
+// The view must be recreated if memory grows. Atoms are interleaved x, y, z in the order of the
+// loaded molecule; bonds are kept until invalidate_topology() re-perceives them.
+extern "C" {
+    EMSCRIPTEN_KEEPALIVE
+    float* acquire_position_buffer(int atom_count);
+
+    EMSCRIPTEN_KEEPALIVE
+    int update_atom_positions(const float* xyz, int atom_count);
+
+    EMSCRIPTEN_KEEPALIVE
+    void invalidate_topology();
+}
+
+extern "C" {
+    EMSCRIPTEN_KEEPALIVE
+    void load_trajectory_from_xyz_string(const char* xyz_data_str);
+
+    EMSCRIPTEN_KEEPALIVE
+    int get_trajectory_frame_count();
+
+    EMSCRIPTEN_KEEPALIVE
+    int get_trajectory_current_frame();
+
+    EMSCRIPTEN_KEEPALIVE
+    void set_trajectory_frame(int frame);
+
+    EMSCRIPTEN_KEEPALIVE
+    void play_trajectory(float fps);
+
+    EMSCRIPTEN_KEEPALIVE
+    void pause_trajectory();
+}
@@ -0,0 +1,327 @@
+#include "xyz_reader.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <vector>
+
+void XyzFrameParser::begin(Molecule& out) {
+    target = &out;
+    state = State::Count;
+    num_atoms = 0;
+    atoms_read = 0;
+}
+
+bool XyzFrameParser::consume_line(const char* line_begin, const char* line_end, int line_number) {
+    Molecule& out = *target;
+    const char* p = skip_blanks(line_begin, line_end);
+    switch (state) {
+    case State::Count: {
+        // Line 1: Number of atoms
+        if (p == line_end) {
+            std::cerr << "XYZ Parse Error (Line " << line_number << "): Number of atoms line is empty." << std::endl; return false;
+        }
+        if (!parse_int(p, line_end, num_atoms)) {
+            std::cerr << "XYZ Parse Error (Line " << line_number << "): Invalid number format. Line content: \""
+                      << std::string(line_begin, line_end) << "\"" << std::endl;
+            return false;
+        }
+        if (num_atoms <= 0) {
+            std::cerr << "XYZ Parse Error (Line " << line_number << "): Invalid number of atoms: " << num_atoms << std::endl; return false;
+        }
+        state = State::Comment;
+        return true;
+    }
+    case State::Comment: {
+        // Line 2: Comment line (potential name), trimmed
+        const char* name_end = line_end;
+        while (name_end > p && is_blank(name_end[-1])) --name_end;
+        out.name.assign(p, name_end);
+        if (out.name.empty()) out.name = "Untitled Molecule";
+        if (parse_extended_xyz_cell(p, name_end, out.cell)) {
+            std::cout << "C++: Periodic cell from extended XYZ lattice (pbc " << out.cell.pbc[0] << out.cell.pbc[1]
+                      << out.cell.pbc[2] << ")." << std::endl;
+        }
+        out.atoms.reserve(out.atoms.size() + num_atoms);
+        state = State::Atoms;
+        return true;
+    }
+    case State::Atoms: {
+        // Subsequent lines: Atom data
+        if (p == line_end) {
+            if (atoms_read == num_atoms - 1) { state = State::Done; return true; } // Trailing empty line after all atoms are fine
+            std::cerr << "XYZ Parse Error (Line " << line_number << "): Atom line is empty." << std::endl; return false;
+        }
+        const char* symbol_end = skip_token(p, line_end);
+        int atomic_number = atomic_number_from_symbol(p, symbol_end);
+        float x, y, z;
+        p = skip_blanks(symbol_end, line_end);
+        bool ok = parse_float(p, line_end, x);
+        p = skip_blanks(p, line_end);
+        ok = ok && parse_float(p, line_end, y);
+        p = skip_blanks(p, line_end);
+        ok = ok && parse_float(p, line_end, z);
+        if (!ok) {
+            std::cerr << "XYZ Parse Error (Line " << line_number << "): Could not parse atom data: "
+                      << std::string(line_begin, line_end) << std::endl;
+            return false;
+        }
+        out.atoms.push_back(x, y, z, atomic_number);
+        if (++atoms_read == num_atoms) state = State::Done;
+        return true;
+    }
+    case State::Done:
+        return true;
+    }
+    return false;
+}
+
+void XyzFrameParser::atoms_parsed(int count) {
+    atoms_read += count;
+    if (atoms_read == num_atoms) state = State::Done;
+}
+
+bool XyzFrameParser::finish() const {
+    switch (state) {
+    case State::Count:
+        std::cerr << "XYZ Parse Error: Could not read number of atoms line." << std::endl; return false;
+    case State::Comment:
+        std::cerr << "XYZ Parse Error: Could not read comment line." << std::endl; return false;
+    case State::Atoms:
+        std::cerr << "XYZ Parse Error: Unexpected end of file. Expected " << num_atoms << " atoms, got " << atoms_read << std::endl; return false;
+    case State::Done:
+        return true;
+    }
+    return false;
+}
+
+// Finds key=value or key="value" at the start of a token; value is the text between the quotes
+static bool find_extended_xyz_value(const char* begin, const char* end, const char* key, const char*& value_begin, const char*& value_end) {
+    const size_t key_length = std::strlen(key);
+    for (const char* p = begin; p + key_length < end; ++p) {
+        if (p > begin && !is_blank(p[-1])) continue;
+        size_t k = 0;
+        while (k < key_length && std::tolower(static_cast<unsigned char>(p[k])) == key[k]) ++k;
+        if (k < key_length || p[key_length] != '=') continue;
+        value_begin = p + key_length + 1;
+        if (value_begin < end && *value_begin == '"') {
+            ++value_begin;
+            value_end = static_cast<const char*>(std::memchr(value_begin, '"', end - value_begin));
+            if (!value_end) return false;
+        } else {
+            value_end = skip_token(value_begin, end);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool parse_extended_xyz_cell(const char* begin, const char* end, UnitCell& cell) {
+    const char* value;
+    const char* value_end;
+    if (!find_extended_xyz_value(begin, end, "lattice", value, value_end)) return false;
+    float v[9];
+    for (float& component : v) {
+        value = skip_blanks(value, value_end);
+        if (!parse_float(value, value_end, component)) return false;
+    }
+    UnitCell parsed;
+    parsed.a = Vec3(v[0], v[1], v[2]);
+    parsed.b = Vec3(v[3], v[4], v[5]);
+    parsed.c = Vec3(v[6], v[7], v[8]);
+    for (bool& periodic : parsed.pbc) periodic = true;
+    if (find_extended_xyz_value(begin, end, "pbc", value, value_end)) {
+        for (bool& periodic : parsed.pbc) {
+            value = skip_blanks(value, value_end);
+            if (value == value_end) return false;
+            char flag = static_cast<char>(std::toupper(static_cast<unsigned char>(*value)));
+            if (flag != 'T' && flag != 'F' && flag != '1' && flag != '0') return false;
+            periodic = flag == 'T' || flag == '1';
+            value = skip_token(value, value_end);
+        }
+    }
+    // A zero lattice vector cannot repeat
+    for (int axis = 0; axis < 3; ++axis) {
+        if (parsed.vector(axis).length() < 1e-4f) parsed.pbc[axis] = false;
+    }
+    cell = parsed;
+    return true;
+}
+
+// Parses the next count atom lines of the reader straight into atoms, in parallel. The text is
+// cut into chunks at line boundaries; a first pass counts each chunk's lines, which gives the
+// index of its first atom, and a second parses every chunk into its own slice of the arrays.
+// Returns false, with atoms and the reader untouched, on a short file or any blank or
+// malformed atom line, so the sequential parser can report it.
+static bool parse_atom_lines_parallel(LineReader& reader, size_t count, AtomArrays& atoms) {
+    const char* begin = reader.cur;
+    const size_t length = static_cast<size_t>(reader.end - begin);
+    const size_t chunk_count = std::max<size_t>(1, std::min<size_t>(worker_thread_count() * 8, length >> 16));
+    std::vector<const char*> chunk_start(chunk_count + 1, reader.end);
+    chunk_start[0] = begin;
+    for (size_t k = 1; k < chunk_count; ++k) {
+        const char* p = std::max(begin + length / chunk_count * k, chunk_start[k - 1]);
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', reader.end - p));
+        chunk_start[k] = nl ? nl + 1 : reader.end;
+    }
+
+    // Lines per chunk, as LineReader counts them: every '\n', plus an unterminated last line
+    std::vector<size_t> first_line(chunk_count + 1, 0);
+    parallel_for(chunk_count, 1, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            size_t lines = 0;
+            for (const char* p = chunk_start[k]; p < chunk_start[k + 1]; ++lines) {
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', chunk_start[k + 1] - p));
+                p = nl ? nl + 1 : chunk_start[k + 1];
+            }
+            first_line[k + 1] = lines;
+        }
+    });
+    for (size_t k = 0; k < chunk_count; ++k) first_line[k + 1] += first_line[k];
+    if (first_line[chunk_count] < count) return false;
+
+    const size_t base = atoms.size();
+    atoms.resize(base + count);
+    std::atomic<bool> ok(true);
+    const char* atoms_end = nullptr; // Just past the last atom line, for the reader
+    parallel_for(chunk_count, 1, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last && ok; ++k) {
+            if (first_line[k] >= count) break;
+            LineReader lines(chunk_start[k], chunk_start[k + 1]);
+            const char* line_begin;
+            const char* line_end;
+            for (size_t i = first_line[k]; i < count && lines.next(line_begin, line_end); ++i) {
+                const char* p = skip_blanks(line_begin, line_end);
+                const char* symbol_end = skip_token(p, line_end);
+                if (p == line_end) { ok = false; return; }
+                size_t a = base + i;
+                atoms.atomic_number[a] = static_cast<uint8_t>(atomic_number_from_symbol(p, symbol_end));
+                p = skip_blanks(symbol_end, line_end);
+                bool parsed = parse_float(p, line_end, atoms.x[a]);
+                p = skip_blanks(p, line_end);
+                parsed = parsed && parse_float(p, line_end, atoms.y[a]);
+                p = skip_blanks(p, line_end);
+                parsed = parsed && parse_float(p, line_end, atoms.z[a]);
+                if (!parsed) { ok = false; return; }
+                if (i == count - 1) atoms_end = lines.cur;
+            }
+        }
+    });
+    if (!ok) {
+        atoms.resize(base);
+        return false;
+    }
+    reader.cur = atoms_end;
+    reader.line_number += static_cast<int>(count);
+    return true;
+}
+
+bool parse_xyz_frame(LineReader& reader, Molecule& out) {
+    XyzFrameParser frame;
+    frame.begin(out);
+    const char* line_begin;
+    const char* line_end;
+    // Count and comment lines, then the atoms; large frames try the parallel path first
+    while (!frame.done() && frame.pending_atoms() == 0 && reader.next(line_begin, line_end)) {
+        if (!frame.consume_line(line_begin, line_end, reader.line_number)) return false;
+    }
+    const int pending = frame.pending_atoms();
+    if (pending >= XYZ_PARALLEL_MIN_ATOMS && worker_thread_count() > 1 &&
+        parse_atom_lines_parallel(reader, static_cast<size_t>(pending), out.atoms)) {
+        frame.atoms_parsed(pending);
+    }
+    while (!frame.done() && reader.next(line_begin, line_end)) {
+        if (!frame.consume_line(line_begin, line_end, reader.line_number)) return false;
+    }
+    return frame.finish();
+}
+
+bool parse_xyz(const char* data, size_t length, Molecule& out) {
+    LineReader reader(data, data + length);
+    return parse_xyz_frame(reader, out);
+}
+
+void XyzStreamParser::begin(Molecule& out) {
+    frame.begin(out);
+    carry.clear();
+    line_number = 0;
+    rest = 0;
+    failed = false;
+}
+
+bool XyzStreamParser::consume(const char* line_begin, const char* line_end) {
+    if (line_end > line_begin && line_end[-1] == '\r') --line_end;
+    if (!frame.consume_line(line_begin, line_end, ++line_number)) failed = true;
+    return !failed;
+}
+
+bool XyzStreamParser::feed(const char* data, size_t length) {
+    const char* p = data;
+    const char* end = data + length;
+    while (p < end && !failed && !frame.done()) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl) {
+            carry.append(p, end); // Partial line; completed by the next chunk or by finish()
+            break;
+        }
+        if (!carry.empty()) {
+            carry.append(p, nl);
+            consume(carry.data(), carry.data() + carry.size());
+            carry.clear();
+        } else {
+            consume(p, nl);
+        }
+        p = nl + 1;
+    }
+    rest = frame.done() ? static_cast<size_t>(end - p) : 0;
+    return wants_more();
+}
+
+bool XyzStreamParser::finish() {
+    if (failed) return false;
+    if (!carry.empty() && !frame.done()) {
+        consume(carry.data(), carry.data() + carry.size());
+        carry.clear();
+        if (failed) return false;
+    }
+    carry.shrink_to_fit();
+    return frame.finish();
+}
+
+bool parse_xyz_frame_positions(LineReader& reader, size_t atom_count, float* x_out, float* y_out, float* z_out) {
+    const char* line_begin;
+    const char* line_end;
+    if (!reader.next(line_begin, line_end)) {
+        std::cerr << "XYZ Parse Error: Could not read number of atoms line." << std::endl; return false;
+    }
+    const char* p = skip_blanks(line_begin, line_end);
+    int num_atoms = 0;
+    if (!parse_int(p, line_end, num_atoms) || static_cast<size_t>(num_atoms) != atom_count) {
+        std::cerr << "XYZ Parse Error (Line " << reader.line_number << "): Frame atom count does not match (expected "
+                  << atom_count << ")." << std::endl;
+        return false;
+    }
+    if (!reader.next(line_begin, line_end)) { // Comment line is ignored for coordinate frames
+        std::cerr << "XYZ Parse Error: Could not read comment line." << std::endl; return false;
+    }
+    for (size_t i = 0; i < atom_count; ++i) {
+        if (!reader.next(line_begin, line_end)) {
+            std::cerr << "XYZ Parse Error: Unexpected end of file. Expected " << atom_count << " atoms, got " << i << std::endl; return false;
+        }
+        p = skip_blanks(skip_token(skip_blanks(line_begin, line_end), line_end), line_end);
+        bool ok = parse_float(p, line_end, x_out[i]);
+        p = skip_blanks(p, line_end);
+        ok = ok && parse_float(p, line_end, y_out[i]);
+        p = skip_blanks(p, line_end);
+        ok = ok && parse_float(p, line_end, z_out[i]);
+        if (!ok) {
+            std::cerr << "XYZ Parse Error (Line " << reader.line_number << "): Could not parse atom data: "
+                      << std::string(line_begin, line_end) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "molecule.h"
+#include "text_scan.h"
+
+// Line-driven parser for a single XYZ frame (count line, comment line, atom lines).
+// Atoms are appended to the target molecule; its name receives the trimmed comment, and an
+// extended XYZ lattice in the comment becomes its unit cell.
+// Errors are reported on std::cerr with the offending line number.
+class XyzFrameParser {
+public:
+    void begin(Molecule& out);
+    bool consume_line(const char* line_begin, const char* line_end, int line_number);
+    bool done() const { return state == State::Done; }
+    bool finish() const; // Reports an error if input ended before the frame was complete
+    int pending_atoms() const { return state == State::Atoms ? num_atoms - atoms_read : 0; }
+    void atoms_parsed(int count); // Records atom lines parsed outside consume_line
+
+private:
+    enum class State { Count, Comment, Atoms, Done };
+    State state = State::Count;
+    Molecule* target = nullptr;
+    int num_atoms = 0;
+    int atoms_read = 0;
+};
+
+// Reads the periodic cell from an extended XYZ comment line: Lattice="ax ay az bx by bz cx cy cz"
+// and the optional pbc="T T F" (periodic along all three vectors when absent). Keys are matched
+// case-insensitively. Returns false, leaving cell untouched, if there is no valid Lattice.
+bool parse_extended_xyz_cell(const char* begin, const char* end, UnitCell& cell);
+
+// Feeds an XYZ frame in arbitrary chunks. Only a partial line is buffered between chunks.
+class XyzStreamParser {
+public:
+    void begin(Molecule& out);
+    bool feed(const char* data, size_t length); // Returns false once no more input is needed
+    bool finish();
+    bool wants_more() const { return !failed && !frame.done(); }
+    bool has_failed() const { return failed; }
+    bool frame_done() const { return frame.done(); }
+    size_t unconsumed() const { return rest; } // Bytes of the last chunk that follow the completed frame
+    int lines_read() const { return line_number; }
+
+private:
+    bool consume(const char* line_begin, const char* line_end);
+    XyzFrameParser frame;
+    std::string carry; // Incomplete line from the end of the previous chunk
+    int line_number = 0;
+    size_t rest = 0;
+    bool failed = false;
+};
+
+// Parses one XYZ frame starting at the reader's current position (see XyzFrameParser).
+// Frames of at least XYZ_PARALLEL_MIN_ATOMS atoms have their atom lines parsed on all worker
+// threads; the sequential path still handles (and reports) any irregular input.
+const int XYZ_PARALLEL_MIN_ATOMS = 50000;
+bool parse_xyz_frame(LineReader& reader, Molecule& out);
+
+// Parses the first frame of an XYZ buffer into out (atoms and name only; no bonds or formula).
+bool parse_xyz(const char* data, size_t length, Molecule& out);
+
+// Parses only the coordinates of one XYZ frame into the x/y/z arrays, skipping element
+// symbols. The frame's count line must equal atom_count.
+bool parse_xyz_frame_positions(LineReader& reader, size_t atom_count, float* x_out, float* y_out, float* z_out);
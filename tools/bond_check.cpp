@@ -0,0 +1,317 @@
+// Checks generate_bonds against a brute-force O(N^2) scan over every atom pair (and, in a
+// periodic cell, every lattice image within reach), asserting identical Bond lists: same
+// pairs, same images, same order.
+//
+//   bond_check [molecule-library.js] [file.xyz ...]
+//
+// Covers random non-periodic systems (lattices, gases, clusters with far outliers, duplicate
+// atoms, the whole element table), random atoms in orthorhombic, triclinic, slab and wire
+// cells, every entry of the built-in molecule library and any extra (extended) XYZ files.
+// Each structure is checked on one thread and on all of them. Pairs within 1e-4 A of their
+// cutoff may round either way and are reported but not counted as failures. XYZ text with
+// non-finite or overflowing coordinates must fail to parse, on the sequential and the
+// parallel atom-line paths, as it would otherwise reach the cell grid. Exits with 1 on a
+// mismatch. Build and run with `make check-bonds`.
+#include "neighbor.h"
+#include "parallel.h"
+#include "xyz_reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+typedef std::tuple<size_t, size_t, int, int, int> BondKey; // atom1, atom2, image
+
+static BondKey bond_key(const Bond& b) { return BondKey(b.atom1_idx, b.atom2_idx, b.image[0], b.image[1], b.image[2]); }
+
+// Lattice translations that can bring two atoms within bonding range: |m_k| <= L sqrt((G^-1)_kk)
+// for the Gram matrix G of the periodic vectors, with L the largest separation of two atoms
+// plus the longest possible bond
+static std::vector<std::tuple<int, int, int>> candidate_images(const Molecule& mol, float reach) {
+    std::vector<std::tuple<int, int, int>> images;
+    int range[3] = {0, 0, 0};
+    if (mol.cell.periodic()) {
+        const AtomArrays& atoms = mol.atoms;
+        float lo[3] = {atoms.x[0], atoms.y[0], atoms.z[0]}, hi[3] = {lo[0], lo[1], lo[2]};
+        for (size_t i = 0; i < atoms.size(); ++i) {
+            const float p[3] = {atoms.x[i], atoms.y[i], atoms.z[i]};
+            for (int k = 0; k < 3; ++k) { lo[k] = std::min(lo[k], p[k]); hi[k] = std::max(hi[k], p[k]); }
+        }
+        const double limit = Vec3(hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]).length() + reach;
+
+        int axes[3], count = 0;
+        for (int k = 0; k < 3; ++k) if (mol.cell.pbc[k]) axes[count++] = k;
+        double gram[3][6] = {}; // [G | I], reduced to [I | G^-1] by Gauss-Jordan elimination
+        for (int r = 0; r < count; ++r) {
+            for (int c = 0; c < count; ++c) gram[r][c] = Vec3::dot(mol.cell.vector(axes[r]), mol.cell.vector(axes[c]));
+            gram[r][count + r] = 1.0;
+        }
+        for (int c = 0; c < count; ++c) {
+            int pivot = c;
+            for (int r = c + 1; r < count; ++r) if (std::fabs(gram[r][c]) > std::fabs(gram[pivot][c])) pivot = r;
+            if (std::fabs(gram[pivot][c]) < 1e-9) return images; // Degenerate cell: generate_bonds finds nothing either
+            for (int k = 0; k < 2 * count; ++k) std::swap(gram[c][k], gram[pivot][k]);
+            const double scale = gram[c][c];
+            for (int k = 0; k < 2 * count; ++k) gram[c][k] /= scale;
+            for (int r = 0; r < count; ++r) {
+                if (r == c) continue;
+                const double factor = gram[r][c];
+                for (int k = 0; k < 2 * count; ++k) gram[r][k] -= factor * gram[c][k];
+            }
+        }
+        for (int r = 0; r < count; ++r) range[axes[r]] = static_cast<int>(limit * std::sqrt(gram[r][count + r])) + 1;
+    }
+    for (int a = -range[0]; a <= range[0]; ++a)
+        for (int b = -range[1]; b <= range[1]; ++b)
+            for (int c = -range[2]; c <= range[2]; ++c) images.emplace_back(a, b, c);
+    return images;
+}
+
+struct BruteBonds {
+    std::vector<BondKey> bonds;
+    std::vector<BondKey> borderline; // Within 1e-4 A of the cutoff
+};
+
+// Every (i, j >= i, image) within the pair's cutoff, skipping overlapping atoms like
+// generate_bonds. An atom bonds to its own images only once per +/- pair (the image that is
+// lexicographically positive).
+static BruteBonds brute_force_bonds(const Molecule& mol) {
+    BruteBonds out;
+    const AtomArrays& atoms = mol.atoms;
+    const size_t n = atoms.size();
+    if (n == 0) return out;
+    float max_radius = 0.0f;
+    for (size_t i = 0; i < n; ++i) max_radius = std::max(max_radius, atoms.properties(i).covalent_radius);
+    const auto images = candidate_images(mol, 2.0f * max_radius * BOND_DISTANCE_TOLERANCE_FACTOR);
+    if (images.empty()) return out;
+    std::vector<Vec3> translation;
+    for (const auto& m : images) translation.push_back(mol.cell.translation(std::get<0>(m), std::get<1>(m), std::get<2>(m)));
+
+    for (size_t i = 0; i < n; ++i) {
+        const Vec3 pi = atoms.position(i);
+        const float radius_i = atoms.properties(i).covalent_radius;
+        for (size_t j = i; j < n; ++j) {
+            const Vec3 pj = atoms.position(j);
+            const float cutoff = (radius_i + atoms.properties(j).covalent_radius) * BOND_DISTANCE_TOLERANCE_FACTOR;
+            for (size_t m = 0; m < images.size(); ++m) {
+                const int a = std::get<0>(images[m]), b = std::get<1>(images[m]), c = std::get<2>(images[m]);
+                if (i == j && !(a > 0 || (a == 0 && (b > 0 || (b == 0 && c > 0))))) continue;
+                const Vec3 d = pj + translation[m] - pi;
+                const float distance_sq = Vec3::dot(d, d);
+                if (distance_sq <= cutoff * cutoff && distance_sq > 0.0001f) out.bonds.emplace_back(i, j, a, b, c);
+                if (std::fabs(std::sqrt(distance_sq) - cutoff) < 1e-4f) out.borderline.emplace_back(i, j, a, b, c);
+            }
+        }
+    }
+    std::sort(out.bonds.begin(), out.bonds.end());
+    std::sort(out.borderline.begin(), out.borderline.end());
+    return out;
+}
+
+static int failures = 0;
+
+static void check(const std::string& name, const Molecule& input) {
+    const BruteBonds expected = brute_force_bonds(input);
+    for (unsigned threads : {1u, 0u}) {
+        set_worker_thread_count(threads);
+        Molecule mol;
+        mol.atoms = input.atoms;
+        mol.cell = input.cell;
+        generate_bonds(mol);
+
+        std::vector<BondKey> generated;
+        for (const Bond& b : mol.bonds) generated.push_back(bond_key(b));
+        // Differences are tolerated only for borderline pairs; order must match exactly
+        std::vector<BondKey> missing, extra;
+        std::vector<BondKey> sorted = generated;
+        std::sort(sorted.begin(), sorted.end());
+        std::set_difference(expected.bonds.begin(), expected.bonds.end(), sorted.begin(), sorted.end(), std::back_inserter(missing));
+        std::set_difference(sorted.begin(), sorted.end(), expected.bonds.begin(), expected.bonds.end(), std::back_inserter(extra));
+        size_t tolerated = 0, real = 0;
+        for (const auto* diff : {&missing, &extra}) {
+            for (const BondKey& key : *diff) {
+                if (std::binary_search(expected.borderline.begin(), expected.borderline.end(), key)) ++tolerated;
+                else ++real;
+            }
+        }
+        const bool ordered = sorted == generated;
+        const bool ok = real == 0 && ordered;
+        size_t crossing = 0;
+        for (const Bond& b : mol.bonds) crossing += b.crosses_cell();
+        std::printf("%-32s %3u thr %8zu atoms %8zu bonds %6zu crossing  brute %8zu  %s", name.c_str(), worker_thread_count(),
+                    mol.atoms.size(), mol.bonds.size(), crossing, expected.bonds.size(), ok ? "OK" : "MISMATCH");
+        if (tolerated > 0) std::printf(" (%zu borderline)", tolerated);
+        if (!ordered) std::printf(" (out of order)");
+        std::printf("\n");
+        for (const auto* diff : {&missing, &extra}) {
+            for (size_t k = 0; k < diff->size() && k < 5; ++k) {
+                const BondKey& key = (*diff)[k];
+                std::printf("    %s %zu-%zu image %d %d %d\n", diff == &missing ? "missing" : "extra", std::get<0>(key), std::get<1>(key),
+                            std::get<2>(key), std::get<3>(key), std::get<4>(key));
+            }
+        }
+        if (!ok) ++failures;
+    }
+    set_worker_thread_count(0);
+}
+
+// Atoms on a jittered cubic lattice with a mix of C, N, O and H (about 1.5 bonds per atom)
+static Molecule jittered_lattice(std::mt19937& rng, size_t count, float spacing, float jitter) {
+    static const int ELEMENTS[] = {6, 6, 6, 7, 8, 1, 1, 1};
+    std::normal_distribution<float> noise(0.0f, jitter);
+    const size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    Molecule mol;
+    for (size_t i = 0; i < count; ++i) {
+        mol.atoms.push_back(spacing * (i % side) + noise(rng), spacing * (i / side % side) + noise(rng), spacing * (i / side / side) + noise(rng),
+                            ELEMENTS[rng() % 8]);
+    }
+    return mol;
+}
+
+// Random atoms in a cell, a fifth of a cell beyond it on every side, so the search also has to
+// wrap coordinates. Along non-periodic axes the atoms spread over `open_extent` A instead.
+static Molecule random_in_cell(std::mt19937& rng, const UnitCell& cell, size_t count, float open_extent) {
+    static const int ELEMENTS[] = {6, 6, 7, 8, 1, 1};
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    Molecule mol;
+    mol.cell = cell;
+    for (size_t i = 0; i < count; ++i) {
+        Vec3 p(0, 0, 0);
+        for (int k = 0; k < 3; ++k) {
+            const float f = uniform(rng) * 1.4f - 0.2f;
+            p = p + (cell.pbc[k] ? cell.vector(k) * f : Vec3(k == 0, k == 1, k == 2) * (uniform(rng) * open_extent));
+        }
+        mol.atoms.push_back(p.x, p.y, p.z, ELEMENTS[rng() % 6]);
+    }
+    return mol;
+}
+
+static UnitCell make_cell(Vec3 a, Vec3 b, Vec3 c, bool pa, bool pb, bool pc) {
+    UnitCell cell;
+    cell.a = a; cell.b = b; cell.c = c;
+    cell.pbc[0] = pa; cell.pbc[1] = pb; cell.pbc[2] = pc;
+    return cell;
+}
+
+static bool read_file(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    text = contents.str();
+    return true;
+}
+
+// Entries of molecule-library.js: `name: { ... xyz: \`...\` }`
+static void check_library(const std::string& path) {
+    std::string source;
+    if (!read_file(path, source)) {
+        std::fprintf(stderr, "bond_check: cannot read %s\n", path.c_str());
+        ++failures;
+        return;
+    }
+    size_t entries = 0;
+    for (size_t at = source.find("xyz: `"); at != std::string::npos; at = source.find("xyz: `", at)) {
+        const size_t begin = at + 6;
+        const size_t end = source.find('`', begin);
+        if (end == std::string::npos) break;
+        Molecule mol;
+        if (parse_xyz(source.data() + begin, end - begin, mol)) {
+            check("library: " + mol.name, mol);
+            ++entries;
+        }
+        at = end + 1;
+    }
+    if (entries == 0) {
+        std::fprintf(stderr, "bond_check: no library entries found in %s\n", path.c_str());
+        ++failures;
+    }
+}
+
+// XYZ frames whose atom line `bad` must be rejected by parse_xyz, in a small frame and in one
+// large enough for the parallel atom-line parser
+static void check_rejected(const std::string& bad) {
+    for (int atoms : {3, XYZ_PARALLEL_MIN_ATOMS + 10}) {
+        std::string text = std::to_string(atoms) + "\nnon-finite\n";
+        for (int i = 0; i < atoms; ++i) text += i == atoms / 2 ? bad + "\n" : "C " + std::to_string(1.5 * i) + " 0 0\n";
+        Molecule mol;
+        std::streambuf* errors = std::cerr.rdbuf(nullptr); // Drop the expected line-numbered parse error
+        const bool parsed = parse_xyz(text.data(), text.size(), mol);
+        std::cerr.rdbuf(errors);
+        std::printf("%-32s %8d atoms  %s\n", ("reject \"" + bad + "\"").c_str(), atoms, parsed ? "ACCEPTED" : "OK");
+        if (parsed) ++failures;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout.rdbuf(nullptr); // Drop the parser and bond perception logs; results go through printf
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    // Non-finite coordinates
+    for (const char* bad : {"C inf 0 0", "C 0 -INF 0", "C 0 0 infinity", "C nan 0 0", "C 0 NaN 0", "C 1e39 0 0", "C 0 0 -1e400"}) check_rejected(bad);
+
+    // Non-periodic
+    check("lattice 20k (1.5 A, dense)", jittered_lattice(rng, 20000, 1.5f, 0.15f));
+    {
+        Molecule gas;
+        for (int i = 0; i < 5000; ++i) gas.atoms.push_back(40.0f * uniform(rng), 40.0f * uniform(rng), 40.0f * uniform(rng), 1 + rng() % 10);
+        check("random gas 5k", gas);
+    }
+    {
+        Molecule cluster = jittered_lattice(rng, 3000, 1.4f, 0.2f);
+        for (int i = 0; i < 20; ++i) cluster.atoms.push_back(2000.0f * uniform(rng) - 1000.0f, 2000.0f * uniform(rng), -500.0f * uniform(rng), 6);
+        check("cluster + far outliers", cluster);
+    }
+    {
+        Molecule duplicates = jittered_lattice(rng, 2000, 1.5f, 0.1f);
+        for (size_t i = 0; i < 2000; i += 7) duplicates.atoms.push_back(duplicates.atoms.x[i], duplicates.atoms.y[i], duplicates.atoms.z[i], 6);
+        check("duplicate atoms", duplicates);
+    }
+    {
+        Molecule elements;
+        for (int i = 0; i < 4000; ++i) elements.atoms.push_back(30.0f * uniform(rng), 30.0f * uniform(rng), 30.0f * uniform(rng), 1 + rng() % ELEMENT_COUNT);
+        check("all elements 4k", elements);
+    }
+
+    // Periodic
+    check("orthorhombic cell", random_in_cell(rng, make_cell(Vec3(9, 0, 0), Vec3(0, 10, 0), Vec3(0, 0, 11), true, true, true), 400, 0));
+    check("triclinic cell", random_in_cell(rng, make_cell(Vec3(9, 0, 0), Vec3(4, 8, 0), Vec3(-3, 2, 9), true, true, true), 400, 0));
+    check("skewed triclinic cell", random_in_cell(rng, make_cell(Vec3(8, 0, 0), Vec3(6.5f, 5, 0), Vec3(5, 4, 4.5f), true, true, true), 300, 0));
+    check("slab (pbc T T F)", random_in_cell(rng, make_cell(Vec3(9, 0, 0), Vec3(2, 9, 0), Vec3(0, 0, 0), true, true, false), 300, 6));
+    check("wire (pbc F F T)", random_in_cell(rng, make_cell(Vec3(0, 0, 0), Vec3(0, 0, 0), Vec3(1, 1, 8), false, false, true), 200, 6));
+    check("tiny 2.2 A cell", random_in_cell(rng, make_cell(Vec3(2.2f, 0, 0), Vec3(0, 2.2f, 0), Vec3(0, 0, 2.2f), true, true, true), 3, 0));
+    {
+        Molecule single;
+        single.cell = make_cell(Vec3(1.5f, 0, 0), Vec3(0, 1.5f, 0), Vec3(0, 0, 1.5f), true, true, true);
+        single.atoms.push_back(0, 0, 0, 6);
+        check("1 atom, simple cubic", single);
+    }
+    {
+        Molecule box = jittered_lattice(rng, 1728, 1.5f, 0.15f); // 12^3 sites filling an 18 A box
+        box.cell = make_cell(Vec3(18, 0, 0), Vec3(0, 18, 0), Vec3(0, 0, 18), true, true, true);
+        check("periodic lattice", box);
+    }
+
+    // Real structures
+    const std::string library = argc > 1 ? argv[1] : "src/js/molecule-library.js";
+    check_library(library);
+    for (int k = 2; k < argc; ++k) {
+        std::string text;
+        Molecule mol;
+        if (!read_file(argv[k], text) || !parse_xyz(text.data(), text.size(), mol)) {
+            std::fprintf(stderr, "bond_check: cannot load %s\n", argv[k]);
+            ++failures;
+            continue;
+        }
+        check(argv[k], mol);
+    }
+
+    std::printf(failures ? "%d MISMATCHES\n" : "All bond lists identical\n", failures);
+    return failures ? 1 : 0;
+}
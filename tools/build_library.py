@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""Pre-converts the built-in molecule library to MOLB binaries.
+
+Reads every entry's XYZ text from src/js/molecule-library.js, converts it with the
+native xyz2molb tool (bonds are perceived once, here) and writes the base64 blobs to
+src/js/molecule-library-binary.js. Run through `make library`.
+"""
+import re
+import subprocess
+import sys
+
+LIBRARY_JS = "src/js/molecule-library.js"
+OUTPUT_JS = "src/js/molecule-library-binary.js"
+
+ENTRY_PATTERN = re.compile(r"^    (\w+): \{.*?xyz: `(.*?)`", re.S | re.M)
+
+
+def main():
+    converter = sys.argv[1] if len(sys.argv) > 1 else "build/xyz2molb"
+    with open(LIBRARY_JS, encoding="utf-8") as f:
+        source = f.read()
+
+    entries = ENTRY_PATTERN.findall(source)
+    if not entries:
+        sys.exit("build_library: no entries found in " + LIBRARY_JS)
+
+    lines = [
+        "// Generated by tools/build_library.py from molecule-library.js; do not edit.",
+        "// MOLB binaries (see src/molecule_binary.h) with precomputed bonds, base64 encoded.",
+        "const MOLECULE_LIBRARY_BINARY = {",
+    ]
+    for key, xyz in entries:
+        result = subprocess.run([converter, "--base64", "-"], input=xyz.encode("utf-8"),
+                                stdout=subprocess.PIPE, check=True)
+        lines.append('    %s: "%s",' % (key, result.stdout.decode("ascii").strip()))
+    lines.append("};")
+
+    with open(OUTPUT_JS, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+    print("build_library: wrote %d molecules to %s" % (len(entries), OUTPUT_JS))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+// Microbenchmark for the SIMD math kernels in src/math.h. Each kernel is timed with the scalar
+// backend, the 4-lane backend and the widest compiled-in backend, next to the plain loops the
+// code used before, and every result is checked against the plain loop.
+//
+//   math_bench [point_count]     (default 100000)
+//
+// Build with `make bench` (native, -march=native) or `make bench-wasm` (SIMD128, run with node).
+#include "math.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Best of several runs of fn, each repeating it `repeat` times; returns ns per call
+template <typename Fn>
+static double time_ns(int repeat, Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < 5; ++run) {
+        double start = now_ms();
+        for (int k = 0; k < repeat; ++k) fn();
+        best = std::min(best, (now_ms() - start) * 1e6 / repeat);
+    }
+    return best;
+}
+
+static volatile float sink; // Keeps results observable so loops are not optimized away
+
+static bool close_enough(const float* a, const float* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (std::fabs(a[i] - b[i]) > 1e-4f * (1.0f + std::fabs(b[i]))) return false;
+    }
+    return true;
+}
+
+static void report(const char* kernel, double reference_ns, const char* backend, double ns, bool ok) {
+    std::printf("  %-20s %-8s %12.1f ns  %5.2fx%s\n", kernel, backend, ns, reference_ns / ns, ok ? "" : "  MISMATCH");
+}
+
+// The scalar code the kernels replaced
+static Mat4 reference_multiply(const Mat4& a, const Mat4& b) {
+    Mat4 result(0.0f);
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) sum += a.m[k * 4 + r] * b.m[c * 4 + k];
+            result.m[c * 4 + r] = sum;
+        }
+    }
+    return result;
+}
+
+static void reference_transform(const Mat4& m, const std::vector<float>& x, const std::vector<float>& y,
+                                const std::vector<float>& z, std::vector<float>& ox, std::vector<float>& oy, std::vector<float>& oz) {
+    const float* a = m.m;
+    for (size_t i = 0; i < x.size(); ++i) {
+        ox[i] = a[0] * x[i] + a[4] * y[i] + a[8] * z[i] + a[12];
+        oy[i] = a[1] * x[i] + a[5] * y[i] + a[9] * z[i] + a[13];
+        oz[i] = a[2] * x[i] + a[6] * y[i] + a[10] * z[i] + a[14];
+    }
+}
+
+static void reference_bounds(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z,
+                             float* lo, float* hi) {
+    const auto xr = std::minmax_element(x.begin(), x.end());
+    const auto yr = std::minmax_element(y.begin(), y.end());
+    const auto zr = std::minmax_element(z.begin(), z.end());
+    lo[0] = *xr.first; lo[1] = *yr.first; lo[2] = *zr.first;
+    hi[0] = *xr.second; hi[1] = *yr.second; hi[2] = *zr.second;
+}
+
+struct Points {
+    std::vector<float> x, y, z;
+};
+
+template <class B>
+static void run_backend(const char* name, const Points& p, const Mat4& a, const Mat4& b, const Mat4& product_ref,
+                        const Points& transformed_ref, const std::vector<float>& distances_ref, const float* bounds_ref,
+                        const double* reference_ns) {
+    const size_t n = p.x.size();
+    const int repeat = static_cast<int>(std::max<size_t>(1, 20000000 / (n + 1)));
+
+    if constexpr (B::WIDTH == 4) {
+        Mat4 product(0.0f);
+        Mat4 factor = b;
+        double ns = time_ns(1000000, [&] {
+            Mat4::multiply<B>(a, factor, product);
+            factor.m[0] = product.m[0] * 1e-30f + b.m[0]; // Serialize iterations without changing the value
+        });
+        report("Mat4 multiply", reference_ns[0], name, ns, close_enough(product.m, product_ref.m, 16));
+    }
+
+    Points out{std::vector<float>(n), std::vector<float>(n), std::vector<float>(n)};
+    double ns = time_ns(repeat, [&] {
+        transform_points<B>(b, p.x.data(), p.y.data(), p.z.data(), n, out.x.data(), out.y.data(), out.z.data());
+        sink = out.x[n / 2];
+    });
+    bool ok = close_enough(out.x.data(), transformed_ref.x.data(), n) && close_enough(out.y.data(), transformed_ref.y.data(), n) &&
+              close_enough(out.z.data(), transformed_ref.z.data(), n);
+    report("transform_points", reference_ns[1], name, ns, ok);
+
+    std::vector<float> distances(n);
+    const Vec3 center(1.0f, -2.0f, 0.5f);
+    ns = time_ns(repeat, [&] {
+        squared_distances<B>(p.x.data(), p.y.data(), p.z.data(), n, center, distances.data());
+        sink = distances[n / 2];
+    });
+    report("squared_distances", reference_ns[2], name, ns, close_enough(distances.data(), distances_ref.data(), n));
+
+    float lo[3], hi[3];
+    ns = time_ns(repeat, [&] {
+        sphere_bounds<B>(p.x.data(), p.y.data(), p.z.data(), nullptr, n, lo, hi);
+        sink = lo[0];
+    });
+    report("sphere_bounds", reference_ns[3], name, ns, close_enough(lo, bounds_ref, 3) && close_enough(hi, bounds_ref + 3, 3));
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 100000;
+    if (n == 0) {
+        std::fprintf(stderr, "Usage: %s [point_count]\n", argv[0]);
+        return 2;
+    }
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(-50.0f, 50.0f);
+    Points p{std::vector<float>(n), std::vector<float>(n), std::vector<float>(n)};
+    for (size_t i = 0; i < n; ++i) {
+        p.x[i] = coord(rng);
+        p.y[i] = coord(rng);
+        p.z[i] = coord(rng);
+    }
+    const Mat4 a = Mat4::perspective(0.8f, 1.5f, 0.1f, 500.0f);
+    const Mat4 b = Mat4::lookAt(Vec3(10.0f, 20.0f, 80.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+    const int repeat = static_cast<int>(std::max<size_t>(1, 20000000 / (n + 1)));
+
+    // Reference timings and results from the scalar code
+    double reference_ns[4];
+    Mat4 product_ref(0.0f);
+    Mat4 factor = b;
+    reference_ns[0] = time_ns(1000000, [&] {
+        product_ref = reference_multiply(a, factor);
+        factor.m[0] = product_ref.m[0] * 1e-30f + b.m[0];
+    });
+    Points transformed{std::vector<float>(n), std::vector<float>(n), std::vector<float>(n)};
+    reference_ns[1] = time_ns(repeat, [&] {
+        reference_transform(b, p.x, p.y, p.z, transformed.x, transformed.y, transformed.z);
+        sink = transformed.x[n / 2];
+    });
+    std::vector<float> distances(n);
+    reference_ns[2] = time_ns(repeat, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            float dx = p.x[i] - 1.0f, dy = p.y[i] + 2.0f, dz = p.z[i] - 0.5f;
+            distances[i] = dx * dx + dy * dy + dz * dz;
+        }
+        sink = distances[n / 2];
+    });
+    float bounds[6];
+    reference_ns[3] = time_ns(repeat, [&] {
+        reference_bounds(p.x, p.y, p.z, bounds, bounds + 3);
+        sink = bounds[0];
+    });
+
+    std::printf("Math kernels, %zu points (speedup relative to the scalar loops)\n", n);
+    const char* names[4] = {"Mat4 multiply", "transform_points", "squared_distances", "sphere_bounds"};
+    for (int k = 0; k < 4; ++k) report(names[k], reference_ns[k], "loop", reference_ns[k], true);
+    run_backend<SimdScalar>("scalar", p, a, b, product_ref, transformed, distances, bounds, reference_ns);
+#if defined(__wasm_simd128__)
+    run_backend<SimdWasm>("simd128", p, a, b, product_ref, transformed, distances, bounds, reference_ns);
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    run_backend<SimdSse>("sse2", p, a, b, product_ref, transformed, distances, bounds, reference_ns);
+#endif
+#if defined(__AVX2__)
+    run_backend<SimdAvx>("avx2", p, a, b, product_ref, transformed, distances, bounds, reference_ns);
+#endif
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Scaling benchmark for parallel loading: XYZ parsing and bond perception of a synthetic
+// system at 1, 2, 4, ... threads up to the hardware concurrency (or max_threads), with every
+// run checked against the single-threaded result.
+//
+//   parallel_bench [atom_count [max_threads]]     (default 1000000 atoms)
+//
+// The system is a jittered cubic lattice with 1.5 A spacing and a mix of C, N, O and H, so
+// atoms have a realistic number of bonded neighbors. Build and run with `make bench-parallel`.
+#include "xyz_reader.h"
+#include "neighbor.h"
+#include "parallel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string make_xyz(size_t atom_count) {
+    static const char* SYMBOLS[] = {"C", "C", "C", "N", "O", "H", "H", "H"};
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> jitter(-0.25f, 0.25f);
+    const size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(atom_count))));
+    std::string text = std::to_string(atom_count) + "\nsynthetic lattice\n";
+    text.reserve(atom_count * 40);
+    char line[96];
+    for (size_t i = 0; i < atom_count; ++i) {
+        float x = 1.5f * (i % side) + jitter(rng);
+        float y = 1.5f * (i / side % side) + jitter(rng);
+        float z = 1.5f * (i / side / side) + jitter(rng);
+        int length = std::snprintf(line, sizeof(line), "%s %.5f %.5f %.5f\n", SYMBOLS[rng() % 8], x, y, z);
+        text.append(line, length);
+    }
+    return text;
+}
+
+static bool same_result(const Molecule& a, const Molecule& b) {
+    if (a.atoms.x != b.atoms.x || a.atoms.y != b.atoms.y || a.atoms.z != b.atoms.z) return false;
+    if (a.atoms.atomic_number != b.atoms.atomic_number || a.bonds.size() != b.bonds.size()) return false;
+    for (size_t k = 0; k < a.bonds.size(); ++k) {
+        if (a.bonds[k].atom1_idx != b.bonds[k].atom1_idx || a.bonds[k].atom2_idx != b.bonds[k].atom2_idx) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const size_t atom_count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+    const unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : worker_thread_count();
+    if (atom_count == 0 || max_threads == 0) {
+        std::fprintf(stderr, "Usage: %s [atom_count [max_threads]]\n", argv[0]);
+        return 2;
+    }
+    const std::string text = make_xyz(atom_count);
+    std::printf("%zu atoms, %.1f MB of XYZ, %u hardware threads\n", atom_count, text.size() / 1e6, worker_thread_count());
+    std::printf("threads   parse ms  speedup   bonds ms  speedup   total speedup\n");
+
+    Molecule reference;
+    double reference_parse = 0.0, reference_bonds = 0.0;
+    for (unsigned threads = 1; threads <= max_threads; threads = threads < 4 ? threads * 2 : threads + 4) {
+        set_worker_thread_count(threads);
+        double parse_ms = 1e30, bonds_ms = 1e30;
+        Molecule mol;
+        for (int run = 0; run < 3; ++run) { // Best of three
+            mol.clear();
+            double start = now_ms();
+            if (!parse_xyz(text.data(), text.size(), mol)) return 1;
+            parse_ms = std::min(parse_ms, now_ms() - start);
+            start = now_ms();
+            generate_bonds(mol);
+            bonds_ms = std::min(bonds_ms, now_ms() - start);
+        }
+        if (threads == 1) {
+            reference = mol;
+            reference_parse = parse_ms;
+            reference_bonds = bonds_ms;
+        }
+        bool same = same_result(mol, reference);
+        std::printf("%7u %10.1f %8.2fx %10.1f %8.2fx %10.2fx%s\n", threads, parse_ms, reference_parse / parse_ms, bonds_ms,
+                    reference_bonds / bonds_ms, (reference_parse + reference_bonds) / (parse_ms + bonds_ms),
+                    same ? "" : "  MISMATCH");
+        if (!same) return 1;
+    }
+    return 0;
+}
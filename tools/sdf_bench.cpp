@@ -0,0 +1,117 @@
+// Benchmark for multi-record SDF libraries: indexing the record offsets, parsing every record
+// (what benchmark_sdf_records does in the browser) and parsing random records on their own
+// (what selecting a record costs), on a synthetic library.
+//
+//   sdf_bench [records [seed]]     (default 100000 records)
+//
+// Records are V2000 chains of 10-40 C, N, O and S atoms with every third bond double and an
+// SD data field, like a 3D compound export. Every parsed record is checked against what was
+// written (name, atom and bond counts, bond orders). Exits with 1 on a mismatch. Build and
+// run with `make bench-sdf`.
+#include "sdf_reader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Expected {
+    int atoms;
+};
+
+static std::string build_library(int records, unsigned seed, std::vector<Expected>& expected) {
+    static const char* const ELEMENTS[] = {"C", "C", "C", "C", "N", "O", "S"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> atom_count(10, 40);
+    std::uniform_real_distribution<float> coordinate(-9.0f, 9.0f);
+    std::string text;
+    char line[128];
+    expected.clear();
+    for (int r = 0; r < records; ++r) {
+        const int n = atom_count(rng);
+        expected.push_back({n});
+        text += "CMPD" + std::to_string(r) + "\n  synthetic      3D\n\n";
+        std::snprintf(line, sizeof(line), "%3d%3d  0  0  0  0  0  0  0  0999 V2000\n", n, n - 1);
+        text += line;
+        for (int i = 0; i < n; ++i) {
+            std::snprintf(line, sizeof(line), "%10.4f%10.4f%10.4f %-3s 0  0  0  0  0  0  0  0  0  0  0  0\n", coordinate(rng),
+                          coordinate(rng), coordinate(rng), ELEMENTS[rng() % 7]);
+            text += line;
+        }
+        for (int i = 1; i < n; ++i) {
+            std::snprintf(line, sizeof(line), "%3d%3d%3d  0\n", i, i + 1, i % 3 ? 1 : 2);
+            text += line;
+        }
+        text += "M  END\n> <ID>\n" + std::to_string(r) + "\n\n$$$$\n";
+    }
+    return text;
+}
+
+static bool matches(const Molecule& mol, int record, const Expected& expected) {
+    if (mol.name != "CMPD" + std::to_string(record)) return false;
+    if (static_cast<int>(mol.atoms.size()) != expected.atoms || static_cast<int>(mol.bonds.size()) != expected.atoms - 1) return false;
+    for (size_t k = 0; k < mol.bonds.size(); ++k) {
+        const Bond& b = mol.bonds[k];
+        if (b.atom1_idx != k || b.atom2_idx != k + 1 || b.order != ((k + 1) % 3 ? 1 : 2)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const int records = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1;
+    if (records <= 0) {
+        std::fprintf(stderr, "Usage: %s [records [seed]]\n", argv[0]);
+        return 2;
+    }
+    std::vector<Expected> expected;
+    const std::string text = build_library(records, seed, expected);
+    std::printf("%d records, %.1f MB\n\n", records, text.size() / 1e6);
+
+    double start = now_ms();
+    std::vector<size_t> offsets;
+    const size_t indexed = index_sdf_records(text.data(), text.size(), offsets);
+    const double index_ms = now_ms() - start;
+    auto record_end = [&](size_t r) { return r + 1 < offsets.size() ? text.data() + offsets[r + 1] : text.data() + text.size(); };
+
+    // Every record into one reused molecule, as benchmark_sdf_records does
+    Molecule scratch;
+    size_t atoms = 0, bonds = 0;
+    int failures = 0;
+    start = now_ms();
+    for (size_t r = 0; r < offsets.size(); ++r) {
+        scratch.clear();
+        if (!parse_mol_record(text.data() + offsets[r], record_end(r), scratch) || !matches(scratch, static_cast<int>(r), expected[r])) {
+            ++failures;
+            continue;
+        }
+        atoms += scratch.atoms.size();
+        bonds += scratch.bonds.size();
+    }
+    const double parse_ms = now_ms() - start;
+
+    // Random records into fresh molecules, as selecting one in the viewer does
+    const int picks = 10000;
+    std::mt19937 rng(seed + 1);
+    start = now_ms();
+    for (int k = 0; k < picks && !offsets.empty(); ++k) {
+        const size_t r = rng() % offsets.size();
+        Molecule mol;
+        if (!parse_mol_record(text.data() + offsets[r], record_end(r), mol) || !matches(mol, static_cast<int>(r), expected[r])) ++failures;
+    }
+    const double pick_ms = now_ms() - start;
+
+    std::printf("%-26s %10s %14s\n", "step", "ms", "rate");
+    std::printf("%-26s %10.2f %11.1f MB/s\n", "index records", index_ms, text.size() / 1e3 / index_ms);
+    std::printf("%-26s %10.2f %9.0f rec/s  (%zu atoms, %zu bonds)\n", "parse all (reused)", parse_ms, offsets.size() / (parse_ms / 1000.0), atoms, bonds);
+    std::printf("%-26s %10.4f %14s\n", "select one record (mean)", pick_ms / picks, "");
+
+    const bool ok = indexed == static_cast<size_t>(records) && failures == 0;
+    if (indexed != static_cast<size_t>(records)) std::printf("Indexed %zu of %d records\n", indexed, records);
+    std::printf("%s\n", ok ? "All records parsed as written" : "MISMATCH");
+    return ok ? 0 : 1;
+}
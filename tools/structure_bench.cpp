@@ -0,0 +1,308 @@
+// Benchmark of PDB and mmCIF loading (parse plus template bonds) against XYZ loading (parse
+// plus distance-based bond perception) on the same structure, with a check of the template
+// bonds on a known residue set.
+//
+//   structure_bench [chains [residues_per_chain [repeats]]]     (default 400 chains of 30 residues)
+//
+// The structure is synthetic: alpha-helical chains cycling through GLY, ALA, SER, CYS, VAL,
+// THR, LEU, ASP, LYS and PHE, built from ideal internal coordinates (heavy atoms only, OXT on
+// the last residue) and laid out on a grid. The same atoms are written as PDB, mmCIF and XYZ
+// text. PDB and mmCIF must yield exactly the expected bonds of every residue, with their bond
+// orders, plus the peptide bonds within each chain; the XYZ bonds are reported for
+// comparison. Exits with 1 on a mismatch. Build and run with `make bench-structure`.
+#include "cif_reader.h"
+#include "neighbor.h"
+#include "pdb_reader.h"
+#include "xyz_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <tuple>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Side-chain atom placed from three earlier atoms of its residue (a, b, c) by bond length to c,
+// angle b-c-atom and dihedral a-b-c-atom; it bonds to c with the given order
+struct SideChainAtom {
+    const char* name;
+    int element;
+    const char* a;
+    const char* b;
+    const char* c;
+    float length, angle, dihedral;
+    int order;
+};
+
+struct ResidueType {
+    const char* name;
+    std::vector<SideChainAtom> atoms;
+    std::vector<std::pair<const char*, const char*>> ring_closures; // Extra single bonds
+};
+
+static const SideChainAtom CB = {"CB", 6, "C", "N", "CA", 1.53f, 110.5f, -122.6f, 1};
+
+static const ResidueType RESIDUE_TYPES[] = {
+    {"GLY", {}, {}},
+    {"ALA", {CB}, {}},
+    {"SER", {CB, {"OG", 8, "N", "CA", "CB", 1.417f, 110.8f, -60.0f, 1}}, {}},
+    {"CYS", {CB, {"SG", 16, "N", "CA", "CB", 1.808f, 114.0f, -60.0f, 1}}, {}},
+    {"VAL", {CB, {"CG1", 6, "N", "CA", "CB", 1.527f, 110.7f, 180.0f, 1}, {"CG2", 6, "N", "CA", "CB", 1.527f, 110.4f, -60.0f, 1}}, {}},
+    {"THR", {CB, {"OG1", 8, "N", "CA", "CB", 1.433f, 109.2f, -60.0f, 1}, {"CG2", 6, "N", "CA", "CB", 1.521f, 111.1f, 180.0f, 1}}, {}},
+    {"LEU", {CB, {"CG", 6, "N", "CA", "CB", 1.53f, 116.3f, -60.0f, 1}, {"CD1", 6, "CA", "CB", "CG", 1.524f, 110.7f, 180.0f, 1},
+             {"CD2", 6, "CA", "CB", "CG", 1.525f, 110.6f, -60.0f, 1}}, {}},
+    {"ASP", {CB, {"CG", 6, "N", "CA", "CB", 1.52f, 113.0f, -60.0f, 1}, {"OD1", 8, "CA", "CB", "CG", 1.25f, 119.0f, -90.0f, 2},
+             {"OD2", 8, "CA", "CB", "CG", 1.25f, 118.0f, 90.0f, 1}}, {}},
+    {"LYS", {CB, {"CG", 6, "N", "CA", "CB", 1.52f, 114.0f, -60.0f, 1}, {"CD", 6, "CA", "CB", "CG", 1.52f, 111.5f, 180.0f, 1},
+             {"CE", 6, "CB", "CG", "CD", 1.52f, 111.5f, 180.0f, 1}, {"NZ", 7, "CG", "CD", "CE", 1.49f, 111.7f, 180.0f, 1}}, {}},
+    {"PHE", {CB, {"CG", 6, "N", "CA", "CB", 1.50f, 113.8f, -60.0f, 1}, {"CD1", 6, "CA", "CB", "CG", 1.39f, 120.7f, 90.0f, 1},
+             {"CD2", 6, "CA", "CB", "CG", 1.39f, 120.7f, -90.0f, 1}, {"CE1", 6, "CB", "CG", "CD1", 1.39f, 120.0f, 180.0f, 1},
+             {"CE2", 6, "CB", "CG", "CD2", 1.39f, 120.0f, 180.0f, 1}, {"CZ", 6, "CG", "CD1", "CE1", 1.39f, 120.0f, 0.0f, 1}},
+     {{"CE2", "CZ"}}},
+};
+static const size_t RESIDUE_TYPE_COUNT = sizeof(RESIDUE_TYPES) / sizeof(RESIDUE_TYPES[0]);
+
+struct BuiltAtom {
+    std::string name;
+    int element;
+    const char* residue;
+    int chain, seq;
+    Vec3 position;
+};
+
+typedef std::tuple<size_t, size_t, int> BondKey; // atom1 < atom2, order
+
+struct Structure {
+    std::vector<BuiltAtom> atoms;
+    std::vector<BondKey> expected_bonds; // Sorted
+};
+
+// Places d bonded to c with |cd| = length, angle b-c-d and dihedral a-b-c-d (degrees)
+static Vec3 place_atom(const Vec3& a, const Vec3& b, const Vec3& c, float length, float angle, float dihedral) {
+    const float theta = angle * 3.14159265f / 180.0f, phi = dihedral * 3.14159265f / 180.0f;
+    const Vec3 bc = (c - b).normalize();
+    const Vec3 n = Vec3::cross(b - a, bc).normalize();
+    const Vec3 m = Vec3::cross(n, bc);
+    const Vec3 d(-length * std::cos(theta), length * std::sin(theta) * std::cos(phi), length * std::sin(theta) * std::sin(phi));
+    return c + bc * d.x + m * d.y + n * d.z;
+}
+
+static void add_bond(Structure& s, size_t i, size_t j, int order) {
+    s.expected_bonds.emplace_back(std::min(i, j), std::max(i, j), order);
+}
+
+static Structure build_structure(int chains, int residues_per_chain) {
+    Structure s;
+    const int grid = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(chains))));
+    const float phi = -57.0f, psi = -47.0f, omega = 180.0f; // Alpha helix
+    for (int chain = 0; chain < chains; ++chain) {
+        const Vec3 origin(24.0f * (chain % grid), 24.0f * (chain / grid), 0.0f);
+        Vec3 prev_n, prev_ca, prev_c;
+        size_t prev_c_index = 0;
+        for (int r = 0; r < residues_per_chain; ++r) {
+            const ResidueType& type = RESIDUE_TYPES[(chain + r) % RESIDUE_TYPE_COUNT];
+            Vec3 n, ca, c;
+            if (r == 0) {
+                n = origin;
+                ca = origin + Vec3(1.458f, 0.0f, 0.0f);
+                c = place_atom(origin + Vec3(0.0f, 1.0f, 0.0f), n, ca, 1.525f, 111.2f, 0.0f);
+            } else {
+                n = place_atom(prev_n, prev_ca, prev_c, 1.329f, 116.2f, psi);
+                ca = place_atom(prev_ca, prev_c, n, 1.458f, 121.7f, omega);
+                c = place_atom(prev_c, n, ca, 1.525f, 111.2f, phi);
+            }
+            const Vec3 o = place_atom(n, ca, c, 1.231f, 120.5f, psi + 180.0f);
+            const size_t first = s.atoms.size();
+            std::vector<std::pair<std::string, Vec3>> placed = {{"N", n}, {"CA", ca}, {"C", c}, {"O", o}};
+            auto push = [&](const char* name, int element, const Vec3& p) {
+                s.atoms.push_back({name, element, type.name, chain, r + 1, p});
+            };
+            push("N", 7, n);
+            push("CA", 6, ca);
+            push("C", 6, c);
+            push("O", 8, o);
+            add_bond(s, first, first + 1, 1);     // N-CA
+            add_bond(s, first + 1, first + 2, 1); // CA-C
+            add_bond(s, first + 2, first + 3, 2); // C=O
+            if (r > 0) add_bond(s, prev_c_index, first, 1); // Peptide bond
+
+            auto find = [&](const char* name) -> size_t {
+                for (size_t k = 0; k < placed.size(); ++k) if (placed[k].first == name) return k;
+                std::fprintf(stderr, "structure_bench: unknown atom %s in %s\n", name, type.name);
+                std::exit(2);
+            };
+            for (const SideChainAtom& atom : type.atoms) {
+                const Vec3 p = place_atom(placed[find(atom.a)].second, placed[find(atom.b)].second, placed[find(atom.c)].second,
+                                          atom.length, atom.angle, atom.dihedral);
+                add_bond(s, first + find(atom.c), s.atoms.size(), atom.order);
+                placed.push_back({atom.name, p});
+                push(atom.name, atom.element, p);
+            }
+            for (const auto& closure : type.ring_closures) add_bond(s, first + find(closure.first), first + find(closure.second), 1);
+            if (r + 1 == residues_per_chain) { // C-terminal carboxylate
+                add_bond(s, first + 2, s.atoms.size(), 1);
+                push("OXT", 8, place_atom(n, ca, c, 1.25f, 117.0f, psi));
+            }
+            prev_n = n; prev_ca = ca; prev_c = c;
+            prev_c_index = first + 2;
+        }
+    }
+    std::sort(s.expected_bonds.begin(), s.expected_bonds.end());
+    return s;
+}
+
+static const char* const ELEMENT_SYMBOLS[] = {"", "H", "He", "Li", "Be", "B", "C", "N", "O", "F", "Ne", "Na", "Mg", "Al", "Si", "P", "S"};
+
+static const char CHAIN_IDS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+// PDB chain ids are one character, so they repeat; neighboring chains always differ
+static char pdb_chain_id(int chain) {
+    return CHAIN_IDS[chain % 62];
+}
+
+// mmCIF ids may be longer; two characters keep 3844 chains distinct
+static std::string cif_chain_id(int chain) {
+    return std::string(1, CHAIN_IDS[chain / 62 % 62]) + CHAIN_IDS[chain % 62];
+}
+
+static std::string write_pdb(const Structure& s) {
+    std::string text = "TITLE     SYNTHETIC HELICES\n";
+    char line[128];
+    for (size_t i = 0; i < s.atoms.size(); ++i) {
+        const BuiltAtom& a = s.atoms[i];
+        std::string name = a.name.size() < 4 ? " " + a.name : a.name; // Column 14 for names shorter than four
+        std::snprintf(line, sizeof(line), "ATOM  %5d %-4s %3s %c%4d    %8.3f%8.3f%8.3f%6.2f%6.2f          %2s\n",
+                      static_cast<int>((i + 1) % 100000), name.c_str(), a.residue, pdb_chain_id(a.chain), a.seq,
+                      a.position.x, a.position.y, a.position.z, 1.0, 20.0, ELEMENT_SYMBOLS[a.element]);
+        text += line;
+        if (i + 1 == s.atoms.size() || s.atoms[i + 1].chain != a.chain) text += "TER\n";
+    }
+    text += "END\n";
+    return text;
+}
+
+static std::string write_mmcif(const Structure& s) {
+    std::string text = "data_SYNTH\nloop_\n_atom_site.group_PDB\n_atom_site.id\n_atom_site.type_symbol\n_atom_site.label_atom_id\n"
+                       "_atom_site.label_comp_id\n_atom_site.auth_asym_id\n_atom_site.auth_seq_id\n_atom_site.Cartn_x\n"
+                       "_atom_site.Cartn_y\n_atom_site.Cartn_z\n_atom_site.B_iso_or_equiv\n_atom_site.pdbx_PDB_model_num\n";
+    char line[160];
+    for (size_t i = 0; i < s.atoms.size(); ++i) {
+        const BuiltAtom& a = s.atoms[i];
+        std::snprintf(line, sizeof(line), "ATOM %zu %s %s %s %s %d %.3f %.3f %.3f 20.00 1\n", i + 1, ELEMENT_SYMBOLS[a.element],
+                      a.name.c_str(), a.residue, cif_chain_id(a.chain).c_str(), a.seq, a.position.x, a.position.y, a.position.z);
+        text += line;
+    }
+    text += "#\n";
+    return text;
+}
+
+static std::string write_xyz(const Structure& s) {
+    std::string text = std::to_string(s.atoms.size()) + "\nSynthetic helices\n";
+    char line[96];
+    for (const BuiltAtom& a : s.atoms) {
+        std::snprintf(line, sizeof(line), "%-2s %10.3f %10.3f %10.3f\n", ELEMENT_SYMBOLS[a.element], a.position.x, a.position.y, a.position.z);
+        text += line;
+    }
+    return text;
+}
+
+struct LoadResult {
+    Molecule mol;
+    double best_ms = 0.0;
+    bool ok = false;
+};
+
+template <typename Load>
+static LoadResult time_load(const std::string& text, int repeats, Load load) {
+    LoadResult result;
+    for (int k = 0; k < repeats; ++k) {
+        Molecule mol;
+        double start = now_ms();
+        bool ok = load(text, mol);
+        double elapsed = now_ms() - start;
+        if (k == 0 || elapsed < result.best_ms) result.best_ms = elapsed;
+        result.ok = ok;
+        result.mol = std::move(mol);
+    }
+    return result;
+}
+
+static std::vector<BondKey> bond_keys(const Molecule& mol) {
+    std::vector<BondKey> keys;
+    for (const Bond& b : mol.bonds) keys.emplace_back(b.atom1_idx, b.atom2_idx, b.order);
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+// Expected bonds (with orders) against the loaded ones; prints the first differences
+static bool check_template_bonds(const char* format, const Structure& s, const Molecule& mol) {
+    if (mol.atoms.size() != s.atoms.size() || mol.structure.residues.empty()) {
+        std::printf("  %-6s loaded %zu of %zu atoms\n", format, mol.atoms.size(), s.atoms.size());
+        return false;
+    }
+    const std::vector<BondKey> loaded = bond_keys(mol);
+    std::vector<BondKey> missing, extra;
+    std::set_difference(s.expected_bonds.begin(), s.expected_bonds.end(), loaded.begin(), loaded.end(), std::back_inserter(missing));
+    std::set_difference(loaded.begin(), loaded.end(), s.expected_bonds.begin(), s.expected_bonds.end(), std::back_inserter(extra));
+    for (const auto* diff : {&missing, &extra}) {
+        for (size_t k = 0; k < diff->size() && k < 5; ++k) {
+            const BondKey& key = (*diff)[k];
+            const BuiltAtom& a = s.atoms[std::get<0>(key)];
+            const BuiltAtom& b = s.atoms[std::get<1>(key)];
+            std::printf("  %-6s %s bond %s %d %s - %s %d %s (order %d)\n", format, diff == &missing ? "missing" : "extra", a.residue, a.seq,
+                        a.name.c_str(), b.residue, b.seq, b.name.c_str(), std::get<2>(key));
+        }
+    }
+    return missing.empty() && extra.empty();
+}
+
+int main(int argc, char** argv) {
+    const int chains = argc > 1 ? std::atoi(argv[1]) : 400;
+    const int residues = argc > 2 ? std::atoi(argv[2]) : 30;
+    const int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+    if (chains <= 0 || residues <= 0 || repeats <= 0) {
+        std::fprintf(stderr, "Usage: %s [chains [residues_per_chain [repeats]]]\n", argv[0]);
+        return 2;
+    }
+    std::cout.rdbuf(nullptr); // Drop the readers' logs; results go through printf
+
+    const Structure s = build_structure(chains, residues);
+    const std::string pdb = write_pdb(s), cif = write_mmcif(s), xyz = write_xyz(s);
+    std::printf("%d chains x %d residues (%zu residue types): %zu atoms, %zu expected bonds\n\n", chains, residues, RESIDUE_TYPE_COUNT,
+                s.atoms.size(), s.expected_bonds.size());
+
+    LoadResult pdb_load = time_load(pdb, repeats, [](const std::string& t, Molecule& m) { return parse_pdb(t.data(), t.size(), m); });
+    LoadResult cif_load = time_load(cif, repeats, [](const std::string& t, Molecule& m) { return parse_mmcif(t.data(), t.size(), m); });
+    LoadResult xyz_load = time_load(xyz, repeats, [](const std::string& t, Molecule& m) {
+        if (!parse_xyz(t.data(), t.size(), m)) return false;
+        generate_bonds(m);
+        return true;
+    });
+
+    std::printf("%-8s %10s %12s %10s %10s\n", "format", "MB", "load ms", "MB/s", "bonds");
+    const struct { const char* name; const std::string& text; const LoadResult& load; } rows[] = {
+        {"PDB", pdb, pdb_load}, {"mmCIF", cif, cif_load}, {"XYZ", xyz, xyz_load}};
+    for (const auto& row : rows) {
+        std::printf("%-8s %10.2f %12.2f %10.1f %10zu%s\n", row.name, row.text.size() / 1e6, row.load.best_ms,
+                    row.text.size() / 1e3 / row.load.best_ms, row.load.mol.bonds.size(), row.load.ok ? "" : "  (parse failed)");
+    }
+    std::printf("(PDB and mmCIF: parse plus template bonds; XYZ: parse plus distance-based perception; best of %d)\n\n", repeats);
+
+    bool ok = pdb_load.ok && cif_load.ok && xyz_load.ok;
+    ok = check_template_bonds("PDB", s, pdb_load.mol) && ok;
+    ok = check_template_bonds("mmCIF", s, cif_load.mol) && ok;
+    // Ideal geometry: distance perception should find the same atom pairs, without bond orders
+    std::vector<BondKey> expected_pairs, xyz_pairs;
+    for (const BondKey& key : s.expected_bonds) expected_pairs.emplace_back(std::get<0>(key), std::get<1>(key), 1);
+    for (const Bond& b : xyz_load.mol.bonds) xyz_pairs.emplace_back(b.atom1_idx, b.atom2_idx, 1);
+    std::sort(xyz_pairs.begin(), xyz_pairs.end());
+    std::printf("Template bonds (PDB, mmCIF): %s\n", ok ? "identical to the expected residue bonds" : "MISMATCH");
+    std::printf("Distance-perceived XYZ bonds: %s the expected atom pairs\n", xyz_pairs == expected_pairs ? "same as" : "differ from");
+    return ok ? 0 : 1;
+}
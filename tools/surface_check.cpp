@@ -0,0 +1,191 @@
+// Checks build_molecular_surface: the mesh topology, the enclosed volume against analytic
+// values, and the build time of a protein-sized system at 1, 2, 4, ... threads.
+//
+//   surface_check [atom_count [max_threads]]     (default 50000 atoms)
+//
+// Every mesh must be closed and consistently oriented: each directed edge occurs in exactly one
+// triangle and its reverse in exactly one other, so every edge is shared by two triangles that
+// traverse it in opposite directions, and the enclosed volume is positive (counter-clockwise
+// seen from outside). Single atoms and overlapping atom pairs, whose SES is the vdW surface
+// and whose SAS is the union of the vdW + probe spheres, are compared with the analytic volume
+// at several grid spacings. The timed system is a globule of atoms on a jittered 2.1 A lattice
+// (about the atom density of a protein with hydrogens) at 0.5 A; every thread count must give
+// the same mesh. Exits with 1 on a failed check. Build and run with `make check-surface`.
+#include "molecular_surface.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int failures = 0;
+
+struct Topology {
+    size_t unmatched = 0;   // Directed edges without exactly one reverse partner
+    size_t duplicated = 0;  // Directed edges used by more than one triangle (inconsistent orientation)
+    size_t degenerate = 0;  // Triangles repeating a vertex
+    double volume = 0.0;    // Signed, by the divergence theorem
+    long euler = 0;         // V - E + F
+};
+
+static Topology check_topology(const SurfaceMesh& mesh) {
+    Topology t;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(mesh.indices.size());
+    for (size_t k = 0; k + 2 < mesh.indices.size(); k += 3) {
+        const uint32_t tri[3] = {mesh.indices[k], mesh.indices[k + 1], mesh.indices[k + 2]};
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) ++t.degenerate;
+        for (int e = 0; e < 3; ++e) edges.emplace_back(tri[e], tri[(e + 1) % 3]);
+        const float* a = mesh.vertices[tri[0]].position;
+        const float* b = mesh.vertices[tri[1]].position;
+        const float* c = mesh.vertices[tri[2]].position;
+        t.volume += (a[0] * (double(b[1]) * c[2] - double(b[2]) * c[1]) + a[1] * (double(b[2]) * c[0] - double(b[0]) * c[2]) +
+                     a[2] * (double(b[0]) * c[1] - double(b[1]) * c[0])) / 6.0;
+    }
+    std::sort(edges.begin(), edges.end());
+    for (size_t k = 0; k < edges.size(); ++k) {
+        if (k > 0 && edges[k] == edges[k - 1]) {
+            ++t.duplicated;
+            continue;
+        }
+        const auto reverse = std::make_pair(edges[k].second, edges[k].first);
+        const auto range = std::equal_range(edges.begin(), edges.end(), reverse);
+        if (range.second - range.first != 1) ++t.unmatched;
+    }
+    t.euler = static_cast<long>(mesh.vertices.size()) - static_cast<long>(edges.size() / 2) + static_cast<long>(mesh.indices.size() / 3);
+    return t;
+}
+
+static bool closed(const Topology& t) { return t.unmatched == 0 && t.duplicated == 0 && t.degenerate == 0 && t.volume > 0.0; }
+
+// Volume of the union of two spheres with radii r1, r2 whose centers are d apart
+static double two_sphere_volume(double r1, double r2, double d) {
+    const double pi = 3.14159265358979;
+    const double v1 = 4.0 / 3.0 * pi * r1 * r1 * r1, v2 = 4.0 / 3.0 * pi * r2 * r2 * r2;
+    if (d >= r1 + r2) return v1 + v2;
+    if (d <= std::fabs(r1 - r2)) return std::max(v1, v2);
+    const double lens = pi * (r1 + r2 - d) * (r1 + r2 - d) * (d * d + 2.0 * d * (r1 + r2) - 3.0 * (r1 - r2) * (r1 - r2)) / (12.0 * d);
+    return v1 + v2 - lens;
+}
+
+// Surface of atoms 1 and 2 (atom 2 only when d > 0) against the analytic volume. Marching cubes
+// cuts across curved surfaces, so the mesh falls short by a fraction of order (h / r)^2 for
+// spheres of radius r; the tolerance is 0.75 (h / r)^2 for the smallest sphere.
+static void check_volume(const char* name, int element1, int element2, float d, SurfaceType type, float probe, float spacing) {
+    AtomArrays atoms;
+    atoms.push_back(0.0f, 0.0f, 0.0f, element1);
+    if (d > 0.0f) atoms.push_back(d, 0.0f, 0.0f, element2);
+    SurfaceParameters params;
+    params.type = type;
+    params.probe_radius = probe;
+    params.grid_spacing = spacing;
+    SurfaceMesh mesh;
+    build_molecular_surface(atoms, params, mesh);
+
+    const float grow = type == SurfaceType::SolventAccessible ? probe : 0.0f; // The SES of these is the vdW surface
+    const double r1 = atoms.properties(0).vdw_radius + grow;
+    const double r2 = d > 0.0f ? atoms.properties(1).vdw_radius + grow : 0.0;
+    const double expected = two_sphere_volume(r1, r2, d > 0.0f ? d : r1 + r2);
+    const Topology t = check_topology(mesh);
+    const double error = (t.volume - expected) / expected;
+    const double r_min = d > 0.0f ? std::min(r1, r2) : r1;
+    const bool ok = closed(t) && std::fabs(error) <= 0.75 * (spacing / r_min) * (spacing / r_min);
+    std::printf("%-22s %s  h %.3f  %7zu tris  euler %3ld  volume %9.2f  analytic %9.2f  %+6.2f%%  %s\n", name,
+                type == SurfaceType::SolventExcluded ? "SES" : "SAS", spacing, mesh.indices.size() / 3, t.euler, t.volume, expected,
+                100.0 * error, ok ? "OK" : "FAIL");
+    if (!ok) ++failures;
+}
+
+// Atoms of a jittered lattice inside a ball, nearest to the center first
+static AtomArrays make_globule(size_t atom_count) {
+    static const int ELEMENTS[] = {6, 6, 6, 7, 8, 1, 1, 1, 1, 16};
+    const float spacing = 2.1f;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    const int half = static_cast<int>(std::ceil(std::cbrt(atom_count * 3.0 / (4.0 * 3.14159265)))) + 1;
+    std::vector<std::pair<float, Vec3>> sites;
+    for (int i = -half; i <= half; ++i)
+        for (int j = -half; j <= half; ++j)
+            for (int k = -half; k <= half; ++k) {
+                const Vec3 p(spacing * i + jitter(rng), spacing * j + jitter(rng), spacing * k + jitter(rng));
+                sites.push_back({p.length(), p});
+            }
+    std::sort(sites.begin(), sites.end(), [](const std::pair<float, Vec3>& a, const std::pair<float, Vec3>& b) { return a.first < b.first; });
+    AtomArrays atoms;
+    for (size_t n = 0; n < atom_count && n < sites.size(); ++n) atoms.push_back(sites[n].second.x, sites[n].second.y, sites[n].second.z, ELEMENTS[rng() % 10]);
+    return atoms;
+}
+
+int main(int argc, char** argv) {
+    std::cout.rdbuf(nullptr); // Drop the library logs; results go through printf
+    const size_t atom_count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 50000;
+    const unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : worker_thread_count();
+    if (atom_count == 0 || max_threads == 0) {
+        std::fprintf(stderr, "Usage: %s [atom_count [max_threads]]\n", argv[0]);
+        return 2;
+    }
+
+    // Analytic volumes, converging as the grid is refined
+    for (float h : {0.5f, 0.25f, 0.125f}) {
+        check_volume("carbon", 6, 0, 0.0f, SurfaceType::SolventExcluded, 1.4f, h);
+        check_volume("carbon", 6, 0, 0.0f, SurfaceType::SolventAccessible, 1.4f, h);
+        check_volume("sulfur, probe 0", 16, 0, 0.0f, SurfaceType::SolventExcluded, 0.0f, h);
+        check_volume("oxygen pair 1.2 A", 8, 8, 1.2f, SurfaceType::SolventAccessible, 1.4f, h);
+        check_volume("C-N pair 1.5 A, vdW", 6, 7, 1.5f, SurfaceType::SolventAccessible, 0.0f, h);
+    }
+    std::printf("\n");
+
+    // Build time and topology of a protein-sized surface
+    const AtomArrays atoms = make_globule(atom_count);
+    SurfaceParameters params;
+    params.grid_spacing = 0.5f;
+    std::printf("%zu atoms, SES with a %.1f A probe at %.2f A, %u hardware threads\n", atoms.size(), params.probe_radius,
+                params.grid_spacing, worker_thread_count());
+    std::printf("threads   build ms  speedup   triangles\n");
+    SurfaceMesh reference;
+    double single_ms = 0.0;
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+    for (unsigned threads : thread_counts) {
+        set_worker_thread_count(threads);
+        SurfaceMesh mesh;
+        double best = 1e30;
+        for (int run = 0; run < 3; ++run) {
+            const double start = now_ms();
+            build_molecular_surface(atoms, params, mesh);
+            best = std::min(best, now_ms() - start);
+        }
+        if (threads == 1) {
+            single_ms = best;
+            reference = mesh;
+        }
+        bool same = mesh.indices == reference.indices && mesh.vertices.size() == reference.vertices.size();
+        for (size_t v = 0; same && v < mesh.vertices.size(); ++v) {
+            same = std::equal(mesh.vertices[v].position, mesh.vertices[v].position + 3, reference.vertices[v].position);
+        }
+        std::printf("%7u %10.1f %8.2fx %11zu  %s\n", threads, best, single_ms / best, mesh.indices.size() / 3, same ? "" : "DIFFERENT MESH");
+        if (!same) ++failures;
+    }
+    set_worker_thread_count(0);
+
+    const Topology t = check_topology(reference);
+    std::printf("grid %dx%dx%d at %.2f A, %zu vertices, euler %ld, volume %.0f A^3: %s\n", reference.grid_dims[0], reference.grid_dims[1],
+                reference.grid_dims[2], reference.grid_spacing, reference.vertices.size(), t.euler, t.volume,
+                closed(t) ? "closed and consistently oriented" : "OPEN OR MISORIENTED");
+    if (!closed(t)) {
+        std::printf("  %zu unmatched edges, %zu duplicated edges, %zu degenerate triangles\n", t.unmatched, t.duplicated, t.degenerate);
+        ++failures;
+    }
+
+    std::printf(failures ? "%d CHECKS FAILED\n" : "All surface checks passed\n", failures);
+    return failures ? 1 : 0;
+}
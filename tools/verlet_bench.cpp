@@ -0,0 +1,119 @@
+// Benchmark for per-frame bond updates with BondNeighborList over a synthetic MD trajectory,
+// against perceiving the bonds from scratch with generate_bonds every frame. Every check_every
+// frames the two bond sets are compared.
+//
+//   verlet_bench [atom_count [frames [skin]]]     (default 10000 atoms, 10000 frames, 0.8 A)
+//
+// Atoms sit on a 1.5 A cubic lattice with a mix of C, N, O and H and follow independent
+// Ornstein-Uhlenbeck walks around their sites (0.02 A steps, 0.15 A thermal spread), so pairs
+// keep crossing their bond cutoffs. Build and run with `make bench-verlet`.
+#include "neighbor.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static double now_ms() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bonds formed plus bonds broken between two bond lists, both ordered by (atom1_idx, atom2_idx)
+static size_t changed_bonds(const std::vector<Bond>& a, const std::vector<Bond>& b) {
+    size_t changes = 0, i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i].atom1_idx == b[j].atom1_idx && a[i].atom2_idx == b[j].atom2_idx) { ++i; ++j; }
+        else if (a[i].atom1_idx < b[j].atom1_idx || (a[i].atom1_idx == b[j].atom1_idx && a[i].atom2_idx < b[j].atom2_idx)) { ++i; ++changes; }
+        else { ++j; ++changes; }
+    }
+    return changes + (a.size() - i) + (b.size() - j);
+}
+
+static bool same_bonds(const std::vector<Bond>& a, const std::vector<Bond>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t k = 0; k < a.size(); ++k) {
+        if (a[k].atom1_idx != b[k].atom1_idx || a[k].atom2_idx != b[k].atom2_idx) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const size_t atom_count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000;
+    const int frames = argc > 2 ? std::atoi(argv[2]) : 10000;
+    const float skin = argc > 3 ? static_cast<float>(std::atof(argv[3])) : BOND_NEIGHBOR_SKIN;
+    if (atom_count == 0 || frames <= 0 || skin < 0.0f) {
+        std::fprintf(stderr, "Usage: %s [atom_count [frames [skin]]]\n", argv[0]);
+        return 2;
+    }
+    const int check_every = 250;
+
+    static const int ELEMENTS[] = {6, 6, 6, 7, 8, 1, 1, 1}; // C, N, O, H
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    const size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(atom_count))));
+    std::vector<float> site(atom_count * 3), offset(atom_count * 3, 0.0f);
+    Molecule mol;
+    for (size_t i = 0; i < atom_count; ++i) {
+        site[3 * i] = 1.5f * (i % side);
+        site[3 * i + 1] = 1.5f * (i / side % side);
+        site[3 * i + 2] = 1.5f * (i / side / side);
+        mol.atoms.push_back(site[3 * i], site[3 * i + 1], site[3 * i + 2], ELEMENTS[rng() % 8]);
+    }
+    // Ornstein-Uhlenbeck step: offset' = decay * offset + kick * noise, stationary spread 0.15 A
+    const float decay = 0.99f;
+    const float kick = 0.15f * std::sqrt(1.0f - decay * decay);
+
+    BondNeighborList list;
+    list.skin = skin;
+    Molecule reference;
+    std::vector<Bond> previous;
+    double update_ms = 0.0, full_ms = 0.0, rebuild_ms = 0.0;
+    size_t checks = 0, bond_total = 0, bond_changes = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (size_t k = 0; k < atom_count * 3; ++k) offset[k] = decay * offset[k] + kick * noise(rng);
+        for (size_t i = 0; i < atom_count; ++i) {
+            mol.atoms.x[i] = site[3 * i] + offset[3 * i];
+            mol.atoms.y[i] = site[3 * i + 1] + offset[3 * i + 1];
+            mol.atoms.z[i] = site[3 * i + 2] + offset[3 * i + 2];
+        }
+
+        double start = now_ms();
+        bool rebuilt = list.update_bonds(mol);
+        double ms = now_ms() - start;
+        update_ms += ms;
+        if (rebuilt) rebuild_ms += ms;
+        bond_total += mol.bonds.size();
+        if (frame > 0) bond_changes += changed_bonds(previous, mol.bonds);
+        previous = mol.bonds;
+
+        if (frame % check_every == 0) {
+            reference.atoms = mol.atoms;
+            reference.bonds.clear();
+            start = now_ms();
+            generate_bonds(reference);
+            full_ms += now_ms() - start;
+            checks++;
+            if (!same_bonds(mol.bonds, reference.bonds)) {
+                std::printf("MISMATCH at frame %d: %zu bonds from the list, %zu from generate_bonds\n", frame,
+                            mol.bonds.size(), reference.bonds.size());
+                return 1;
+            }
+        }
+    }
+
+    const double full_per_frame = full_ms / checks;
+    const double update_per_frame = update_ms / frames;
+    std::printf("%zu atoms, %d frames, skin %.2f A\n", atom_count, frames, skin);
+    std::printf("  list pairs per atom   %10.2f\n", static_cast<double>(list.partners.size()) / atom_count);
+    std::printf("  bonds per frame       %10.1f (%.1f formed or broken per frame)\n", static_cast<double>(bond_total) / frames,
+                static_cast<double>(bond_changes) / frames);
+    std::printf("  list rebuilds         %10zu (every %.1f frames)\n", list.build_count,
+                static_cast<double>(frames) / list.build_count);
+    std::printf("  generate_bonds        %10.3f ms/frame (%zu samples)\n", full_per_frame, checks);
+    std::printf("  update_bonds          %10.3f ms/frame incl. rebuilds (%.3f ms without, %.3f ms with a rebuild)\n",
+                update_per_frame, (update_ms - rebuild_ms) / std::max<size_t>(1, frames - list.build_count),
+                rebuild_ms / std::max<size_t>(1, list.build_count));
+    std::printf("  speedup               %10.2fx, %.1f ns per atom per frame, bonds identical\n", full_per_frame / update_per_frame,
+                update_per_frame * 1e6 / atom_count);
+    return 0;
+}
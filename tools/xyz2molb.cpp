@@ -0,0 +1,82 @@
+// Native converter from XYZ text to the MOLB binary format (see src/molecule_binary.h).
+// Bonds are perceived once here, so loading the result in the browser skips the search. An
+// extended XYZ lattice is kept, with the periodic bonds across the cell faces.
+//
+//   xyz2molb input.xyz output.molb
+//   xyz2molb --base64 input.xyz      (writes base64 to stdout, for embedding in JS)
+//
+// Build with `make tools`. An input of "-" reads standard input.
+#include "xyz_reader.h"
+#include "neighbor.h"
+#include "molecule_binary.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static bool read_input(const char* path, std::string& text) {
+    if (std::strcmp(path, "-") == 0) {
+        text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        return true;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static std::string base64_encode(const std::vector<uint8_t>& bytes) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t chunk = static_cast<uint32_t>(bytes[i]) << 16;
+        if (i + 1 < bytes.size()) chunk |= static_cast<uint32_t>(bytes[i + 1]) << 8;
+        if (i + 2 < bytes.size()) chunk |= bytes[i + 2];
+        out.push_back(ALPHABET[(chunk >> 18) & 63]);
+        out.push_back(ALPHABET[(chunk >> 12) & 63]);
+        out.push_back(i + 1 < bytes.size() ? ALPHABET[(chunk >> 6) & 63] : '=');
+        out.push_back(i + 2 < bytes.size() ? ALPHABET[chunk & 63] : '=');
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    bool base64 = argc == 3 && std::strcmp(argv[1], "--base64") == 0;
+    if (!base64 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " input.xyz output.molb" << std::endl;
+        std::cerr << "       " << argv[0] << " --base64 input.xyz" << std::endl;
+        return 2;
+    }
+    const char* input_path = base64 ? argv[2] : argv[1];
+
+    std::string text;
+    if (!read_input(input_path, text)) {
+        std::cerr << "xyz2molb: Cannot read " << input_path << std::endl;
+        return 1;
+    }
+    // Parser and bond perception log to stdout; keep it clean for --base64
+    std::streambuf* log_buffer = std::cout.rdbuf(std::cerr.rdbuf());
+    Molecule mol;
+    bool parsed = parse_xyz(text.data(), text.size(), mol);
+    if (parsed) generate_bonds(mol);
+    std::cout.rdbuf(log_buffer);
+    if (!parsed) return 1;
+
+    std::vector<uint8_t> bytes = encode_molecule_binary(mol);
+    if (base64) {
+        std::cout << base64_encode(bytes) << std::endl;
+        return 0;
+    }
+    std::ofstream out(argv[2], std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        std::cerr << "xyz2molb: Cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cerr << "xyz2molb: " << mol.atoms.size() << " atoms, " << mol.bonds.size() << " bonds, "
+              << text.size() << " -> " << bytes.size() << " bytes" << std::endl;
+    return 0;
+}